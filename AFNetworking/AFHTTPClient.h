@@ -129,6 +129,11 @@ typedef enum {
  */
 @property (readonly, nonatomic, strong) NSOperationQueue *operationQueue;
 
+/**
+ The maximum number of operations enqueued by `enqueueHTTPRequestOperation:` that may run at the same time for a given host. Operations over the limit wait, in order, outside of `operationQueue` until an operation for the same host finishes. Raising the limit starts waiting operations right away, while lowering it takes effect as running operations finish. This is `NSOperationQueueDefaultMaxConcurrentOperationCount` by default, which sets no limit.
+ */
+@property (nonatomic, assign) NSInteger maxConcurrentOperationCountPerHost;
+
 /**
  The reachability status from the device to the current `baseURL` of the `AFHTTPClient`.
 
@@ -326,7 +331,7 @@ typedef enum {
 ///----------------------------------------
 
 /**
- Enqueues an `AFHTTPRequestOperation` to the HTTP client's operation queue.
+ Enqueues an `AFHTTPRequestOperation` to the HTTP client's operation queue, or holds it until an operation for the same host finishes if `maxConcurrentOperationCountPerHost` operations are already running for its host.
 
  @param operation The HTTP request operation to be enqueued.
  */
@@ -524,6 +529,22 @@ typedef enum {
  */
 extern NSString * AFQueryStringFromParametersWithEncoding(NSDictionary *parameters, NSStringEncoding encoding);
 
+/**
+ Appends the query string constructed by a set of parameters to a buffer, and optionally the canonical form of the parameters used to sign requests.
+
+ Parameters are flattened as in `AFQueryStringFromParametersWithEncoding`, in a single pass that does not create an object per key-value pair.
+
+ The canonical form lists the key-value pairs sorted by field, keeping the last value of repeated fields. Each field and value is percent escaped outside of the RFC 3986 unreserved characters, with one escape per UTF-16 code unit, then each "field=value" pair is percent escaped again, and pairs are joined with "%26".
+
+ @param buffer The buffer the query string, then the canonical form, are appended to
+ @param parameters The parameters used to construct the query string
+ @param encoding The encoding to use in constructing the query string
+ @param canonicalRange If not `NULL`, the canonical form is appended after the query string, and its range in `buffer` is returned by reference.
+
+ @return The range of the query string in `buffer`
+ */
+extern NSRange AFAppendQueryStringFromParameters(NSMutableData *buffer, NSDictionary *parameters, NSStringEncoding encoding, NSRange *canonicalRange);
+
 ///--------------------
 /// @name Notifications
 ///--------------------
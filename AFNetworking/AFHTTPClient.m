@@ -130,12 +130,313 @@ extern NSArray * AFQueryStringPairsFromDictionary(NSDictionary *dictionary);
 extern NSArray * AFQueryStringPairsFromKeyAndValue(NSString *key, id value);
 
 NSString * AFQueryStringFromParametersWithEncoding(NSDictionary *parameters, NSStringEncoding stringEncoding) {
-    NSMutableArray *mutablePairs = [NSMutableArray array];
-    for (AFQueryStringPair *pair in AFQueryStringPairsFromDictionary(parameters)) {
-        [mutablePairs addObject:[pair URLEncodedStringValueWithEncoding:stringEncoding]];
+    NSMutableData *buffer = [NSMutableData data];
+    AFAppendQueryStringFromParameters(buffer, parameters, stringEncoding, NULL);
+
+    return [[NSString alloc] initWithData:buffer encoding:NSASCIIStringEncoding];
+}
+
+#pragma mark -
+
+// A flattened key-value pair, as ranges of the characters of an AFQueryStringScratch
+typedef struct {
+    NSUInteger field;
+    NSUInteger fieldLength;
+    NSUInteger value;
+    NSUInteger valueLength;
+    BOOL hasValue;
+} AFQueryStringPairRange;
+
+typedef struct {
+    unichar *characters;
+    NSUInteger length;
+    NSUInteger capacity;
+    AFQueryStringPairRange *pairs;
+    NSUInteger count;
+    NSUInteger pairCapacity;
+} AFQueryStringScratch;
+
+static void AFQueryStringScratchReserve(AFQueryStringScratch *scratch, NSUInteger length) {
+    if (scratch->length + length > scratch->capacity) {
+        scratch->capacity = MAX(scratch->capacity * 2, scratch->length + length);
+        scratch->characters = realloc(scratch->characters, scratch->capacity * sizeof(unichar));
+    }
+}
+
+static void AFQueryStringScratchAppendString(AFQueryStringScratch *scratch, NSString *string) {
+    NSUInteger length = [string length];
+    AFQueryStringScratchReserve(scratch, length);
+    [string getCharacters:scratch->characters + scratch->length range:NSMakeRange(0, length)];
+    scratch->length += length;
+}
+
+static void AFQueryStringScratchAppendCharacters(AFQueryStringScratch *scratch, const char *characters) {
+    NSUInteger length = strlen(characters);
+    AFQueryStringScratchReserve(scratch, length);
+    for (NSUInteger i = 0; i < length; i++) {
+        scratch->characters[scratch->length++] = (unichar)characters[i];
+    }
+}
+
+static void AFQueryStringScratchAppendRange(AFQueryStringScratch *scratch, NSUInteger location, NSUInteger length) {
+    AFQueryStringScratchReserve(scratch, length);
+    memcpy(scratch->characters + scratch->length, scratch->characters + location, length * sizeof(unichar));
+    scratch->length += length;
+}
+
+static void AFQueryStringScratchFlatten(AFQueryStringScratch *scratch, NSUInteger field, NSUInteger fieldLength, BOOL hasField, id value) {
+    if ([value isKindOfClass:[NSDictionary class]]) {
+        NSDictionary *dictionary = value;
+        // Sort dictionary keys to ensure consistent ordering in query string, which is important when deserializing potentially ambiguous sequences, such as an array of dictionaries
+        NSSortDescriptor *sortDescriptor = [NSSortDescriptor sortDescriptorWithKey:@"description" ascending:YES selector:@selector(caseInsensitiveCompare:)];
+        for (id nestedKey in [dictionary.allKeys sortedArrayUsingDescriptors:@[ sortDescriptor ]]) {
+            id nestedValue = [dictionary objectForKey:nestedKey];
+            if (nestedValue) {
+                NSUInteger nestedField = scratch->length;
+                if (hasField) {
+                    AFQueryStringScratchAppendRange(scratch, field, fieldLength);
+                    AFQueryStringScratchAppendCharacters(scratch, "[");
+                    AFQueryStringScratchAppendString(scratch, [nestedKey description]);
+                    AFQueryStringScratchAppendCharacters(scratch, "]");
+                } else {
+                    AFQueryStringScratchAppendString(scratch, [nestedKey description]);
+                }
+                AFQueryStringScratchFlatten(scratch, nestedField, scratch->length - nestedField, YES, nestedValue);
+            }
+        }
+    } else if ([value isKindOfClass:[NSArray class]]) {
+        NSUInteger nestedField = scratch->length;
+        AFQueryStringScratchAppendRange(scratch, field, fieldLength);
+        AFQueryStringScratchAppendCharacters(scratch, "[]");
+        // Every element shares the field, while the values of the elements are appended after it
+        NSUInteger nestedFieldLength = scratch->length - nestedField;
+        for (id nestedValue in (NSArray *)value) {
+            AFQueryStringScratchFlatten(scratch, nestedField, nestedFieldLength, YES, nestedValue);
+        }
+    } else if ([value isKindOfClass:[NSSet class]]) {
+        for (id obj in (NSSet *)value) {
+            AFQueryStringScratchFlatten(scratch, field, fieldLength, hasField, obj);
+        }
+    } else {
+        if (scratch->count == scratch->pairCapacity) {
+            scratch->pairCapacity = MAX(scratch->pairCapacity * 2, (NSUInteger)16);
+            scratch->pairs = realloc(scratch->pairs, scratch->pairCapacity * sizeof(AFQueryStringPairRange));
+        }
+
+        AFQueryStringPairRange *pair = &scratch->pairs[scratch->count++];
+        pair->field = field;
+        pair->fieldLength = fieldLength;
+        pair->hasValue = value && ![value isEqual:[NSNull null]];
+        pair->value = scratch->length;
+        if (pair->hasValue) {
+            AFQueryStringScratchAppendString(scratch, [value description]);
+        }
+        pair->valueLength = scratch->length - pair->value;
+    }
+}
+
+static uint8_t const kAFHexDigits[] = "0123456789ABCDEF";
+
+static inline BOOL AFCharacterIsUnreserved(unichar c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '.' || c == '_' || c == '~';
+}
+
+// Percent escapes UTF-8 encoded characters like AFPercentEscapedQueryStringPairMemberFromStringWithEncoding, returns the end of the output
+static uint8_t * AFAppendPercentEscapedUTF8Characters(uint8_t *output, const unichar *characters, NSUInteger length) {
+    for (NSUInteger i = 0; i < length; i++) {
+        uint32_t c = characters[i];
+        if (AFCharacterIsUnreserved((unichar)c) || c == '[' || c == ']') {
+            *output++ = (uint8_t)c;
+            continue;
+        }
+
+        uint8_t bytes[4];
+        NSUInteger count;
+        if (c >= 0xD800 && c <= 0xDBFF && i + 1 < length && characters[i + 1] >= 0xDC00 && characters[i + 1] <= 0xDFFF) {
+            c = 0x10000 + ((c - 0xD800) << 10) + (characters[++i] - 0xDC00);
+        }
+        if (c < 0x80) {
+            bytes[0] = (uint8_t)c;
+            count = 1;
+        } else if (c < 0x800) {
+            bytes[0] = (uint8_t)(0xC0 | (c >> 6));
+            bytes[1] = (uint8_t)(0x80 | (c & 0x3F));
+            count = 2;
+        } else if (c < 0x10000) {
+            bytes[0] = (uint8_t)(0xE0 | (c >> 12));
+            bytes[1] = (uint8_t)(0x80 | ((c >> 6) & 0x3F));
+            bytes[2] = (uint8_t)(0x80 | (c & 0x3F));
+            count = 3;
+        } else {
+            bytes[0] = (uint8_t)(0xF0 | (c >> 18));
+            bytes[1] = (uint8_t)(0x80 | ((c >> 12) & 0x3F));
+            bytes[2] = (uint8_t)(0x80 | ((c >> 6) & 0x3F));
+            bytes[3] = (uint8_t)(0x80 | (c & 0x3F));
+            count = 4;
+        }
+
+        for (NSUInteger j = 0; j < count; j++) {
+            *output++ = '%';
+            *output++ = kAFHexDigits[bytes[j] >> 4];
+            *output++ = kAFHexDigits[bytes[j] & 0x0F];
+        }
+    }
+
+    return output;
+}
+
+// Escapes characters once with one %XX per UTF-16 code unit, then escapes the result again, returns the end of the output
+static uint8_t * AFAppendCanonicalCharacters(uint8_t *output, const unichar *characters, NSUInteger length) {
+    for (NSUInteger i = 0; i < length; i++) {
+        unichar c = characters[i];
+        if (AFCharacterIsUnreserved(c)) {
+            *output++ = (uint8_t)c;
+        } else {
+            *output++ = '%';
+            *output++ = '2';
+            *output++ = '5';
+            if (c > 0xFFF) {
+                *output++ = kAFHexDigits[c >> 12];
+            }
+            if (c > 0xFF) {
+                *output++ = kAFHexDigits[(c >> 8) & 0x0F];
+            }
+            *output++ = kAFHexDigits[(c >> 4) & 0x0F];
+            *output++ = kAFHexDigits[c & 0x0F];
+        }
     }
 
-    return [mutablePairs componentsJoinedByString:@"&"];
+    return output;
+}
+
+static int AFQueryStringPairCompare(void *context, const void *a, const void *b) {
+    AFQueryStringScratch *scratch = context;
+    NSUInteger left = *(const NSUInteger *)a;
+    NSUInteger right = *(const NSUInteger *)b;
+    AFQueryStringPairRange *leftPair = &scratch->pairs[left];
+    AFQueryStringPairRange *rightPair = &scratch->pairs[right];
+
+    NSUInteger length = MIN(leftPair->fieldLength, rightPair->fieldLength);
+    const unichar *leftCharacters = scratch->characters + leftPair->field;
+    const unichar *rightCharacters = scratch->characters + rightPair->field;
+    for (NSUInteger i = 0; i < length; i++) {
+        if (leftCharacters[i] != rightCharacters[i]) {
+            return leftCharacters[i] < rightCharacters[i] ? -1 : 1;
+        }
+    }
+
+    if (leftPair->fieldLength != rightPair->fieldLength) {
+        return leftPair->fieldLength < rightPair->fieldLength ? -1 : 1;
+    }
+
+    // Keep pairs with the same field in their original order
+    return left < right ? -1 : (left > right ? 1 : 0);
+}
+
+NSRange AFAppendQueryStringFromParameters(NSMutableData *buffer, NSDictionary *parameters, NSStringEncoding encoding, NSRange *canonicalRange) {
+    AFQueryStringScratch scratch = { NULL, 0, 0, NULL, 0, 0 };
+    AFQueryStringScratchFlatten(&scratch, 0, 0, NO, parameters);
+
+    // Fields are shared between pairs, so the output is sized from the characters of every pair rather than from the scratch
+    NSUInteger pairsLength = 0;
+    for (NSUInteger i = 0; i < scratch.count; i++) {
+        pairsLength += scratch.pairs[i].fieldLength + scratch.pairs[i].valueLength;
+    }
+
+    // Reserve the worst case at once: 9 bytes per escaped BMP code unit, 7 characters per canonical code unit
+    NSUInteger start = [buffer length];
+    NSUInteger capacity = pairsLength * 9 + scratch.count * 2;
+    if (canonicalRange) {
+        capacity += pairsLength * 7 + scratch.count * 6;
+    }
+    [buffer increaseLengthBy:capacity];
+
+    uint8_t *begin = (uint8_t *)[buffer mutableBytes] + start;
+    uint8_t *output = begin;
+
+    for (NSUInteger i = 0; i < scratch.count; i++) {
+        AFQueryStringPairRange *pair = &scratch.pairs[i];
+        if (i) {
+            *output++ = '&';
+        }
+
+        if (encoding == NSUTF8StringEncoding) {
+            output = AFAppendPercentEscapedUTF8Characters(output, scratch.characters + pair->field, pair->fieldLength);
+            if (pair->hasValue) {
+                *output++ = '=';
+                output = AFAppendPercentEscapedUTF8Characters(output, scratch.characters + pair->value, pair->valueLength);
+            }
+        } else {
+            // Other encodings go through CFURL
+            NSMutableString *member = [NSMutableString stringWithString:AFPercentEscapedQueryStringPairMemberFromStringWithEncoding([NSString stringWithCharacters:scratch.characters + pair->field length:pair->fieldLength], encoding)];
+            if (pair->hasValue) {
+                [member appendString:@"="];
+                [member appendString:AFPercentEscapedQueryStringPairMemberFromStringWithEncoding([NSString stringWithCharacters:scratch.characters + pair->value length:pair->valueLength], encoding)];
+            }
+
+            NSData *data = [member dataUsingEncoding:NSASCIIStringEncoding];
+            NSUInteger offset = (NSUInteger)(output - begin);
+            if (offset + [data length] > capacity) {
+                capacity = offset + [data length] + capacity;
+                [buffer setLength:start + capacity];
+                begin = (uint8_t *)[buffer mutableBytes] + start;
+                output = begin + offset;
+            }
+            memcpy(output, [data bytes], [data length]);
+            output += [data length];
+        }
+    }
+
+    NSRange queryRange = NSMakeRange(start, (NSUInteger)(output - begin));
+
+    if (canonicalRange) {
+        NSUInteger *order = malloc(MAX(scratch.count, (NSUInteger)1) * sizeof(NSUInteger));
+        BOOL sorted = YES;
+        for (NSUInteger i = 0; i < scratch.count; i++) {
+            order[i] = i;
+            if (i && sorted && AFQueryStringPairCompare(&scratch, &order[i - 1], &order[i]) > 0) {
+                sorted = NO;
+            }
+        }
+        if (!sorted) {
+            qsort_r(order, scratch.count, sizeof(NSUInteger), &scratch, AFQueryStringPairCompare);
+        }
+
+        uint8_t *canonical = output;
+        BOOL first = YES;
+        for (NSUInteger i = 0; i < scratch.count; i++) {
+            AFQueryStringPairRange *pair = &scratch.pairs[order[i]];
+
+            // Repeated fields keep their last value
+            if (i + 1 < scratch.count) {
+                AFQueryStringPairRange *next = &scratch.pairs[order[i + 1]];
+                if (next->fieldLength == pair->fieldLength && !memcmp(scratch.characters + next->field, scratch.characters + pair->field, pair->fieldLength * sizeof(unichar))) {
+                    continue;
+                }
+            }
+
+            if (!first) {
+                memcpy(output, "%26", 3);
+                output += 3;
+            }
+            first = NO;
+
+            output = AFAppendCanonicalCharacters(output, scratch.characters + pair->field, pair->fieldLength);
+            memcpy(output, "%3D", 3);
+            output += 3;
+            output = AFAppendCanonicalCharacters(output, scratch.characters + pair->value, pair->valueLength);
+        }
+
+        *canonicalRange = NSMakeRange(start + (NSUInteger)(canonical - begin), (NSUInteger)(output - canonical));
+        free(order);
+    }
+
+    [buffer setLength:start + (NSUInteger)(output - begin)];
+
+    free(scratch.characters);
+    free(scratch.pairs);
+
+    return queryRange;
 }
 
 NSArray * AFQueryStringPairsFromDictionary(NSDictionary *dictionary) {
@@ -187,6 +488,8 @@ NSArray * AFQueryStringPairsFromKeyAndValue(NSString *key, id value) {
 @property (readwrite, nonatomic, strong) NSMutableDictionary *defaultHeaders;
 @property (readwrite, nonatomic, strong) NSURLCredential *defaultCredential;
 @property (readwrite, nonatomic, strong) NSOperationQueue *operationQueue;
+@property (readwrite, nonatomic, strong) NSMutableDictionary *runningOperationCountsByHost;
+@property (readwrite, nonatomic, strong) NSMutableDictionary *pendingOperationsByHost;
 #ifdef _SYSTEMCONFIGURATION_H
 @property (readwrite, nonatomic, assign) AFNetworkReachabilityRef networkReachability;
 @property (readwrite, nonatomic, assign) AFNetworkReachabilityStatus networkReachabilityStatus;
@@ -197,6 +500,8 @@ NSArray * AFQueryStringPairsFromKeyAndValue(NSString *key, id value) {
 - (void)startMonitoringNetworkReachability;
 - (void)stopMonitoringNetworkReachability;
 #endif
+- (void)operationDidFinishForHost:(NSString *)host;
+- (void)startPendingOperationsForHost:(NSString *)host;
 @end
 
 @implementation AFHTTPClient
@@ -207,6 +512,9 @@ NSArray * AFQueryStringPairsFromKeyAndValue(NSString *key, id value) {
 @synthesize defaultHeaders = _defaultHeaders;
 @synthesize defaultCredential = _defaultCredential;
 @synthesize operationQueue = _operationQueue;
+@synthesize maxConcurrentOperationCountPerHost = _maxConcurrentOperationCountPerHost;
+@synthesize runningOperationCountsByHost = _runningOperationCountsByHost;
+@synthesize pendingOperationsByHost = _pendingOperationsByHost;
 #ifdef _SYSTEMCONFIGURATION_H
 @synthesize networkReachability = _networkReachability;
 @synthesize networkReachabilityStatus = _networkReachabilityStatus;
@@ -274,6 +582,10 @@ NSArray * AFQueryStringPairsFromKeyAndValue(NSString *key, id value) {
     self.operationQueue = [[NSOperationQueue alloc] init];
 	[self.operationQueue setMaxConcurrentOperationCount:NSOperationQueueDefaultMaxConcurrentOperationCount];
 
+    self.runningOperationCountsByHost = [NSMutableDictionary dictionary];
+    self.pendingOperationsByHost = [NSMutableDictionary dictionary];
+    self.maxConcurrentOperationCountPerHost = NSOperationQueueDefaultMaxConcurrentOperationCount;
+
     // #ifdef included for backwards-compatibility
 #ifdef _AFNETWORKING_ALLOW_INVALID_SSL_CERTIFICATES_
     self.allowsInvalidSSLCertificate = YES;
@@ -473,7 +785,9 @@ static void AFNetworkReachabilityReleaseCallback(const void *info) {
             switch (self.parameterEncoding) {
                 case AFFormURLParameterEncoding:;
                     [request setValue:[NSString stringWithFormat:@"application/x-www-form-urlencoded; charset=%@", charset] forHTTPHeaderField:@"Content-Type"];
-                    [request setHTTPBody:[AFQueryStringFromParametersWithEncoding(parameters, self.stringEncoding) dataUsingEncoding:self.stringEncoding]];
+                    NSMutableData *body = [NSMutableData data];
+                    AFAppendQueryStringFromParameters(body, parameters, self.stringEncoding, NULL);
+                    [request setHTTPBody:body];
                     break;
                 case AFJSONParameterEncoding:;
                     [request setValue:[NSString stringWithFormat:@"application/json; charset=%@", charset] forHTTPHeaderField:@"Content-Type"];
@@ -565,7 +879,82 @@ static void AFNetworkReachabilityReleaseCallback(const void *info) {
 #pragma mark -
 
 - (void)enqueueHTTPRequestOperation:(AFHTTPRequestOperation *)operation {
-    [self.operationQueue addOperation:operation];
+    if (self.maxConcurrentOperationCountPerHost <= 0) {
+        [self.operationQueue addOperation:operation];
+        return;
+    }
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wgnu"
+    NSString *host = [[[operation request] URL] host] ?: @"";
+#pragma clang diagnostic pop
+
+    // Release the next operation for the host once this one is done
+    AFCompletionBlock originalCompletionBlock = [operation.completionBlock copy];
+    __weak __typeof(&*self)weakSelf = self;
+    operation.completionBlock = ^{
+        if (originalCompletionBlock) {
+            originalCompletionBlock();
+        }
+
+        [weakSelf operationDidFinishForHost:host];
+    };
+
+    @synchronized(self.runningOperationCountsByHost) {
+        NSInteger runningOperationCount = [[self.runningOperationCountsByHost objectForKey:host] integerValue];
+        if (runningOperationCount < self.maxConcurrentOperationCountPerHost) {
+            [self.runningOperationCountsByHost setObject:[NSNumber numberWithInteger:runningOperationCount + 1] forKey:host];
+            [self.operationQueue addOperation:operation];
+        } else {
+            NSMutableArray *pendingOperations = [self.pendingOperationsByHost objectForKey:host];
+            if (!pendingOperations) {
+                pendingOperations = [NSMutableArray array];
+                [self.pendingOperationsByHost setObject:pendingOperations forKey:host];
+            }
+            [pendingOperations addObject:operation];
+        }
+    }
+}
+
+- (void)operationDidFinishForHost:(NSString *)host {
+    @synchronized(self.runningOperationCountsByHost) {
+        NSInteger runningOperationCount = [[self.runningOperationCountsByHost objectForKey:host] integerValue];
+        if (runningOperationCount > 1) {
+            [self.runningOperationCountsByHost setObject:[NSNumber numberWithInteger:runningOperationCount - 1] forKey:host];
+        } else {
+            [self.runningOperationCountsByHost removeObjectForKey:host];
+        }
+
+        [self startPendingOperationsForHost:host];
+    }
+}
+
+// Must be called while holding the lock on runningOperationCountsByHost
+- (void)startPendingOperationsForHost:(NSString *)host {
+    NSMutableArray *pendingOperations = [self.pendingOperationsByHost objectForKey:host];
+    NSInteger runningOperationCount = [[self.runningOperationCountsByHost objectForKey:host] integerValue];
+    while ([pendingOperations count] > 0 && (self.maxConcurrentOperationCountPerHost <= 0 || runningOperationCount < self.maxConcurrentOperationCountPerHost)) {
+        NSOperation *operation = [pendingOperations objectAtIndex:0];
+        [pendingOperations removeObjectAtIndex:0];
+        runningOperationCount++;
+        [self.runningOperationCountsByHost setObject:[NSNumber numberWithInteger:runningOperationCount] forKey:host];
+        [self.operationQueue addOperation:operation];
+    }
+
+    if (pendingOperations && [pendingOperations count] == 0) {
+        [self.pendingOperationsByHost removeObjectForKey:host];
+    }
+}
+
+- (void)setMaxConcurrentOperationCountPerHost:(NSInteger)maxConcurrentOperationCountPerHost {
+    @synchronized(self.runningOperationCountsByHost) {
+        _maxConcurrentOperationCountPerHost = maxConcurrentOperationCountPerHost;
+
+        // A higher limit starts waiting operations right away, a lower one takes effect as running operations finish
+        for (NSString *host in [self.pendingOperationsByHost allKeys]) {
+            [self startPendingOperationsForHost:host];
+        }
+    }
 }
 
 - (void)cancelAllHTTPOperationsWithMethod:(NSString *)method
@@ -576,7 +965,14 @@ static void AFNetworkReachabilityReleaseCallback(const void *info) {
     NSString *pathToBeMatched = [[[self requestWithMethod:(method ?: @"GET") path:path parameters:nil] URL] path];
 #pragma clang diagnostic pop
 
-    for (NSOperation *operation in [self.operationQueue operations]) {
+    NSMutableArray *operations = [NSMutableArray arrayWithArray:[self.operationQueue operations]];
+    @synchronized(self.runningOperationCountsByHost) {
+        for (NSArray *pendingOperations in [self.pendingOperationsByHost allValues]) {
+            [operations addObjectsFromArray:pendingOperations];
+        }
+    }
+
+    for (NSOperation *operation in operations) {
         if (![operation isKindOfClass:[AFHTTPRequestOperation class]]) {
             continue;
         }
@@ -648,7 +1044,9 @@ static void AFNetworkReachabilityReleaseCallback(const void *info) {
         dispatch_group_enter(dispatchGroup);
         [batchedOperation addDependency:operation];
     }
-    [self.operationQueue addOperations:operations waitUntilFinished:NO];
+    for (AFHTTPRequestOperation *operation in operations) {
+        [self enqueueHTTPRequestOperation:operation];
+    }
     [self.operationQueue addOperation:batchedOperation];
 }
 
@@ -1172,8 +1570,20 @@ typedef enum {
     AFHTTPBodyPartReadPhase _phase;
     NSInputStream *_inputStream;
     unsigned long long _phaseReadOffset;
+    NSData *_encapsulationBoundaryData;
+    NSData *_headersData;
+    NSData *_closingBoundaryData;
+    NSData *_bodyData;
+    BOOL _bodyDataLoaded;
+    BOOL _bodyDataRead;
 }
 
+// The body when it can be read without a stream: an `NSData` body, or a file body mapped in memory
+@property (nonatomic, readonly) NSData *bodyData;
+@property (nonatomic, readonly) NSData *encapsulationBoundaryData;
+@property (nonatomic, readonly) NSData *headersData;
+@property (nonatomic, readonly) NSData *closingBoundaryData;
+
 - (BOOL)transitionToNextPhase;
 - (NSInteger)readData:(NSData *)data
            intoBuffer:(uint8_t *)buffer
@@ -1221,6 +1631,65 @@ typedef enum {
     return _inputStream;
 }
 
+- (void)setHeaders:(NSDictionary *)headers {
+    _headers = headers;
+    _headersData = nil;
+}
+
+- (void)setHasInitialBoundary:(BOOL)hasInitialBoundary {
+    _hasInitialBoundary = hasInitialBoundary;
+    _encapsulationBoundaryData = nil;
+}
+
+- (void)setHasFinalBoundary:(BOOL)hasFinalBoundary {
+    _hasFinalBoundary = hasFinalBoundary;
+    _closingBoundaryData = nil;
+}
+
+- (void)setBody:(id)body {
+    _body = body;
+    _bodyData = nil;
+    _bodyDataLoaded = NO;
+}
+
+- (NSData *)bodyData {
+    if (!_bodyDataLoaded) {
+        _bodyDataLoaded = YES;
+        if ([self.body isKindOfClass:[NSData class]]) {
+            _bodyData = self.body;
+        } else if ([self.body isKindOfClass:[NSURL class]] && [self.body isFileURL]) {
+            // Mapped files are paged in as they are read instead of being copied to the heap
+            _bodyData = [NSData dataWithContentsOfURL:self.body options:NSDataReadingMappedIfSafe error:nil];
+        }
+    }
+
+    return _bodyData;
+}
+
+- (NSData *)encapsulationBoundaryData {
+    if (!_encapsulationBoundaryData) {
+        _encapsulationBoundaryData = [([self hasInitialBoundary] ? AFMultipartFormInitialBoundary() : AFMultipartFormEncapsulationBoundary()) dataUsingEncoding:self.stringEncoding];
+    }
+
+    return _encapsulationBoundaryData;
+}
+
+- (NSData *)headersData {
+    if (!_headersData) {
+        _headersData = [[self stringForHeaders] dataUsingEncoding:self.stringEncoding];
+    }
+
+    return _headersData;
+}
+
+- (NSData *)closingBoundaryData {
+    if (!_closingBoundaryData) {
+        _closingBoundaryData = ([self hasFinalBoundary] ? [AFMultipartFormFinalBoundary() dataUsingEncoding:self.stringEncoding] : [NSData data]);
+    }
+
+    return _closingBoundaryData;
+}
+
 - (NSString *)stringForHeaders {
     NSMutableString *headerString = [NSMutableString string];
     for (NSString *field in [self.headers allKeys]) {
@@ -1234,16 +1703,10 @@ typedef enum {
 - (unsigned long long)contentLength {
     unsigned long long length = 0;
 
-    NSData *encapsulationBoundaryData = [([self hasInitialBoundary] ? AFMultipartFormInitialBoundary() : AFMultipartFormEncapsulationBoundary()) dataUsingEncoding:self.stringEncoding];
-    length += [encapsulationBoundaryData length];
-
-    NSData *headersData = [[self stringForHeaders] dataUsingEncoding:self.stringEncoding];
-    length += [headersData length];
-
+    length += [self.encapsulationBoundaryData length];
+    length += [self.headersData length];
     length += _bodyContentLength;
-
-    NSData *closingBoundaryData = ([self hasFinalBoundary] ? [AFMultipartFormFinalBoundary() dataUsingEncoding:self.stringEncoding] : [NSData data]);
-    length += [closingBoundaryData length];
+    length += [self.closingBoundaryData length];
 
     return length;
 }
@@ -1254,6 +1717,10 @@ typedef enum {
         return YES;
     }
 
+    if (self.bodyData) {
+        return !_bodyDataRead;
+    }
+
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wcovered-switch-default"
     switch (self.inputStream.streamStatus) {
@@ -1278,16 +1745,17 @@ typedef enum {
     NSInteger bytesRead = 0;
 
     if (_phase == AFEncapsulationBoundaryPhase) {
-        NSData *encapsulationBoundaryData = [([self hasInitialBoundary] ? AFMultipartFormInitialBoundary() : AFMultipartFormEncapsulationBoundary()) dataUsingEncoding:self.stringEncoding];
-        bytesRead += [self readData:encapsulationBoundaryData intoBuffer:&buffer[bytesRead] maxLength:(length - (NSUInteger)bytesRead)];
+        bytesRead += [self readData:self.encapsulationBoundaryData intoBuffer:&buffer[bytesRead] maxLength:(length - (NSUInteger)bytesRead)];
     }
 
     if (_phase == AFHeaderPhase) {
-        NSData *headersData = [[self stringForHeaders] dataUsingEncoding:self.stringEncoding];
-        bytesRead += [self readData:headersData intoBuffer:&buffer[bytesRead] maxLength:(length - (NSUInteger)bytesRead)];
+        bytesRead += [self readData:self.headersData intoBuffer:&buffer[bytesRead] maxLength:(length - (NSUInteger)bytesRead)];
     }
 
-    if (_phase == AFBodyPhase) {
+    if (_phase == AFBodyPhase && self.bodyData) {
+        // Copy straight from the data or the file mapping, without an intermediate stream
+        bytesRead += [self readData:self.bodyData intoBuffer:&buffer[bytesRead] maxLength:(length - (NSUInteger)bytesRead)];
+    } else if (_phase == AFBodyPhase) {
         if ([self.inputStream hasBytesAvailable]) {
             bytesRead += [self.inputStream read:&buffer[bytesRead] maxLength:(length - (NSUInteger)bytesRead)];
         }
@@ -1298,8 +1766,7 @@ typedef enum {
     }
 
     if (_phase == AFFinalBoundaryPhase) {
-        NSData *closingBoundaryData = ([self hasFinalBoundary] ? [AFMultipartFormFinalBoundary() dataUsingEncoding:self.stringEncoding] : [NSData data]);
-        bytesRead += [self readData:closingBoundaryData intoBuffer:&buffer[bytesRead] maxLength:(length - (NSUInteger)bytesRead)];
+        bytesRead += [self readData:self.closingBoundaryData intoBuffer:&buffer[bytesRead] maxLength:(length - (NSUInteger)bytesRead)];
     }
 
     return bytesRead;
@@ -1325,7 +1792,9 @@ typedef enum {
 }
 
 - (BOOL)transitionToNextPhase {
-    if (![[NSThread currentThread] isMainThread]) {
+    // Only body streams need to be scheduled on the main run loop
+    BOOL streamed = !self.bodyData;
+    if (streamed && ![[NSThread currentThread] isMainThread]) {
         [self performSelectorOnMainThread:@selector(transitionToNextPhase) withObject:nil waitUntilDone:YES];
         return YES;
     }
@@ -1337,12 +1806,18 @@ typedef enum {
             _phase = AFHeaderPhase;
             break;
         case AFHeaderPhase:
-            [self.inputStream scheduleInRunLoop:[NSRunLoop currentRunLoop] forMode:NSRunLoopCommonModes];
-            [self.inputStream open];
+            if (streamed) {
+                [self.inputStream scheduleInRunLoop:[NSRunLoop currentRunLoop] forMode:NSRunLoopCommonModes];
+                [self.inputStream open];
+            }
             _phase = AFBodyPhase;
             break;
         case AFBodyPhase:
-            [self.inputStream close];
+            if (streamed) {
+                [self.inputStream close];
+            } else {
+                _bodyDataRead = YES;
+            }
             _phase = AFFinalBoundaryPhase;
             break;
         case AFFinalBoundaryPhase:
@@ -65,6 +65,11 @@
  The scale factor used when interpreting the image data to construct `responseImage`. Specifying a scale factor of 1.0 results in an image whose size matches the pixel-based dimensions of the image. Applying a different scale factor changes the size of the image as reported by the size property. This is set to the value of scale of the main screen by default, which automatically scales images for retina displays, for instance.
  */
 @property (nonatomic, assign) CGFloat imageScale;
+
+/**
+ The size, in pixels, the image should be displayed at. When set, `responseImage` is decoded and downsampled in a single pass, so that it is just large enough to fill this size while keeping its aspect ratio. Images are never upsampled, and only the first frame of animated images is kept. This is `CGSizeZero` by default, which decodes images at full resolution.
+ */
+@property (nonatomic, assign) CGSize targetPixelSize;
 #endif
 
 /**
@@ -106,3 +111,20 @@
 #endif
 
 @end
+
+#if defined(__IPHONE_OS_VERSION_MIN_REQUIRED)
+///----------------
+/// @name Functions
+///----------------
+
+/**
+ Decodes image data and downsamples it in a single pass, so that the resulting bitmap is just large enough to fill `pixelSize` while keeping its aspect ratio. The returned image is already decoded, and can be drawn on the main thread without further work.
+
+ @param data The image data
+ @param scale The scale of the returned image
+ @param pixelSize The size the image should fill, in pixels. If `CGSizeZero`, or larger than the image, the image is decoded at full resolution.
+
+ @return The decoded image, or `nil` if the data could not be decoded
+ */
+extern UIImage * AFDecodedImageWithData(NSData *data, CGFloat scale, CGSize pixelSize);
+#endif
@@ -22,6 +22,10 @@
 
 #import "AFImageRequestOperation.h"
 
+#if defined(__IPHONE_OS_VERSION_MIN_REQUIRED)
+#import <ImageIO/ImageIO.h>
+#endif
+
 static dispatch_queue_t image_request_operation_processing_queue() {
     static dispatch_queue_t af_image_request_operation_processing_queue;
     static dispatch_once_t onceToken;
@@ -40,10 +44,60 @@ static dispatch_queue_t image_request_operation_processing_queue() {
 #endif
 @end
 
+#if defined(__IPHONE_OS_VERSION_MIN_REQUIRED)
+UIImage * AFDecodedImageWithData(NSData *data, CGFloat scale, CGSize pixelSize) {
+    if ([data length] == 0) {
+        return nil;
+    }
+
+    CGImageSourceRef source = CGImageSourceCreateWithData((__bridge CFDataRef)data, NULL);
+    if (!source) {
+        return nil;
+    }
+
+    CGFloat width = 0.0f;
+    CGFloat height = 0.0f;
+    CFDictionaryRef properties = CGImageSourceCopyPropertiesAtIndex(source, 0, NULL);
+    if (properties) {
+        NSDictionary *imageProperties = (__bridge NSDictionary *)properties;
+        width = [[imageProperties objectForKey:(__bridge NSString *)kCGImagePropertyPixelWidth] floatValue];
+        height = [[imageProperties objectForKey:(__bridge NSString *)kCGImagePropertyPixelHeight] floatValue];
+        CFRelease(properties);
+    }
+
+    // The thumbnail is bounded by its largest side: scale it so that both sides fill the target size
+    CGFloat maxPixelSize = MAX(width, height);
+    if (pixelSize.width > 0.0f && pixelSize.height > 0.0f && width > 0.0f && height > 0.0f) {
+        CGFloat ratio = MIN(MAX(pixelSize.width / width, pixelSize.height / height), 1.0f);
+        maxPixelSize = ceil(maxPixelSize * ratio);
+    }
+
+    NSMutableDictionary *options = [NSMutableDictionary dictionary];
+    [options setObject:(__bridge id)kCFBooleanTrue forKey:(__bridge NSString *)kCGImageSourceCreateThumbnailFromImageAlways];
+    [options setObject:(__bridge id)kCFBooleanTrue forKey:(__bridge NSString *)kCGImageSourceCreateThumbnailWithTransform];
+    [options setObject:(__bridge id)kCFBooleanTrue forKey:(__bridge NSString *)kCGImageSourceShouldCache];
+    if (maxPixelSize > 0.0f) {
+        [options setObject:[NSNumber numberWithFloat:maxPixelSize] forKey:(__bridge NSString *)kCGImageSourceThumbnailMaxPixelSize];
+    }
+
+    CGImageRef imageRef = CGImageSourceCreateThumbnailAtIndex(source, 0, (__bridge CFDictionaryRef)options);
+    CFRelease(source);
+    if (!imageRef) {
+        return nil;
+    }
+
+    UIImage *image = [UIImage imageWithCGImage:imageRef scale:scale orientation:UIImageOrientationUp];
+    CGImageRelease(imageRef);
+
+    return image;
+}
+#endif
+
 @implementation AFImageRequestOperation
 @synthesize responseImage = _responseImage;
 #if defined(__IPHONE_OS_VERSION_MIN_REQUIRED)
 @synthesize imageScale = _imageScale;
+@synthesize targetPixelSize = _targetPixelSize;
 #endif
 
 #if defined(__IPHONE_OS_VERSION_MIN_REQUIRED)
@@ -151,14 +205,28 @@ static dispatch_queue_t image_request_operation_processing_queue() {
 #if defined(__IPHONE_OS_VERSION_MIN_REQUIRED)
 - (UIImage *)responseImage {
     if (!_responseImage && [self.responseData length] > 0 && [self isFinished]) {
-        UIImage *image = [UIImage imageWithData:self.responseData];
+        if (!CGSizeEqualToSize(self.targetPixelSize, CGSizeZero)) {
+            self.responseImage = AFDecodedImageWithData(self.responseData, self.imageScale, self.targetPixelSize);
+        } else {
+            UIImage *image = [UIImage imageWithData:self.responseData];
 
-        self.responseImage = [UIImage imageWithCGImage:[image CGImage] scale:self.imageScale orientation:image.imageOrientation];
+            self.responseImage = [UIImage imageWithCGImage:[image CGImage] scale:self.imageScale orientation:image.imageOrientation];
+        }
     }
 
     return _responseImage;
 }
 
+- (void)setTargetPixelSize:(CGSize)targetPixelSize {
+    if (CGSizeEqualToSize(targetPixelSize, _targetPixelSize)) {
+        return;
+    }
+
+    _targetPixelSize = targetPixelSize;
+
+    self.responseImage = nil;
+}
+
 - (void)setImageScale:(CGFloat)imageScale {
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wfloat-equal"
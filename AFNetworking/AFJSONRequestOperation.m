@@ -35,14 +35,12 @@ static dispatch_queue_t json_request_operation_processing_queue() {
 @interface AFJSONRequestOperation ()
 @property (readwrite, nonatomic, strong) id responseJSON;
 @property (readwrite, nonatomic, strong) NSError *JSONError;
-@property (readwrite, nonatomic, strong) NSRecursiveLock *lock;
 @end
 
 @implementation AFJSONRequestOperation
 @synthesize responseJSON = _responseJSON;
 @synthesize JSONReadingOptions = _JSONReadingOptions;
 @synthesize JSONError = _JSONError;
-@dynamic lock;
 
 + (instancetype)JSONRequestOperationWithRequest:(NSURLRequest *)urlRequest
 										success:(void (^)(NSURLRequest *request, NSHTTPURLResponse *response, id JSON))success
@@ -64,8 +62,9 @@ static dispatch_queue_t json_request_operation_processing_queue() {
 
 
 - (id)responseJSON {
-    [self.lock lock];
+    // Parsing happens without any lock held: concurrent callers may both parse, and the first result is published
     if (!_responseJSON && [self.responseData length] > 0 && [self isFinished] && !self.JSONError) {
+        id JSON = nil;
         NSError *error = nil;
 
         // Workaround for behavior of Rails to return a single space for `head :ok` (a workaround for a bug in Safari), which is not interpreted as valid input by NSJSONSerialization.
@@ -76,7 +75,7 @@ static dispatch_queue_t json_request_operation_processing_queue() {
             NSData *data = [self.responseString dataUsingEncoding:NSUTF8StringEncoding];
 
             if (data) {
-                self.responseJSON = [NSJSONSerialization JSONObjectWithData:data options:self.JSONReadingOptions error:&error];
+                JSON = [NSJSONSerialization JSONObjectWithData:data options:self.JSONReadingOptions error:&error];
             } else {
                 NSMutableDictionary *userInfo = [NSMutableDictionary dictionary];
                 [userInfo setValue:@"Operation responseData failed decoding as a UTF-8 string" forKey:NSLocalizedDescriptionKey];
@@ -85,9 +84,12 @@ static dispatch_queue_t json_request_operation_processing_queue() {
             }
         }
 
-        self.JSONError = error;
+        if (JSON) {
+            return AFPublishObjectOnce(&_responseJSON, JSON);
+        }
+
+        AFPublishObjectOnce(&_JSONError, error);
     }
-    [self.lock unlock];
 
     return _responseJSON;
 }
@@ -115,6 +115,22 @@ NSCoding, NSCopying>
  */
 @property (nonatomic, strong) NSSet *runLoopModes;
 
+///----------------------------------
+/// @name Configuring Network Threads
+///----------------------------------
+
+/**
+ Sets the number of threads servicing the connections of new operations. Each operation runs on one of these threads, assigned in turn when the operation is created. Defaults to 1.
+
+ @param count The number of network threads. Threads are created as needed, and lowering the count only affects operations created afterwards.
+ */
++ (void)setNetworkRequestThreadCount:(NSUInteger)count;
+
+/**
+ The number of threads servicing the connections of new operations.
+ */
++ (NSUInteger)networkRequestThreadCount;
+
 ///-----------------------------------------
 /// @name Getting URL Connection Information
 ///-----------------------------------------
@@ -405,3 +421,17 @@ extern NSString * const AFNetworkingOperationDidStartNotification;
  Posted when an operation finishes.
  */
 extern NSString * const AFNetworkingOperationDidFinishNotification;
+
+///----------------
+/// @name Functions
+///----------------
+
+/**
+ Atomically stores `value` in `slot` if `slot` is still `nil`, so that a lazily computed object is published exactly once even if several threads compute it at the same time.
+
+ @param slot The address of a strong instance variable
+ @param value The computed object
+
+ @return The object stored in `slot`, which is `value` unless another thread published first
+ */
+extern id AFPublishObjectOnce(id __strong *slot, id value);
@@ -26,6 +26,8 @@
 #import <UIKit/UIKit.h>
 #endif
 
+#import <libkern/OSAtomic.h>
+
 #if !__has_feature(objc_arc)
 #error AFNetworking must be built with ARC.
 // You can turn on ARC for only AFNetworking files by adding -fobjc-arc to the build phase for each of its files.
@@ -38,7 +40,7 @@ typedef enum {
     AFOperationFinishedState    = 3,
 } _AFOperationState;
 
-typedef signed short AFOperationState;
+typedef int32_t AFOperationState;
 
 #if defined(__IPHONE_OS_VERSION_MIN_REQUIRED)
 typedef UIBackgroundTaskIdentifier AFBackgroundTaskIdentifier;
@@ -46,7 +48,7 @@ typedef UIBackgroundTaskIdentifier AFBackgroundTaskIdentifier;
 typedef id AFBackgroundTaskIdentifier;
 #endif
 
-static NSString * const kAFNetworkingLockName = @"com.alamofire.networking.operation.lock";
+static NSUInteger AFNetworkRequestThreadCount = 1;
 
 NSString * const AFNetworkingErrorDomain = @"AFNetworkingErrorDomain";
 NSString * const AFNetworkingOperationFailingURLRequestErrorKey = @"AFNetworkingOperationFailingURLRequestErrorKey";
@@ -107,6 +109,23 @@ static inline BOOL AFStateTransitionIsValid(AFOperationState fromState, AFOperat
     }
 }
 
+id AFPublishObjectOnce(id __strong *slot, id value) {
+    if (!value) {
+        return *slot;
+    }
+
+    // The slot owns the retain taken here once the swap succeeds
+    void *retainedValue = (__bridge_retained void *)value;
+    if (OSAtomicCompareAndSwapPtrBarrier(NULL, retainedValue, (void * volatile *)(void *)slot)) {
+        return value;
+    }
+
+    CFRelease(retainedValue);
+    OSMemoryBarrier();
+
+    return *slot;
+}
+
 #if !defined(__IPHONE_OS_VERSION_MIN_REQUIRED)
 static NSData *AFSecKeyGetData(SecKeyRef key) {
     CFDataRef data = NULL;
@@ -127,10 +146,12 @@ static BOOL AFSecKeyIsEqualToKey(SecKeyRef key1, SecKeyRef key2) {
 #endif
 }
 
-@interface AFURLConnectionOperation ()
+@interface AFURLConnectionOperation () {
+    volatile AFOperationState _state;
+    volatile int32_t _cancelled;
+}
 @property (readwrite, nonatomic, assign) AFOperationState state;
 @property (readwrite, nonatomic, assign, getter = isCancelled) BOOL cancelled;
-@property (readwrite, nonatomic, strong) NSRecursiveLock *lock;
 @property (readwrite, nonatomic, strong) NSURLConnection *connection;
 @property (readwrite, nonatomic, strong) NSURLRequest *request;
 @property (readwrite, nonatomic, strong) NSURLResponse *response;
@@ -148,15 +169,17 @@ static BOOL AFSecKeyIsEqualToKey(SecKeyRef key1, SecKeyRef key2) {
 @property (readwrite, nonatomic, copy) AFURLConnectionOperationAuthenticationChallengeBlock authenticationChallenge;
 @property (readwrite, nonatomic, copy) AFURLConnectionOperationCacheResponseBlock cacheResponse;
 @property (readwrite, nonatomic, copy) AFURLConnectionOperationRedirectResponseBlock redirectResponse;
+@property (readwrite, nonatomic, strong) NSThread *networkThread;
 
++ (NSThread *)networkRequestThreadAtIndex:(NSUInteger)index;
++ (NSThread *)nextNetworkRequestThread;
+- (BOOL)transitionToState:(AFOperationState)state fromState:(AFOperationState)fromState;
 - (void)operationDidStart;
 - (void)finish;
 - (void)cancelConnection;
 @end
 
 @implementation AFURLConnectionOperation
-@synthesize state = _state;
-@synthesize cancelled = _cancelled;
 @synthesize connection = _connection;
 @synthesize runLoopModes = _runLoopModes;
 @synthesize request = _request;
@@ -184,26 +207,56 @@ static BOOL AFSecKeyIsEqualToKey(SecKeyRef key1, SecKeyRef key2) {
 #endif
 @synthesize cacheResponse = _cacheResponse;
 @synthesize redirectResponse = _redirectResponse;
-@synthesize lock = _lock;
+@synthesize networkThread = _networkThread;
 
 + (void) __attribute__((noreturn)) networkRequestThreadEntryPoint:(id)__unused object {
     do {
         @autoreleasepool {
-            [[NSThread currentThread] setName:@"AFNetworking"];
             [[NSRunLoop currentRunLoop] run];
         }
     } while (YES);
 }
 
-+ (NSThread *)networkRequestThread {
-    static NSThread *_networkRequestThread = nil;
++ (void)setNetworkRequestThreadCount:(NSUInteger)count {
+    AFNetworkRequestThreadCount = MAX(count, (NSUInteger)1);
+}
+
++ (NSUInteger)networkRequestThreadCount {
+    return AFNetworkRequestThreadCount;
+}
+
++ (NSThread *)networkRequestThreadAtIndex:(NSUInteger)index {
+    static NSMutableArray *_networkRequestThreads = nil;
     static dispatch_once_t oncePredicate;
     dispatch_once(&oncePredicate, ^{
-        _networkRequestThread = [[NSThread alloc] initWithTarget:self selector:@selector(networkRequestThreadEntryPoint:) object:nil];
-        [_networkRequestThread start];
+        _networkRequestThreads = [[NSMutableArray alloc] init];
     });
-    
-    return _networkRequestThread;
+
+    @synchronized(_networkRequestThreads) {
+        while ([_networkRequestThreads count] <= index) {
+            NSThread *thread = [[NSThread alloc] initWithTarget:[AFURLConnectionOperation class] selector:@selector(networkRequestThreadEntryPoint:) object:nil];
+            [thread setName:([_networkRequestThreads count] ? [NSString stringWithFormat:@"AFNetworking %lu", (unsigned long)[_networkRequestThreads count]] : @"AFNetworking")];
+            [thread start];
+            [_networkRequestThreads addObject:thread];
+        }
+
+        return [_networkRequestThreads objectAtIndex:index];
+    }
+}
+
++ (NSThread *)networkRequestThread {
+    return [self networkRequestThreadAtIndex:0];
+}
+
++ (NSThread *)nextNetworkRequestThread {
+    static volatile int32_t _nextNetworkRequestThread = 0;
+
+    NSUInteger count = AFNetworkRequestThreadCount;
+    if (count <= 1) {
+        return [self networkRequestThread];
+    }
+
+    return [self networkRequestThreadAtIndex:(NSUInteger)(uint32_t)OSAtomicIncrement32(&_nextNetworkRequestThread) % count];
 }
 
 #ifdef _AFNETWORKING_PIN_SSL_CERTIFICATES_
@@ -272,12 +325,12 @@ static BOOL AFSecKeyIsEqualToKey(SecKeyRef key1, SecKeyRef key2) {
 		return nil;
     }
     
-    self.lock = [[NSRecursiveLock alloc] init];
-    self.lock.name = kAFNetworkingLockName;
-    
     self.runLoopModes = [NSSet setWithObject:NSRunLoopCommonModes];
     
     self.request = urlRequest;
+
+    // Every callback of this operation happens on the same network thread
+    self.networkThread = [[self class] nextNetworkRequestThread];
     
     self.shouldUseCredentialStorage = YES;
 
@@ -310,7 +363,6 @@ static BOOL AFSecKeyIsEqualToKey(SecKeyRef key1, SecKeyRef key2) {
 }
 
 - (void)setCompletionBlock:(void (^)(void))block {
-    [self.lock lock];
     if (!block) {
         [super setCompletionBlock:nil];
     } else {
@@ -322,7 +374,6 @@ static BOOL AFSecKeyIsEqualToKey(SecKeyRef key1, SecKeyRef key2) {
             [strongSelf setCompletionBlock:nil];
         }];
     }
-    [self.lock unlock];
 }
 
 - (NSInputStream *)inputStream {
@@ -339,14 +390,16 @@ static BOOL AFSecKeyIsEqualToKey(SecKeyRef key1, SecKeyRef key2) {
 
 - (NSOutputStream *)outputStream {
     if (!_outputStream) {
-        self.outputStream = [NSOutputStream outputStreamToMemory];
+        [self willChangeValueForKey:@"outputStream"];
+        AFPublishObjectOnce(&_outputStream, [NSOutputStream outputStreamToMemory]);
+        [self didChangeValueForKey:@"outputStream"];
     }
 
     return _outputStream;
 }
 
 - (void)setOutputStream:(NSOutputStream *)outputStream {
-    [self.lock lock];
+    // The output stream is only replaced before the operation starts
     if (outputStream != _outputStream) {
         [self willChangeValueForKey:@"outputStream"];
         if (_outputStream) {
@@ -355,31 +408,30 @@ static BOOL AFSecKeyIsEqualToKey(SecKeyRef key1, SecKeyRef key2) {
         _outputStream = outputStream;
         [self didChangeValueForKey:@"outputStream"];
     }
-    [self.lock unlock];
 }
 
 #if defined(__IPHONE_OS_VERSION_MIN_REQUIRED)
 - (void)setShouldExecuteAsBackgroundTaskWithExpirationHandler:(void (^)(void))handler {
-    [self.lock lock];
-    if (!self.backgroundTaskIdentifier) {
-        UIApplication *application = [UIApplication sharedApplication];
-        __weak __typeof(&*self)weakSelf = self;
-        self.backgroundTaskIdentifier = [application beginBackgroundTaskWithExpirationHandler:^{
-            __strong __typeof(&*weakSelf)strongSelf = weakSelf;
+    @synchronized(self) {
+        if (!self.backgroundTaskIdentifier) {
+            UIApplication *application = [UIApplication sharedApplication];
+            __weak __typeof(&*self)weakSelf = self;
+            self.backgroundTaskIdentifier = [application beginBackgroundTaskWithExpirationHandler:^{
+                __strong __typeof(&*weakSelf)strongSelf = weakSelf;
             
-            if (handler) {
-                handler();
-            }
+                if (handler) {
+                    handler();
+                }
             
-            if (strongSelf) {
-                [strongSelf cancel];
+                if (strongSelf) {
+                    [strongSelf cancel];
                 
-                [application endBackgroundTask:strongSelf.backgroundTaskIdentifier];
-                strongSelf.backgroundTaskIdentifier = UIBackgroundTaskInvalid;
-            }
-        }];
+                    [application endBackgroundTask:strongSelf.backgroundTaskIdentifier];
+                    strongSelf.backgroundTaskIdentifier = UIBackgroundTaskInvalid;
+                }
+            }];
+        }
     }
-    [self.lock unlock];
 }
 #endif
 
@@ -417,35 +469,54 @@ static BOOL AFSecKeyIsEqualToKey(SecKeyRef key1, SecKeyRef key2) {
     self.redirectResponse = block;
 }
 
+- (AFOperationState)state {
+    return _state;
+}
+
 - (void)setState:(AFOperationState)state {
-    if (!AFStateTransitionIsValid(self.state, state, [self isCancelled])) {
-        return;
+    AFOperationState fromState;
+    do {
+        fromState = _state;
+    } while (AFStateTransitionIsValid(fromState, state, [self isCancelled]) && ![self transitionToState:state fromState:fromState]);
+}
+
+- (BOOL)transitionToState:(AFOperationState)state fromState:(AFOperationState)fromState {
+    if (_state != fromState || !AFStateTransitionIsValid(fromState, state, [self isCancelled])) {
+        return NO;
     }
-    
-    [self.lock lock];
-    NSString *oldStateKey = AFKeyPathFromOperationState(self.state);
+
+    NSString *oldStateKey = AFKeyPathFromOperationState(fromState);
     NSString *newStateKey = AFKeyPathFromOperationState(state);
-    
+
+    // A lost race leaves the state untouched, which observers see as a change to the same value
     [self willChangeValueForKey:newStateKey];
     [self willChangeValueForKey:oldStateKey];
-    _state = state;
+    BOOL didTransition = OSAtomicCompareAndSwap32Barrier(fromState, state, &_state);
     [self didChangeValueForKey:oldStateKey];
     [self didChangeValueForKey:newStateKey];
-    [self.lock unlock];
+
+    return didTransition;
+}
+
+- (BOOL)isCancelled {
+    return _cancelled != 0;
+}
+
+- (void)setCancelled:(BOOL)cancelled {
+    _cancelled = cancelled ? 1 : 0;
+    OSMemoryBarrier();
 }
 
 - (NSString *)responseString {
-    [self.lock lock];
     if (!_responseString && self.response && self.responseData) {
-        self.responseString = [[NSString alloc] initWithData:self.responseData encoding:self.responseStringEncoding];
+        AFPublishObjectOnce(&_responseString, [[NSString alloc] initWithData:self.responseData encoding:self.responseStringEncoding]);
     }
-    [self.lock unlock];
-    
+
     return _responseString;
 }
 
 - (NSStringEncoding)responseStringEncoding {
-    [self.lock lock];
+    // Computing the encoding is idempotent, so concurrent callers may race harmlessly
     if (!_responseStringEncoding && self.response) {
         NSStringEncoding stringEncoding = NSUTF8StringEncoding;
         if (self.response.textEncodingName) {
@@ -457,8 +528,7 @@ static BOOL AFSecKeyIsEqualToKey(SecKeyRef key1, SecKeyRef key2) {
         
         self.responseStringEncoding = stringEncoding;
     }
-    [self.lock unlock];
-    
+
     return _responseStringEncoding;
 }
 
@@ -466,21 +536,17 @@ static BOOL AFSecKeyIsEqualToKey(SecKeyRef key1, SecKeyRef key2) {
     if ([self isPaused] || [self isFinished] || [self isCancelled]) {
         return;
     }
-    
-    [self.lock lock];
-    
-    if ([self isExecuting]) {
-        [self.connection performSelector:@selector(cancel) onThread:[[self class] networkRequestThread] withObject:nil waitUntilDone:NO modes:[self.runLoopModes allObjects]];
+
+    if ([self transitionToState:AFOperationPausedState fromState:AFOperationExecutingState]) {
+        [self.connection performSelector:@selector(cancel) onThread:self.networkThread withObject:nil waitUntilDone:NO modes:[self.runLoopModes allObjects]];
         
         dispatch_async(dispatch_get_main_queue(), ^{
             NSNotificationCenter *notificationCenter = [NSNotificationCenter defaultCenter];
             [notificationCenter postNotificationName:AFNetworkingOperationDidFinishNotification object:self];
         });
+    } else {
+        [self transitionToState:AFOperationPausedState fromState:AFOperationReadyState];
     }
-    
-    self.state = AFOperationPausedState;
-    
-    [self.lock unlock];
 }
 
 - (BOOL)isPaused {
@@ -492,11 +558,9 @@ static BOOL AFSecKeyIsEqualToKey(SecKeyRef key1, SecKeyRef key2) {
         return;
     }
     
-    [self.lock lock];
-    self.state = AFOperationReadyState;
-    
-    [self start];
-    [self.lock unlock];
+    if ([self transitionToState:AFOperationReadyState fromState:AFOperationPausedState]) {
+        [self start];
+    }
 }
 
 #pragma mark - NSOperation
@@ -518,17 +582,14 @@ static BOOL AFSecKeyIsEqualToKey(SecKeyRef key1, SecKeyRef key2) {
 }
 
 - (void)start {
-    [self.lock lock];
-    if ([self isReady]) {
-        self.state = AFOperationExecutingState;
-        
-        [self performSelector:@selector(operationDidStart) onThread:[[self class] networkRequestThread] withObject:nil waitUntilDone:NO modes:[self.runLoopModes allObjects]];
+    // Only the caller that wins the transition schedules the connection
+    if ([super isReady] && [self transitionToState:AFOperationExecutingState fromState:AFOperationReadyState]) {
+        [self performSelector:@selector(operationDidStart) onThread:self.networkThread withObject:nil waitUntilDone:NO modes:[self.runLoopModes allObjects]];
     }
-    [self.lock unlock];
 }
 
 - (void)operationDidStart {
-    [self.lock lock];
+    // Runs on the network thread, as does cancelConnection, so the two never interleave
     if (! [self isCancelled]) {
         self.connection = [[NSURLConnection alloc] initWithRequest:self.request delegate:self startImmediately:NO];
         
@@ -540,7 +601,6 @@ static BOOL AFSecKeyIsEqualToKey(SecKeyRef key1, SecKeyRef key2) {
         
         [self.connection start];
     }
-    [self.lock unlock];
     
     dispatch_async(dispatch_get_main_queue(), ^{
         [[NSNotificationCenter defaultCenter] postNotificationName:AFNetworkingOperationDidStartNotification object:self];
@@ -560,17 +620,21 @@ static BOOL AFSecKeyIsEqualToKey(SecKeyRef key1, SecKeyRef key2) {
 }
 
 - (void)cancel {
-    [self.lock lock];
-    if (![self isFinished] && ![self isCancelled]) {
-        [self willChangeValueForKey:@"isCancelled"];
-        _cancelled = YES;
+    if ([self isFinished]) {
+        return;
+    }
+
+    [self willChangeValueForKey:@"isCancelled"];
+    BOOL didCancel = OSAtomicCompareAndSwap32Barrier(0, 1, &_cancelled);
+    if (didCancel) {
         [super cancel];
-        [self didChangeValueForKey:@"isCancelled"];
-        
+    }
+    [self didChangeValueForKey:@"isCancelled"];
+
+    if (didCancel) {
         // Cancel the connection on the thread it runs on to prevent race conditions
-        [self performSelector:@selector(cancelConnection) onThread:[[self class] networkRequestThread] withObject:nil waitUntilDone:NO modes:[self.runLoopModes allObjects]];
+        [self performSelector:@selector(cancelConnection) onThread:self.networkThread withObject:nil waitUntilDone:NO modes:[self.runLoopModes allObjects]];
     }
-    [self.lock unlock];
 }
 
 - (void)cancelConnection {
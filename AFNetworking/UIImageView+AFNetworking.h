@@ -28,6 +28,150 @@
 #if __IPHONE_OS_VERSION_MIN_REQUIRED
 #import <UIKit/UIKit.h>
 
+/**
+ `AFImageCache` caches the images loaded by `UIImageView+AFNetworking` in two tiers.
+
+ The memory tier holds decoded bitmaps, so cached images are drawn without being decoded on the main thread. Its cost is the size of the pixel data of each image, and it is emptied when the application receives a memory warning.
+
+ The disk tier holds the downloaded image data, in files named after the SHA-1 digest of the request URL. When it grows over `diskCapacity`, the least recently used files are removed. Images found on disk are decoded and moved back to the memory tier.
+ */
+@interface AFImageCache : NSObject
+
+/**
+ Initializes a cache with the given capacities, storing its files in `path`.
+
+ @param memoryCapacity The maximum size of the decoded bitmaps kept in memory, in bytes
+ @param diskCapacity The maximum size of the files kept on disk, in bytes
+ @param path The directory of the disk tier, created if needed
+ */
+- (id)initWithMemoryCapacity:(NSUInteger)memoryCapacity
+                diskCapacity:(NSUInteger)diskCapacity
+                    diskPath:(NSString *)path;
+
+/**
+ The maximum size of the decoded bitmaps kept in memory, in bytes.
+ */
+@property (readonly, nonatomic, assign) NSUInteger memoryCapacity;
+
+/**
+ The maximum size of the files kept on disk, in bytes.
+ */
+@property (readonly, nonatomic, assign) NSUInteger diskCapacity;
+
+/**
+ The current size of the files kept on disk, in bytes.
+ */
+@property (readonly, nonatomic, assign) NSUInteger currentDiskUsage;
+
+///----------------------------
+/// @name Accessing Cached Images
+///----------------------------
+
+/**
+ Returns the decoded image cached in memory for the request, or `nil`. Requests ignoring their cache data always return `nil`.
+
+ @param request The image request
+ */
+- (UIImage *)cachedImageForRequest:(NSURLRequest *)request;
+
+/**
+ Returns the decoded image cached in memory for the request at the given size, or `nil`. Each size of an image is a separate memory entry.
+
+ @param request The image request
+ @param pixelSize The size the image was downsampled to, or `CGSizeZero` for the full resolution image
+ */
+- (UIImage *)cachedImageForRequest:(NSURLRequest *)request
+                         pixelSize:(CGSize)pixelSize;
+
+/**
+ Looks for the image of the request in the memory tier, then on disk. An image found on disk is decoded in the background and added to the memory tier.
+
+ @param request The image request
+ @param completion A block called on the main queue with the cached image, or `nil` if the request is not cached.
+ */
+- (void)loadImageForRequest:(NSURLRequest *)request
+                 completion:(void (^)(UIImage *image))completion;
+
+/**
+ Looks for the image of the request at the given size in the memory tier, then on disk. Every size of an image is read from the same file, which is decoded and downsampled to `pixelSize` in the background.
+
+ @param request The image request
+ @param pixelSize The size to downsample the image to, or `CGSizeZero` for the full resolution image
+ @param completion A block called on the main queue with the cached image, or `nil` if the request is not cached.
+ */
+- (void)loadImageForRequest:(NSURLRequest *)request
+                  pixelSize:(CGSize)pixelSize
+                 completion:(void (^)(UIImage *image))completion;
+
+/**
+ Decodes the image, keeps it in memory and writes its data to disk. This method should be called from a background queue.
+
+ @param image The downloaded image
+ @param data The data the image was created from, written to disk. If `nil`, the image is only cached in memory.
+ @param request The image request
+
+ @return The decoded image
+ */
+- (UIImage *)cacheImage:(UIImage *)image
+                   data:(NSData *)data
+             forRequest:(NSURLRequest *)request;
+
+/**
+ Keeps an image downsampled to the given size in memory, and writes its data to disk. Images downsampled by `AFDecodedImageWithData` are already decoded and are cached as is.
+
+ @param image The downloaded image, downsampled to `pixelSize`
+ @param data The data the image was created from, written to disk. If `nil`, the image is only cached in memory.
+ @param request The image request
+ @param pixelSize The size the image was downsampled to, or `CGSizeZero` for the full resolution image
+
+ @return The cached image
+ */
+- (UIImage *)cacheImage:(UIImage *)image
+                   data:(NSData *)data
+             forRequest:(NSURLRequest *)request
+              pixelSize:(CGSize)pixelSize;
+
+/**
+ Removes every image from the memory tier.
+ */
+- (void)removeAllMemoryCachedImages;
+
+/**
+ Removes every image from both tiers.
+ */
+- (void)removeAllCachedImages;
+
+///----------------------
+/// @name Cache Statistics
+///----------------------
+
+/**
+ The number of lookups answered by the memory tier.
+ */
+@property (readonly, nonatomic, assign) NSUInteger memoryHitCount;
+
+/**
+ The number of lookups answered by the disk tier.
+ */
+@property (readonly, nonatomic, assign) NSUInteger diskHitCount;
+
+/**
+ The number of lookups answered by neither tier.
+ */
+@property (readonly, nonatomic, assign) NSUInteger missCount;
+
+/**
+ The ratio of lookups answered by either tier, between 0 and 1.
+ */
+- (double)hitRatio;
+
+/**
+ Resets the hit and miss counters.
+ */
+- (void)resetStatistics;
+
+@end
+
 /**
  This category adds methods to the UIKit framework's `UIImageView` class. The methods in this category provide support for loading remote images asynchronously from a URL.
  */
@@ -68,11 +212,31 @@
                        success:(void (^)(NSURLRequest *request, NSHTTPURLResponse *response, UIImage *image))success
                        failure:(void (^)(NSURLRequest *request, NSHTTPURLResponse *response, NSError *error))failure;
 
+/**
+ Creates and enqueues an image request operation like `setImageWithURLRequest:placeholderImage:success:failure:`, and decodes the image downsampled to the given size off the main thread. Images are cached per URL and size, so a list of small avatars does not keep full resolution bitmaps in memory.
+
+ @param urlRequest The URL request used for the image request.
+ @param placeholderImage The image to be set initially, until the image request finishes. If `nil`, the image view will not change its image until the image request finishes.
+ @param targetPixelSize The size, in pixels, the image is displayed at. Usually the size of the image view multiplied by the scale of the screen. If `CGSizeZero`, the image is decoded at full resolution.
+ @param success A block to be executed when the image request operation finishes successfully. If the image was returned from cache, the request and response parameters will be `nil`.
+ @param failure A block object to be executed when the image request operation finishes unsuccessfully.
+ */
+- (void)setImageWithURLRequest:(NSURLRequest *)urlRequest
+              placeholderImage:(UIImage *)placeholderImage
+               targetPixelSize:(CGSize)targetPixelSize
+                       success:(void (^)(NSURLRequest *request, NSHTTPURLResponse *response, UIImage *image))success
+                       failure:(void (^)(NSURLRequest *request, NSHTTPURLResponse *response, NSError *error))failure;
+
 /**
  Cancels any executing image request operation for the receiver, if one exists.
  */
 - (void)cancelImageRequestOperation;
 
+/**
+ The image cache shared by every image view.
+ */
++ (AFImageCache *)af_sharedImageCache;
+
 @end
 
 #endif
@@ -22,15 +22,14 @@
 
 #import <Foundation/Foundation.h>
 #import <objc/runtime.h>
+#import <libkern/OSAtomic.h>
+#import <CommonCrypto/CommonDigest.h>
 
 #if defined(__IPHONE_OS_VERSION_MIN_REQUIRED)
 #import "UIImageView+AFNetworking.h"
 
-@interface AFImageCache : NSCache
-- (UIImage *)cachedImageForRequest:(NSURLRequest *)request;
-- (void)cacheImage:(UIImage *)image
-        forRequest:(NSURLRequest *)request;
-@end
+static NSUInteger const kAFImageCacheDefaultMemoryCapacity = 20 * 1024 * 1024;
+static NSUInteger const kAFImageCacheDefaultDiskCapacity = 50 * 1024 * 1024;
 
 #pragma mark -
 
@@ -71,7 +70,8 @@ static char kAFImageRequestOperationObjectKey;
     static AFImageCache *_af_imageCache = nil;
     static dispatch_once_t oncePredicate;
     dispatch_once(&oncePredicate, ^{
-        _af_imageCache = [[AFImageCache alloc] init];
+        NSString *cachesPath = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) lastObject];
+        _af_imageCache = [[AFImageCache alloc] initWithMemoryCapacity:kAFImageCacheDefaultMemoryCapacity diskCapacity:kAFImageCacheDefaultDiskCapacity diskPath:[cachesPath stringByAppendingPathComponent:@"com.alamofire.networking.image-cache"]];
     });
 
     return _af_imageCache;
@@ -96,10 +96,19 @@ static char kAFImageRequestOperationObjectKey;
               placeholderImage:(UIImage *)placeholderImage
                        success:(void (^)(NSURLRequest *request, NSHTTPURLResponse *response, UIImage *image))success
                        failure:(void (^)(NSURLRequest *request, NSHTTPURLResponse *response, NSError *error))failure
+{
+    [self setImageWithURLRequest:urlRequest placeholderImage:placeholderImage targetPixelSize:CGSizeZero success:success failure:failure];
+}
+
+- (void)setImageWithURLRequest:(NSURLRequest *)urlRequest
+              placeholderImage:(UIImage *)placeholderImage
+               targetPixelSize:(CGSize)targetPixelSize
+                       success:(void (^)(NSURLRequest *request, NSHTTPURLResponse *response, UIImage *image))success
+                       failure:(void (^)(NSURLRequest *request, NSHTTPURLResponse *response, NSError *error))failure
 {
     [self cancelImageRequestOperation];
 
-    UIImage *cachedImage = [[[self class] af_sharedImageCache] cachedImageForRequest:urlRequest];
+    UIImage *cachedImage = [[[self class] af_sharedImageCache] cachedImageForRequest:urlRequest pixelSize:targetPixelSize];
     if (cachedImage) {
         if (success) {
             success(nil, nil, cachedImage);
@@ -112,20 +121,25 @@ static char kAFImageRequestOperationObjectKey;
         self.image = placeholderImage;
 
         AFImageRequestOperation *requestOperation = [[AFImageRequestOperation alloc] initWithRequest:urlRequest];
+        requestOperation.targetPixelSize = targetPixelSize;
+        // Images are decoded and cached off the main queue, then set on the main queue
+        requestOperation.successCallbackQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
         [requestOperation setCompletionBlockWithSuccess:^(AFHTTPRequestOperation *operation, id responseObject) {
-            if ([urlRequest isEqual:[self.af_imageRequestOperation request]]) {
-                if (success) {
-                    success(operation.request, operation.response, responseObject);
-                } else if (responseObject) {
-                    self.image = responseObject;
-                }
-
-                if (self.af_imageRequestOperation == operation) {
-                    self.af_imageRequestOperation = nil;
+            UIImage *image = [[[self class] af_sharedImageCache] cacheImage:responseObject data:operation.responseData forRequest:urlRequest pixelSize:targetPixelSize];
+
+            dispatch_async(dispatch_get_main_queue(), ^{
+                if ([urlRequest isEqual:[self.af_imageRequestOperation request]]) {
+                    if (success) {
+                        success(operation.request, operation.response, image);
+                    } else if (image) {
+                        self.image = image;
+                    }
+
+                    if (self.af_imageRequestOperation == operation) {
+                        self.af_imageRequestOperation = nil;
+                    }
                 }
-            }
-
-            [[[self class] af_sharedImageCache] cacheImage:responseObject forRequest:urlRequest];
+            });
         } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
             if ([urlRequest isEqual:[self.af_imageRequestOperation request]]) {
                 if (failure) {
@@ -140,7 +154,24 @@ static char kAFImageRequestOperationObjectKey;
 
         self.af_imageRequestOperation = requestOperation;
 
-        [[[self class] af_sharedImageRequestOperationQueue] addOperation:self.af_imageRequestOperation];
+        // The request is only sent if the image is not on disk either
+        [[[self class] af_sharedImageCache] loadImageForRequest:urlRequest pixelSize:targetPixelSize completion:^(UIImage *image) {
+            if (self.af_imageRequestOperation != requestOperation) {
+                return;
+            }
+
+            if (image) {
+                if (success) {
+                    success(nil, nil, image);
+                } else {
+                    self.image = image;
+                }
+
+                self.af_imageRequestOperation = nil;
+            } else {
+                [[[self class] af_sharedImageRequestOperationQueue] addOperation:requestOperation];
+            }
+        }];
     }
 }
 
@@ -157,26 +188,325 @@ static inline NSString * AFImageCacheKeyFromURLRequest(NSURLRequest *request) {
     return [[request URL] absoluteString];
 }
 
-@implementation AFImageCache
+static inline NSString * AFImageCacheKeyFromURLRequestAndPixelSize(NSURLRequest *request, CGSize pixelSize) {
+    if (CGSizeEqualToSize(pixelSize, CGSizeZero)) {
+        return AFImageCacheKeyFromURLRequest(request);
+    }
 
-- (UIImage *)cachedImageForRequest:(NSURLRequest *)request {
+    return [NSString stringWithFormat:@"%@#%.0fx%.0f", AFImageCacheKeyFromURLRequest(request), pixelSize.width, pixelSize.height];
+}
+
+static inline BOOL AFImageCacheIsAllowedForRequest(NSURLRequest *request) {
     switch ([request cachePolicy]) {
         case NSURLRequestReloadIgnoringCacheData:
         case NSURLRequestReloadIgnoringLocalAndRemoteCacheData:
-            return nil;
+            return NO;
         default:
-            break;
+            return request != nil;
+    }
+}
+
+static NSString * AFImageCacheFileNameForKey(NSString *key) {
+    NSData *data = [key dataUsingEncoding:NSUTF8StringEncoding];
+    unsigned char digest[CC_SHA1_DIGEST_LENGTH];
+    CC_SHA1([data bytes], (CC_LONG)[data length], digest);
+
+    NSMutableString *fileName = [NSMutableString stringWithCapacity:CC_SHA1_DIGEST_LENGTH * 2];
+    for (NSUInteger i = 0; i < CC_SHA1_DIGEST_LENGTH; i++) {
+        [fileName appendFormat:@"%02x", digest[i]];
+    }
+
+    return fileName;
+}
+
+static UIImage * AFImageDecodedFromImage(UIImage *image) {
+    CGImageRef imageRef = [image CGImage];
+    if (!imageRef || [image images]) {
+        return image;
+    }
+
+    size_t width = CGImageGetWidth(imageRef);
+    size_t height = CGImageGetHeight(imageRef);
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(NULL, width, height, 8, 0, colorSpace, kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Little);
+    CGColorSpaceRelease(colorSpace);
+    if (!context) {
+        return image;
+    }
+
+    CGContextDrawImage(context, CGRectMake(0.0f, 0.0f, width, height), imageRef);
+    CGImageRef decodedImageRef = CGBitmapContextCreateImage(context);
+    CGContextRelease(context);
+
+    UIImage *decodedImage = [UIImage imageWithCGImage:decodedImageRef scale:[image scale] orientation:[image imageOrientation]];
+    CGImageRelease(decodedImageRef);
+
+    return decodedImage;
+}
+
+static inline NSUInteger AFImageCacheCostForImage(UIImage *image) {
+    CGImageRef imageRef = [image CGImage];
+    if (!imageRef) {
+        return 0;
+    }
+
+    return CGImageGetBytesPerRow(imageRef) * CGImageGetHeight(imageRef) * MAX([[image images] count], (NSUInteger)1);
+}
+
+@interface AFImageCache ()
+@property (readwrite, nonatomic, assign) NSUInteger memoryCapacity;
+@property (readwrite, nonatomic, assign) NSUInteger diskCapacity;
+@property (readwrite, nonatomic, assign) NSUInteger currentDiskUsage;
+@property (readwrite, nonatomic, strong) NSCache *memoryCache;
+@property (readwrite, nonatomic, copy) NSString *diskPath;
+- (NSString *)diskPathForKey:(NSString *)key;
+- (void)trimDiskToSize:(NSUInteger)size;
+- (void)applicationDidReceiveMemoryWarning:(NSNotification *)notification;
+- (void)applicationDidEnterBackground:(NSNotification *)notification;
+@end
+
+@implementation AFImageCache {
+    volatile int64_t _memoryHitCount;
+    volatile int64_t _diskHitCount;
+    volatile int64_t _missCount;
+    dispatch_queue_t _diskQueue;
+}
+@synthesize memoryCapacity = _memoryCapacity;
+@synthesize diskCapacity = _diskCapacity;
+@synthesize currentDiskUsage = _currentDiskUsage;
+@synthesize memoryCache = _memoryCache;
+@synthesize diskPath = _diskPath;
+
+- (id)initWithMemoryCapacity:(NSUInteger)memoryCapacity
+                diskCapacity:(NSUInteger)diskCapacity
+                    diskPath:(NSString *)path
+{
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.memoryCapacity = memoryCapacity;
+    self.diskCapacity = diskCapacity;
+    self.diskPath = path;
+
+    self.memoryCache = [[NSCache alloc] init];
+    self.memoryCache.totalCostLimit = memoryCapacity;
+
+    // Every file system access happens on this queue, which also guards currentDiskUsage
+    _diskQueue = dispatch_queue_create("com.alamofire.networking.image-cache.disk", DISPATCH_QUEUE_SERIAL);
+    dispatch_async(_diskQueue, ^{
+        NSFileManager *fileManager = [[NSFileManager alloc] init];
+        [fileManager createDirectoryAtPath:path withIntermediateDirectories:YES attributes:nil error:nil];
+
+        NSUInteger usage = 0;
+        for (NSURL *fileURL in [fileManager contentsOfDirectoryAtURL:[NSURL fileURLWithPath:path] includingPropertiesForKeys:@[NSURLFileSizeKey] options:NSDirectoryEnumerationSkipsHiddenFiles error:nil]) {
+            NSNumber *fileSize = nil;
+            [fileURL getResourceValue:&fileSize forKey:NSURLFileSizeKey error:nil];
+            usage += [fileSize unsignedIntegerValue];
+        }
+        self.currentDiskUsage = usage;
+    });
+
+    NSNotificationCenter *notificationCenter = [NSNotificationCenter defaultCenter];
+    [notificationCenter addObserver:self selector:@selector(applicationDidReceiveMemoryWarning:) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+    [notificationCenter addObserver:self selector:@selector(applicationDidEnterBackground:) name:UIApplicationDidEnterBackgroundNotification object:nil];
+
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+
+#if !OS_OBJECT_USE_OBJC
+    dispatch_release(_diskQueue);
+#endif
+}
+
+- (NSString *)diskPathForKey:(NSString *)key {
+    return [self.diskPath stringByAppendingPathComponent:AFImageCacheFileNameForKey(key)];
+}
+
+#pragma mark -
+
+- (UIImage *)cachedImageForRequest:(NSURLRequest *)request {
+    return [self cachedImageForRequest:request pixelSize:CGSizeZero];
+}
+
+- (UIImage *)cachedImageForRequest:(NSURLRequest *)request
+                         pixelSize:(CGSize)pixelSize
+{
+    if (!AFImageCacheIsAllowedForRequest(request)) {
+        return nil;
+    }
+
+    UIImage *image = [self.memoryCache objectForKey:AFImageCacheKeyFromURLRequestAndPixelSize(request, pixelSize)];
+    if (image) {
+        OSAtomicIncrement64(&_memoryHitCount);
     }
 
-	return [self objectForKey:AFImageCacheKeyFromURLRequest(request)];
+    return image;
+}
+
+- (void)loadImageForRequest:(NSURLRequest *)request
+                 completion:(void (^)(UIImage *image))completion
+{
+    [self loadImageForRequest:request pixelSize:CGSizeZero completion:completion];
 }
 
-- (void)cacheImage:(UIImage *)image
-        forRequest:(NSURLRequest *)request
+- (void)loadImageForRequest:(NSURLRequest *)request
+                  pixelSize:(CGSize)pixelSize
+                 completion:(void (^)(UIImage *image))completion
 {
-    if (image && request) {
-        [self setObject:image forKey:AFImageCacheKeyFromURLRequest(request)];
+    UIImage *cachedImage = [self cachedImageForRequest:request pixelSize:pixelSize];
+    if (cachedImage || !AFImageCacheIsAllowedForRequest(request)) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completion(cachedImage);
+        });
+        return;
     }
+
+    NSString *key = AFImageCacheKeyFromURLRequestAndPixelSize(request, pixelSize);
+    NSString *path = [self diskPathForKey:AFImageCacheKeyFromURLRequest(request)];
+    CGFloat scale = [[UIScreen mainScreen] scale];
+    dispatch_async(_diskQueue, ^{
+        NSData *data = [NSData dataWithContentsOfFile:path];
+        if (data) {
+            // Touching the file keeps it out of the next trim
+            [[NSFileManager defaultManager] setAttributes:@{NSFileModificationDate: [NSDate date]} ofItemAtPath:path error:nil];
+        }
+
+        // Decoding does not hold up the other disk accesses
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            UIImage *image = AFDecodedImageWithData(data, scale, pixelSize);
+            if (image) {
+                OSAtomicIncrement64(&_diskHitCount);
+                [self.memoryCache setObject:image forKey:key cost:AFImageCacheCostForImage(image)];
+            } else {
+                OSAtomicIncrement64(&_missCount);
+            }
+
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completion(image);
+            });
+        });
+    });
+}
+
+- (UIImage *)cacheImage:(UIImage *)image
+                   data:(NSData *)data
+             forRequest:(NSURLRequest *)request
+{
+    return [self cacheImage:image data:data forRequest:request pixelSize:CGSizeZero];
+}
+
+- (UIImage *)cacheImage:(UIImage *)image
+                   data:(NSData *)data
+             forRequest:(NSURLRequest *)request
+              pixelSize:(CGSize)pixelSize
+{
+    if (!image || !request) {
+        return image;
+    }
+
+    // Downsampled images are decoded as they are created
+    UIImage *decodedImage = CGSizeEqualToSize(pixelSize, CGSizeZero) ? AFImageDecodedFromImage(image) : image;
+    [self.memoryCache setObject:decodedImage forKey:AFImageCacheKeyFromURLRequestAndPixelSize(request, pixelSize) cost:AFImageCacheCostForImage(decodedImage)];
+
+    // Every size of an image is read from the same file
+    if ([data length] > 0 && [data length] <= self.diskCapacity) {
+        NSString *path = [self diskPathForKey:AFImageCacheKeyFromURLRequest(request)];
+        dispatch_async(_diskQueue, ^{
+            NSNumber *previousSize = [[[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil] objectForKey:NSFileSize];
+            if ([data writeToFile:path options:NSDataWritingAtomic error:nil]) {
+                self.currentDiskUsage = self.currentDiskUsage + [data length] - MIN([previousSize unsignedIntegerValue], self.currentDiskUsage + [data length]);
+                if (self.currentDiskUsage > self.diskCapacity) {
+                    [self trimDiskToSize:self.diskCapacity];
+                }
+            }
+        });
+    }
+
+    return decodedImage;
+}
+
+- (void)trimDiskToSize:(NSUInteger)size {
+    NSArray *keys = @[NSURLFileSizeKey, NSURLContentModificationDateKey];
+    NSArray *fileURLs = [[NSFileManager defaultManager] contentsOfDirectoryAtURL:[NSURL fileURLWithPath:self.diskPath] includingPropertiesForKeys:keys options:NSDirectoryEnumerationSkipsHiddenFiles error:nil];
+
+    // Least recently used first
+    NSArray *sortedFileURLs = [fileURLs sortedArrayUsingComparator:^NSComparisonResult(NSURL *url1, NSURL *url2) {
+        NSDate *date1 = nil;
+        NSDate *date2 = nil;
+        [url1 getResourceValue:&date1 forKey:NSURLContentModificationDateKey error:nil];
+        [url2 getResourceValue:&date2 forKey:NSURLContentModificationDateKey error:nil];
+        return [date1 compare:date2];
+    }];
+
+    for (NSURL *fileURL in sortedFileURLs) {
+        if (self.currentDiskUsage <= size) {
+            break;
+        }
+
+        NSNumber *fileSize = nil;
+        [fileURL getResourceValue:&fileSize forKey:NSURLFileSizeKey error:nil];
+        if ([[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil]) {
+            self.currentDiskUsage -= MIN([fileSize unsignedIntegerValue], self.currentDiskUsage);
+        }
+    }
+}
+
+- (void)removeAllMemoryCachedImages {
+    [self.memoryCache removeAllObjects];
+}
+
+- (void)removeAllCachedImages {
+    [self removeAllMemoryCachedImages];
+
+    dispatch_sync(_diskQueue, ^{
+        [self trimDiskToSize:0];
+    });
+}
+
+#pragma mark -
+
+- (NSUInteger)memoryHitCount {
+    return (NSUInteger)_memoryHitCount;
+}
+
+- (NSUInteger)diskHitCount {
+    return (NSUInteger)_diskHitCount;
+}
+
+- (NSUInteger)missCount {
+    return (NSUInteger)_missCount;
+}
+
+- (double)hitRatio {
+    double hits = (double)_memoryHitCount + (double)_diskHitCount;
+    double lookups = hits + (double)_missCount;
+
+    return lookups > 0 ? hits / lookups : 0.0;
+}
+
+- (void)resetStatistics {
+    _memoryHitCount = 0;
+    _diskHitCount = 0;
+    _missCount = 0;
+    OSMemoryBarrier();
+}
+
+#pragma mark - Notifications
+
+- (void)applicationDidReceiveMemoryWarning:(NSNotification *)notification {
+    // Decoded bitmaps are the largest allocations of the cache, and can all be read back from disk
+    [self removeAllMemoryCachedImages];
+}
+
+- (void)applicationDidEnterBackground:(NSNotification *)notification {
+    dispatch_async(_diskQueue, ^{
+        [self trimDiskToSize:self.diskCapacity];
+    });
 }
 
 @end
@@ -0,0 +1,84 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ SXCancellationToken lets the caller of an asynchronous operation give up on it, either explicitly or when a
+ deadline passes.
+
+ The parts of the SDK a request goes through (waiting for an access token, waiting for a retry, the request
+ vault and the HTTP operation) register a cancellation handler while they hold the request, and remove it when
+ they hand it over. Cancelling the token runs these handlers, which stop the work and release the request and
+ its handler right away.
+
+ Copies of an `SXRequest` share the token of the original request.
+ */
+@interface SXCancellationToken : NSObject
+
+/// YES once the token has been cancelled or its deadline has passed
+@property (readonly, getter = isCancelled) BOOL cancelled;
+
+/// The reason of the cancellation: nil when cancelled with `cancel`, an `SXErrorRequestTimedOut` error when the deadline passed
+@property (readonly) NSError *error;
+
+/**
+ The date after which the token is cancelled with an `SXErrorRequestTimedOut` error, or nil for no deadline.
+ Cancellation at the deadline happens on the main queue.
+ */
+@property (strong, nonatomic) NSDate *deadline;
+
+/**
+ Returns YES if the deadline is set and has passed.
+ */
+- (BOOL) isExpired;
+
+/**
+ Cancels the token with no error. Does nothing if the token is already cancelled.
+ */
+- (void) cancel;
+
+/**
+ Cancels the token with the given error. Does nothing if the token is already cancelled.
+ @param error The reason of the cancellation, passed to the cancellation handlers
+ @return YES if this call cancelled the token
+ */
+- (BOOL) cancelWithError:(NSError *)error;
+
+/**
+ Cancels the token with an `SXErrorRequestTimedOut` error if its deadline has passed.
+ @return YES if this call cancelled the token
+ */
+- (BOOL) cancelIfExpired;
+
+/**
+ Registers a handler to be called, on the thread cancelling the token, when the token is cancelled. If the token
+ is already cancelled the handler is called immediately. Handlers are released once called.
+ @param handler The handler, given the reason of the cancellation
+ @return A registration to pass to `removeCancellationHandler:`, or nil if the handler has already been called
+ */
+- (id) addCancellationHandler:(void(^)(NSError *error))handler;
+
+/**
+ Removes a handler registered with `addCancellationHandler:`.
+ @param registration The value returned by `addCancellationHandler:`, nil is ignored
+ */
+- (void) removeCancellationHandler:(id)registration;
+
+@end
@@ -0,0 +1,143 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXCancellationToken.h"
+#import "SXUtil.h"
+
+@interface SXCancellationToken ()
+
+@property (assign) BOOL cancelled;
+
+@property (strong) NSError *error;
+
+/// registration => handler, until the token is cancelled
+@property (strong, nonatomic) NSMutableDictionary *handlers;
+
+@property (assign, nonatomic) NSUInteger lastRegistration;
+
+@end
+
+@implementation SXCancellationToken
+
+- (id) init
+{
+    if (self = [super init]) {
+        self.handlers = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+#pragma mark - Deadline
+
+- (void) setDeadline:(NSDate *)deadline
+{
+    @synchronized(self) {
+        _deadline = deadline;
+    }
+
+    if (!deadline)
+        return;
+
+    __weak SXCancellationToken *weakSelf = self;
+    double delayInSeconds = MAX(0, [deadline timeIntervalSinceNow]);
+    dispatch_time_t popTime = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delayInSeconds * NSEC_PER_SEC));
+    dispatch_after(popTime, dispatch_get_main_queue(), ^(void){
+        // The deadline may have been moved since
+        [weakSelf cancelIfExpired];
+    });
+}
+
+- (NSDate *) deadline
+{
+    @synchronized(self) {
+        return _deadline;
+    }
+}
+
+- (BOOL) isExpired
+{
+    NSDate *deadline = self.deadline;
+    return deadline && [deadline timeIntervalSinceNow] <= 0;
+}
+
+#pragma mark - Cancellation
+
+- (void) cancel
+{
+    [self cancelWithError:nil];
+}
+
+- (BOOL) cancelIfExpired
+{
+    if (![self isExpired])
+        return NO;
+
+    return [self cancelWithError:[SXUtil errorWithScoreflexCode:SXErrorRequestTimedOut]];
+}
+
+- (BOOL) cancelWithError:(NSError *)error
+{
+    NSArray *handlers = nil;
+    @synchronized(self) {
+        if (self.cancelled)
+            return NO;
+        self.cancelled = YES;
+        self.error = error;
+
+        // Handlers run in registration order, outside of the lock so they can use the token
+        NSArray *registrations = [self.handlers.allKeys sortedArrayUsingSelector:@selector(compare:)];
+        handlers = [self.handlers objectsForKeys:registrations notFoundMarker:[NSNull null]];
+        [self.handlers removeAllObjects];
+    }
+
+    SXLog(@"Cancelled token, error: %@", error);
+
+    for (void(^handler)(NSError *) in handlers)
+        handler(error);
+    return YES;
+}
+
+- (id) addCancellationHandler:(void(^)(NSError *error))handler
+{
+    if (!handler)
+        return nil;
+
+    @synchronized(self) {
+        if (!self.cancelled) {
+            NSNumber *registration = [NSNumber numberWithUnsignedInteger:++self.lastRegistration];
+            [self.handlers setObject:[handler copy] forKey:registration];
+            return registration;
+        }
+    }
+
+    handler(self.error);
+    return nil;
+}
+
+- (void) removeCancellationHandler:(id)registration
+{
+    if (!registration)
+        return;
+
+    @synchronized(self) {
+        [self.handlers removeObjectForKey:registration];
+    }
+}
+
+@end
@@ -21,6 +21,8 @@
 #import "AFHTTPClient.h"
 #import "SXRequest.h"
 
+@class SXPromise;
+
 /**
  SXClient is an implementation of AFHTTPClient that handles authentication to the API.
  */
@@ -57,12 +59,23 @@
 
 - (void) fetchAnonymousAccessTokenAndRunRequest:(SXRequest *)request;
 
+/**
+ Returns a promise fulfilled with the session id once there is a session, fetching an anonymous access token if
+ needed. Callers waiting for the same session share one promise and one token fetch. A rejected promise is replaced
+ by the next call, which fetches the token again.
+ */
+- (SXPromise *) sessionReady;
+
 ///----------------------
 /// @name REST API access
 ///----------------------
 
 /**
  Performs the given request. If no accessToken can be found, requests an anonymous access token before running the given request.
+
+ Cancelling the request, or reaching its deadline, stops it wherever it is: waiting for the access token, waiting
+ for a retry or on the network. The handler is then released, after being given an `SXErrorRequestTimedOut`
+ error if the deadline passed.
  @param request The request to be run
  @exception InvalidHTTPVerb   Raised when using a verb other than GET, POST or DELETE.
  */
@@ -81,6 +94,24 @@
  */
 - (void) requestEventually:(SXRequest *)request;
 
+///---------------------
+/// @name Callback queues
+///---------------------
+
+/**
+ The queue request handlers are called on, unless the request has its own `callbackQueue`. If `NULL` (default),
+ the main queue is used. Responses are always processed on a background queue before the handler is dispatched.
+ */
+@property (nonatomic, assign) dispatch_queue_t callbackQueue;
+
+/**
+ Calls the handler of the given request, if any, on its callback queue.
+ @param request The request
+ @param response The response, or nil
+ @param error The error, or nil
+ */
+- (void) callHandlerOfRequest:(SXRequest *)request response:(SXResponse *)response error:(NSError *)error;
+
 ///------------------
 /// @name HTTP client
 ///------------------
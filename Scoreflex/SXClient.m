@@ -24,6 +24,7 @@
 #import "SXClient.h"
 #import "SXConfiguration.h"
 #import "SXRequestVault.h"
+#import "SXNetworkPolicy.h"
 #import "Scoreflex.h"
 #import "Scoreflex_private.h"
 
@@ -31,6 +32,16 @@
 
 static NSMutableArray *tokenFetchedHandlers;
 
+static dispatch_queue_t sx_response_processing_queue() {
+    static dispatch_queue_t sx_response_processing_queue;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sx_response_processing_queue = dispatch_queue_create("com.scoreflex.client.response-processing", DISPATCH_QUEUE_CONCURRENT);
+    });
+
+    return sx_response_processing_queue;
+}
+
 ///** privatise */
 //
 
@@ -38,6 +49,20 @@ static NSMutableArray *tokenFetchedHandlers;
 
 @interface SXJSONRequestOperation : AFJSONRequestOperation
 + (NSString *) scoreflexAuthorizationHeaderValueForRequest:(NSURLRequest *)request;
+
+/**
+ Returns the authorization header value for a request whose parameters are given in the canonical form
+ produced by `AFAppendQueryStringFromParameters`.
+ */
++ (NSString *) scoreflexAuthorizationHeaderValueForMethod:(NSString *)method URL:(NSURL *)URL canonicalParameters:(const void *)canonicalParameters length:(NSUInteger)length;
+
++ (NSString *) scoreflexAuthorizationHeaderValueForSignatureBase:(const char *)signatureBase length:(NSUInteger)length;
+
+/// The timeline of the SXRequest run by this operation, if metrics are enabled
+@property (strong, nonatomic) SXRequestTimeline *timeline;
+
+/// When the operation started, for the network policy measurements
+@property (assign, nonatomic) NSTimeInterval startedAt;
 @end
 
 @implementation SXJSONRequestOperation
@@ -86,11 +111,34 @@ static NSMutableArray *tokenFetchedHandlers;
     // than application/x-www-form-urlencoded
     [buffer appendString:@"&"];
 
+    const char *cData = [buffer cStringUsingEncoding:NSASCIIStringEncoding];
+    return [self scoreflexAuthorizationHeaderValueForSignatureBase:cData length:strlen(cData)];
+}
+
++ (NSString *) scoreflexAuthorizationHeaderValueForMethod:(NSString *)method URL:(NSURL *)URL canonicalParameters:(const void *)canonicalParameters length:(NSUInteger)length
+{
+    method = method.uppercaseString;
+
+    // GET requests do not need signing
+    if ([@"GET" isEqualToString:method])
+        return nil;
+
+    // Same steps as scoreflexAuthorizationHeaderValueForRequest:, with params already sorted and encoded
+    NSString *prefix = [NSString stringWithFormat:@"%@&%@&", method, [SXUtil percentEncodedString:[NSString stringWithFormat:@"%@://%@%@", URL.scheme, URL.host, URL.path]]];
+    NSMutableData *signatureBase = [NSMutableData dataWithCapacity:prefix.length + length + 1];
+    [signatureBase appendData:[prefix dataUsingEncoding:NSASCIIStringEncoding]];
+    [signatureBase appendBytes:canonicalParameters length:length];
+    [signatureBase appendBytes:"&" length:1];
+
+    return [self scoreflexAuthorizationHeaderValueForSignatureBase:signatureBase.bytes length:signatureBase.length];
+}
+
++ (NSString *) scoreflexAuthorizationHeaderValueForSignatureBase:(const char *)signatureBase length:(NSUInteger)length
+{
     // Sign the buffer with the client secret using HMacSha1
     const char *cKey  = [[SXConfiguration sharedConfiguration].clientSecret cStringUsingEncoding:NSASCIIStringEncoding];
-    const char *cData = [buffer cStringUsingEncoding:NSASCIIStringEncoding];
     unsigned char cHMAC[CC_SHA1_DIGEST_LENGTH];
-    CCHmac(kCCHmacAlgSHA1, cKey, strlen(cKey), cData, strlen(cData), cHMAC);
+    CCHmac(kCCHmacAlgSHA1, cKey, strlen(cKey), signatureBase, length, cHMAC);
     NSData *HMAC = [[NSData alloc] initWithBytes:cHMAC length:sizeof(cHMAC)];
     NSString *hash = [SXUtil base64forData:HMAC];
 
@@ -105,15 +153,48 @@ static NSMutableArray *tokenFetchedHandlers;
         [NSException raise:@"Immutable NSURLRequest." format:NSLocalizedString(@"Url requests from AFNetworking should be mutable, please check that the AFNetworking version you are using is compatible with Scoreflex.", nil)];
     NSMutableURLRequest *mutableRequest = (NSMutableURLRequest *)urlRequest;
 
-    // Add the authorization header
-    NSString *authorizationHeader = [[self class] scoreflexAuthorizationHeaderValueForRequest:mutableRequest];
-    if (authorizationHeader)
-        [mutableRequest addValue:authorizationHeader forHTTPHeaderField:@"X-Scoreflex-Authorization"];
+    // Add the authorization header, unless SXHTTPClient signed the request when building it
+    if (![mutableRequest valueForHTTPHeaderField:@"X-Scoreflex-Authorization"]) {
+        NSString *authorizationHeader = [[self class] scoreflexAuthorizationHeaderValueForRequest:mutableRequest];
+        if (authorizationHeader)
+            [mutableRequest addValue:authorizationHeader forHTTPHeaderField:@"X-Scoreflex-Authorization"];
+    }
 
     return [super initWithRequest:mutableRequest];
 
 }
 
+#pragma mark Metrics
+
+- (void) start
+{
+    self.startedAt = SXMetricsTimestamp();
+    [self.timeline endPhase:SXMetricsPhaseQueueWait];
+    [self.timeline beginPhase:SXMetricsPhaseNetwork];
+    [super start];
+}
+
+- (void) connectionDidFinishLoading:(NSURLConnection *)connection
+{
+    [self.timeline endPhase:SXMetricsPhaseNetwork];
+    [[SXNetworkPolicy sharedPolicy] recordTransferOfLength:self.responseData.length duration:SXMetricsTimestamp() - self.startedAt];
+    [super connectionDidFinishLoading:connection];
+}
+
+- (void) connection:(NSURLConnection *)connection didFailWithError:(NSError *)error
+{
+    [self.timeline endPhase:SXMetricsPhaseNetwork];
+    [super connection:connection didFailWithError:error];
+}
+
+- (id) responseJSON
+{
+    [self.timeline beginPhase:SXMetricsPhaseParse];
+    id responseJSON = [super responseJSON];
+    [self.timeline endPhase:SXMetricsPhaseParse];
+    return responseJSON;
+}
+
 @end
 
 
@@ -130,6 +211,64 @@ static NSMutableArray *tokenFetchedHandlers;
 
 @end
 
+#pragma mark - SXRequestAttempt
+
+/**
+ Holds a request while it waits for an access token, a retry or the network, and gives it back once: either to
+ the code completing the attempt, or to the cancellation handler of the request. Blocks parked in the meantime
+ capture the attempt rather than the request, so a cancelled request and its handler are released at once.
+ */
+@interface SXRequestAttempt : NSObject
+
+- (id) initWithRequest:(SXRequest *)request;
+
+/// Returns the request and forgets it, or nil if the attempt has already been completed or cancelled
+- (SXRequest *) take;
+
+/// The HTTP operation of the attempt, cancelled along with it
+@property (strong, nonatomic) AFHTTPRequestOperation *operation;
+
+/// The registration of the cancellation handler on the token of the request
+@property (strong, nonatomic) id registration;
+
+@property (strong, nonatomic) SXRequest *request;
+
+@end
+
+@implementation SXRequestAttempt
+
+- (id) initWithRequest:(SXRequest *)request
+{
+    if (self = [super init]) {
+        self.request = request;
+    }
+    return self;
+}
+
+- (SXRequest *) take
+{
+    @synchronized(self) {
+        SXRequest *request = self.request;
+        self.request = nil;
+        self.operation = nil;
+        return request;
+    }
+}
+
+- (void) setOperation:(AFHTTPRequestOperation *)operation
+{
+    @synchronized(self) {
+        // Cancelled before the operation could be attached
+        if (operation && !self.request) {
+            [operation cancel];
+            return;
+        }
+        _operation = operation;
+    }
+}
+
+@end
+
 #pragma mark - SXHttpClient
 
 @interface SXHTTPClient : AFHTTPClient
@@ -152,6 +291,35 @@ static NSMutableArray *tokenFetchedHandlers;
 
     return self;
 }
+
+- (NSMutableURLRequest *)requestWithMethod:(NSString *)method path:(NSString *)path parameters:(NSDictionary *)parameters
+{
+    // Paths with a query and unsigned requests are signed from the URL request by SXJSONRequestOperation
+    if (!parameters || [@"GET" isEqualToString:method] || self.parameterEncoding != AFFormURLParameterEncoding || [path rangeOfString:@"?"].location != NSNotFound)
+        return [super requestWithMethod:method path:path parameters:parameters];
+
+    NSMutableURLRequest *request = [super requestWithMethod:method path:path parameters:nil];
+
+    // Encode the params once, for both the request and its signature
+    NSMutableData *buffer = [NSMutableData dataWithCapacity:512];
+    NSRange canonicalRange;
+    NSRange queryRange = AFAppendQueryStringFromParameters(buffer, parameters, self.stringEncoding, &canonicalRange);
+
+    if ([@"HEAD" isEqualToString:method] || [@"DELETE" isEqualToString:method]) {
+        NSString *query = [[NSString alloc] initWithBytes:(const char *)buffer.bytes + queryRange.location length:queryRange.length encoding:NSASCIIStringEncoding];
+        request.URL = [NSURL URLWithString:[request.URL.absoluteString stringByAppendingFormat:@"?%@", query]];
+    } else {
+        NSString *charset = (__bridge NSString *)CFStringConvertEncodingToIANACharSetName(CFStringConvertNSStringEncodingToEncoding(self.stringEncoding));
+        [request setValue:[NSString stringWithFormat:@"application/x-www-form-urlencoded; charset=%@", charset] forHTTPHeaderField:@"Content-Type"];
+        [request setHTTPBody:[buffer subdataWithRange:queryRange]];
+    }
+
+    NSString *authorizationHeader = [SXJSONRequestOperation scoreflexAuthorizationHeaderValueForMethod:method URL:request.URL canonicalParameters:(const char *)buffer.bytes + canonicalRange.location length:canonicalRange.length];
+    if (authorizationHeader)
+        [request setValue:authorizationHeader forHTTPHeaderField:@"X-Scoreflex-Authorization"];
+
+    return request;
+}
 @end
 
 #pragma mark - SXClient
@@ -170,8 +338,32 @@ static NSMutableArray *tokenFetchedHandlers;
 /// The request vault
 @property (strong, nonatomic) SXRequestVault *requestVault;
 
+/// The session promise shared by the callers of sessionReady while there is no session
+@property (strong, nonatomic) SXPromise *sessionPromise;
+
 - (void) checkMethod:(SXRequest *)request;
 
+- (void) postAnonymousAccessTokenRequestWithDeviceId:(NSString *)deviceId handler:(void (^)(AFHTTPRequestOperation *operation, id responseObject))handler failure:(void (^)(AFHTTPRequestOperation *operation, NSError *error))failure nbRetry:(NSInteger) nbRetry;
+
+/**
+ Starts an attempt at running the given request, cancelled along with the request.
+ When cancelled with an error, for instance when the deadline passes, the handler of the request is called with it.
+ */
+- (SXRequestAttempt *) attemptForRequest:(SXRequest *)request;
+
+/**
+ Ends the given attempt.
+ @return The request of the attempt, or nil if it has been cancelled
+ */
+- (SXRequest *) completeAttempt:(SXRequestAttempt *)attempt;
+
+/**
+ Calls the handler of the request on its callback queue, timing it in the given timeline which is then recorded.
+ */
+- (void) callHandlerOfRequest:(SXRequest *)request response:(SXResponse *)response error:(NSError *)error timeline:(SXRequestTimeline *)timeline;
+
+- (void) networkPolicyChanged:(NSNotification *)notification;
+
 @end
 
 @implementation SXClient
@@ -192,7 +384,9 @@ static NSMutableArray *tokenFetchedHandlers;
 - (id)initWithBaseURL:(NSURL *)url
 {
     if (self = [super init]) {
+        [AFURLConnectionOperation setNetworkRequestThreadCount:NETWORK_THREAD_COUNT];
         self.jsonHttpClient = [[SXHTTPClient alloc] initWithBaseURL:url];
+        self.jsonHttpClient.maxConcurrentOperationCountPerHost = MAX_CONCURRENT_REQUESTS_PER_HOST;
         [self.jsonHttpClient setReachabilityStatusChangeBlock:^(AFNetworkReachabilityStatus status) {
             if (status == AFNetworkReachabilityStatusNotReachable) {
                 [Scoreflex setIsReachable:YES];
@@ -203,10 +397,70 @@ static NSMutableArray *tokenFetchedHandlers;
         }];
         self.isFetchingAccessToken = false;
         tokenFetchedHandlers = [[NSMutableArray alloc] init];
+
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(networkPolicyChanged:) name:SX_NOTIFICATION_NETWORK_POLICY_CHANGED object:nil];
     }
     return self;
 }
 
+- (void) dealloc
+{
+    if (_callbackQueue) {
+#if !OS_OBJECT_USE_OBJC
+        dispatch_release(_callbackQueue);
+#endif
+        _callbackQueue = NULL;
+    }
+}
+
+- (void) networkPolicyChanged:(NSNotification *)notification
+{
+    self.jsonHttpClient.maxConcurrentOperationCountPerHost = [SXNetworkPolicy sharedPolicy].maxConcurrentRequests;
+}
+
+#pragma mark Callback queues
+
+- (void) setCallbackQueue:(dispatch_queue_t)callbackQueue
+{
+    if (callbackQueue != _callbackQueue) {
+        if (_callbackQueue) {
+#if !OS_OBJECT_USE_OBJC
+            dispatch_release(_callbackQueue);
+#endif
+            _callbackQueue = NULL;
+        }
+
+        if (callbackQueue) {
+#if !OS_OBJECT_USE_OBJC
+            dispatch_retain(callbackQueue);
+#endif
+            _callbackQueue = callbackQueue;
+        }
+    }
+}
+
+- (void) callHandlerOfRequest:(SXRequest *)request response:(SXResponse *)response error:(NSError *)error
+{
+    [self callHandlerOfRequest:request response:response error:error timeline:nil];
+}
+
+- (void) callHandlerOfRequest:(SXRequest *)request response:(SXResponse *)response error:(NSError *)error timeline:(SXRequestTimeline *)timeline
+{
+    SXRequestHandler handler = request.handler;
+    if (!handler) {
+        [[SXMetrics sharedMetrics] recordTimeline:timeline];
+        return;
+    }
+
+    dispatch_queue_t queue = request.callbackQueue ? request.callbackQueue : (self.callbackQueue ? self.callbackQueue : dispatch_get_main_queue());
+    dispatch_async(queue, ^{
+        [timeline beginPhase:SXMetricsPhaseHandler];
+        handler(response, error);
+        [timeline endPhase:SXMetricsPhaseHandler];
+        [[SXMetrics sharedMetrics] recordTimeline:timeline];
+    });
+}
+
 #pragma mark HTTP Access
 - (AFHTTPClient *)httpClient
 {
@@ -219,6 +473,27 @@ static NSMutableArray *tokenFetchedHandlers;
     return YES;
 }
 
+- (SXPromise *) sessionReady
+{
+    NSString *sid = [SXConfiguration sharedConfiguration].sid;
+    if (sid)
+        return [SXPromise promiseWithValue:sid];
+
+    @synchronized(self) {
+        if (self.sessionPromise.isPending)
+            return self.sessionPromise;
+
+        SXPromise *promise = [[SXPromise alloc] init];
+        self.sessionPromise = promise;
+        [self fetchAnonymousAccessTokenAndCall:^(AFHTTPRequestOperation *operation, id responseObject) {
+            [promise fulfill:[SXConfiguration sharedConfiguration].sid];
+        } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
+            [promise reject:error];
+        } nbRetry:0];
+        return promise;
+    }
+}
+
 - (BOOL)fetchAnonymousAccessTokenIfNeededAndCall:(void (^)(AFHTTPRequestOperation *operation, id responseObject))success failure:(void (^)(AFHTTPRequestOperation *operation, NSError *error))failure
 {
     if (![SXConfiguration sharedConfiguration].accessToken) {
@@ -239,12 +514,20 @@ static NSMutableArray *tokenFetchedHandlers;
         return;
     }
     self.isFetchingAccessToken = YES;
+
+    // The device identifier is computed in the background on the first launch, wait for it without blocking
+    [[SXUtil deviceIdentifierPromise] done:^(id deviceId, NSError *error) {
+        [self postAnonymousAccessTokenRequestWithDeviceId:deviceId handler:handler failure:failure nbRetry:nbRetry];
+    }];
+}
+
+- (void) postAnonymousAccessTokenRequestWithDeviceId:(NSString *)deviceId handler:(void (^)(AFHTTPRequestOperation *operation, id responseObject))handler failure:(void (^)(AFHTTPRequestOperation *operation, NSError *error))failure nbRetry:(NSInteger) nbRetry {
     SXConfiguration *configuration = [SXConfiguration sharedConfiguration];
 
     NSDictionary *params = @{@"clientId" :          configuration.clientId,
                              @"devicePlatform" :    @"iOS",
                              @"deviceModel" :       [SXUtil deviceModel],
-                             @"deviceId" :          [SXUtil deviceIdentifier]};
+                             @"deviceId" :          deviceId};
 
     NSString *resource = @"oauth/anonymousAccessToken";
 
@@ -284,6 +567,22 @@ static NSMutableArray *tokenFetchedHandlers;
                 }
                 [tokenFetchedHandlers removeAllObjects];
             }
+        } else {
+            // Fail the waiting callers rather than leaving them parked until the next fetch
+            self.isFetchingAccessToken = NO;
+            NSError *error = [SXUtil errorFromJSON:responseJson];
+            if (nil == error)
+                error = [SXUtil errorWithScoreflexCode:SXErrorServiceException];
+            if (nil != failure) {
+                failure(operation, error);
+            }
+            @synchronized(tokenFetchedHandlers) {
+                for (HandlerPair *pair in tokenFetchedHandlers) {
+                    if (nil != pair.error)
+                        pair.error(operation, error);
+                }
+                [tokenFetchedHandlers removeAllObjects];
+            }
         }
 
     } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
@@ -318,26 +617,55 @@ static NSMutableArray *tokenFetchedHandlers;
 
 - (void) fetchAnonymousAccessTokenAndRunRequest:(SXRequest *)request
 {
+    // Parked handlers only keep the attempt, which lets go of the request if it is cancelled
+    SXRequestAttempt *attempt = [self attemptForRequest:request];
 
     [self fetchAnonymousAccessTokenAndCall:^(AFHTTPRequestOperation *operation, id response) {
-         [self requestAuthenticated:request];
+        [self requestAuthenticated:[self completeAttempt:attempt]];
     } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
-        if (request.handler) {
-             request.handler(nil, error);
-        }
+        [self callHandlerOfRequest:[self completeAttempt:attempt] response:nil error:error];
     } nbRetry:0];
 }
 
+#pragma mark - Cancellation
+
+- (SXRequestAttempt *) attemptForRequest:(SXRequest *)request
+{
+    SXRequestAttempt *attempt = [[SXRequestAttempt alloc] initWithRequest:request];
+    attempt.registration = [request.cancellationToken addCancellationHandler:^(NSError *error) {
+        AFHTTPRequestOperation *operation = attempt.operation;
+        SXRequest *cancelledRequest = [attempt take];
+        [operation cancel];
+
+        // Only a deadline reports to the handler, an explicit cancel just drops it
+        if (error)
+            [self callHandlerOfRequest:cancelledRequest response:nil error:error];
+    }];
+    return attempt;
+}
+
+- (SXRequest *) completeAttempt:(SXRequestAttempt *)attempt
+{
+    SXRequest *request = [attempt take];
+    [request.cancellationToken removeCancellationHandler:attempt.registration];
+    return request;
+}
+
 #pragma mark - REST API Access
 
 - (void)requestAuthenticated:(SXRequest *)request
 {
-    // Do not fetch nil requests
-    if (!request)
+    // Do not fetch nil nor cancelled requests
+    if (!request || request.cancellationToken.isCancelled)
         return;
 
+    if ([SXMetrics isEnabled] && !request.timeline)
+        request.timeline = [[SXRequestTimeline alloc] initWithRequest:request];
+    SXRequestTimeline *timeline = request.timeline;
+
     // Fetch access token if needed then run request
     if (![SXConfiguration sharedConfiguration].accessToken) {
+        [timeline beginPhase:SXMetricsPhaseTokenWait];
         [self fetchAnonymousAccessTokenAndRunRequest:request];
         return;
     }
@@ -345,7 +673,13 @@ static NSMutableArray *tokenFetchedHandlers;
         SXLog(@"accessToken: %@", [SXConfiguration sharedConfiguration].accessToken);
     }
 
-    // We have an access token
+    // We have an access token, the blocks below keep the attempt rather than the request
+    SXRequestAttempt *attempt = [self attemptForRequest:request];
+    if ([request.cancellationToken cancelIfExpired])
+        return;
+
+    [timeline endPhase:SXMetricsPhaseTokenWait];
+    [timeline beginPhase:SXMetricsPhaseDecoration];
 
     NSMutableDictionary *params = [[NSMutableDictionary alloc] initWithDictionary:request.params];
     [params setObject:[SXConfiguration sharedConfiguration].accessToken forKey:@"accessToken"];
@@ -353,20 +687,21 @@ static NSMutableArray *tokenFetchedHandlers;
     // The success handler
 
     void(^success)(AFHTTPRequestOperation *, id) = ^(AFHTTPRequestOperation *operation, id response) {
+        SXRequest *request = [self completeAttempt:attempt];
+        if (!request)
+            return;
+
         if ([operation isKindOfClass:[SXJSONRequestOperation class]]) {
             SXJSONRequestOperation *jsonOperation = (SXJSONRequestOperation *)operation;
 
+            // Running on the processing queue, only the handler goes to the callback queue
             NSError *jsonError = [SXUtil errorFromJSON:jsonOperation.responseJSON];
             if (jsonError) {
-                if (request.handler)
-                    request.handler(nil, jsonError);
-
+                [self callHandlerOfRequest:request response:nil error:jsonError timeline:timeline];
             } else {
                 SXResponse *response = [[SXResponse alloc] init];
                 response.object = jsonOperation.responseJSON;
-
-                if (request.handler)
-                    request.handler(response, nil);
+                [self callHandlerOfRequest:request response:response error:nil timeline:timeline];
             }
         }
     };
@@ -374,6 +709,10 @@ static NSMutableArray *tokenFetchedHandlers;
     // The failure handler
 
     void(^failure)(AFHTTPRequestOperation *, NSError *) = ^(AFHTTPRequestOperation *operation, NSError *error) {
+        SXRequest *request = [self completeAttempt:attempt];
+        if (!request)
+            return;
+
         id json = ((SXJSONRequestOperation *) operation).responseJSON;
         NSError *jsonError = [SXUtil errorFromJSON:json];
         if (jsonError) {
@@ -389,20 +728,23 @@ static NSMutableArray *tokenFetchedHandlers;
                 configuration.sid = nil;
                 [configuration setAccessToken:nil anonymous:YES];
                 configuration.playerId = nil;
-                // Retry in 60 secs
+                // Retry in 60 secs, unless the request is cancelled in the meantime
 
+                SXRequestAttempt *retry = [self attemptForRequest:request];
                 double delayInSeconds = RETRY_INTERVAL;
                 dispatch_time_t popTime = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delayInSeconds * NSEC_PER_SEC));
                 dispatch_after(popTime, dispatch_get_main_queue(), ^(void){
+                    SXRequest *request = [self completeAttempt:retry];
+
+                    // The retry gets its own timeline
+                    request.timeline = nil;
                     [self requestAuthenticated:request];
                 });
-
-            } else if (request.handler)
-                request.handler(nil, jsonError);
-
-        } else if (request.handler) {
-            request.handler(nil, error);
+                return;
+            }
         }
+
+        [self callHandlerOfRequest:request response:nil error:jsonError ? jsonError : error timeline:timeline];
     };
 
     // Run the request
@@ -414,15 +756,23 @@ static NSMutableArray *tokenFetchedHandlers;
 
     SXLog(@"Performing request: %@", request);
 
-    if ([@"POST" isEqualToString:method]) {
-        [self.jsonHttpClient postPath:request.resource parameters:params success:success failure:failure];
-    } else if ([@"GET" isEqualToString:method]) {
-        [self.jsonHttpClient getPath:request.resource parameters:params success:success failure:failure];
-    } else if ([@"DELETE" isEqualToString:method]) {
-        [self.jsonHttpClient deletePath:request.resource parameters:params success:success failure:failure];
-    } else if ([@"PUT" isEqualToString:method]) {
-        [self.jsonHttpClient putPath:request.resource parameters:params success:success failure:failure];
-    }
+    // Same as AFHTTPClient's getPath:, postPath:... but with each step timed
+    NSMutableURLRequest *urlRequest = [self.jsonHttpClient requestWithMethod:method path:request.resource parameters:params];
+    if (request.deadline)
+        urlRequest.timeoutInterval = MIN(urlRequest.timeoutInterval, MAX(1.0, [request.deadline timeIntervalSinceNow]));
+    [timeline endPhase:SXMetricsPhaseDecoration];
+
+    [timeline beginPhase:SXMetricsPhaseSigning];
+    AFHTTPRequestOperation *operation = [self.jsonHttpClient HTTPRequestOperationWithRequest:urlRequest success:success failure:failure];
+    [timeline endPhase:SXMetricsPhaseSigning];
+
+    if ([operation isKindOfClass:[SXJSONRequestOperation class]])
+        ((SXJSONRequestOperation *)operation).timeline = timeline;
+    operation.successCallbackQueue = sx_response_processing_queue();
+    operation.failureCallbackQueue = sx_response_processing_queue();
+    attempt.operation = operation;
+    [timeline beginPhase:SXMetricsPhaseQueueWait];
+    [self.jsonHttpClient enqueueHTTPRequestOperation:operation];
 }
 
 - (void) checkMethod:(SXRequest *)request
@@ -0,0 +1,275 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class SXRequest;
+@class SXMetrics;
+
+/**
+ @enum SXMetricsPhase the phases of a request to the Scoreflex API
+ */
+typedef enum {
+    SXMetricsPhaseTokenWait,
+    SXMetricsPhaseDecoration,
+    SXMetricsPhaseSigning,
+    SXMetricsPhaseQueueWait,
+    SXMetricsPhaseNetwork,
+    SXMetricsPhaseParse,
+    SXMetricsPhaseHandler,
+    SXMetricsPhaseCount,
+} SXMetricsPhase;
+
+/**
+ @enum SXViewLoadPhase the phases of the load of a resource in an `SXView`
+ */
+typedef enum {
+    SXViewLoadPhaseTokenWait,
+    SXViewLoadPhaseRequest,
+    SXViewLoadPhaseFirstByte,
+    SXViewLoadPhaseRender,
+    SXViewLoadPhaseCount,
+} SXViewLoadPhase;
+
+/**
+ A monotonic timestamp in seconds, for measuring durations.
+ */
+extern NSTimeInterval SXMetricsTimestamp(void);
+
+/**
+ SXRequestTimeline holds the timestamps of the phases of a single `SXRequest`.
+ */
+@interface SXRequestTimeline : NSObject
+
+- (id) initWithRequest:(SXRequest *)request;
+
+@property (readonly, nonatomic) NSString *resource;
+@property (readonly, nonatomic) NSString *method;
+@property (readonly, nonatomic) NSString *requestId;
+
+/**
+ Records the start of a phase. Only the first call for a given phase is taken into account.
+ */
+- (void) beginPhase:(SXMetricsPhase)phase;
+
+/**
+ Records the end of a phase. Ignored if the phase has not begun or has already ended.
+ */
+- (void) endPhase:(SXMetricsPhase)phase;
+
+/**
+ Returns the duration of the given phase in seconds, or a negative value if it was not measured.
+ */
+- (NSTimeInterval) durationForPhase:(SXMetricsPhase)phase;
+
+/**
+ The time elapsed between the start of the first phase and the end of the last one, in seconds.
+ */
+@property (readonly, nonatomic) NSTimeInterval totalDuration;
+
+@end
+
+/**
+ SXViewLoadTimeline holds the timestamps of the load of a resource in an `SXView`, from `openResource:` to the end of
+ the page load: waiting for an access token, building the request, receiving the first byte of the page and
+ rendering it.
+ */
+@interface SXViewLoadTimeline : NSObject
+
+- (id) initWithResource:(NSString *)resource;
+
+@property (readonly, nonatomic) NSString *resource;
+
+/// YES if the resource was loaded ahead of time, before being shown
+@property (assign, nonatomic, getter = isPreloaded) BOOL preloaded;
+
+/// YES if the page was served by the web cache
+@property (assign, nonatomic, getter = isCacheHit) BOOL cacheHit;
+
+/**
+ Records the start of a phase. Only the first call for a given phase is taken into account.
+ */
+- (void) beginPhase:(SXViewLoadPhase)phase;
+
+/**
+ Records the end of a phase. Ignored if the phase has not begun or has already ended.
+ */
+- (void) endPhase:(SXViewLoadPhase)phase;
+
+/**
+ Ends the first byte phase and starts the render phase. Called by the web cache when the page response arrives.
+ @param cacheHit YES if the page is served by the web cache
+ */
+- (void) receivedFirstByteFromCache:(BOOL)cacheHit;
+
+/**
+ Returns the duration of the given phase in seconds, or a negative value if it was not measured.
+ */
+- (NSTimeInterval) durationForPhase:(SXViewLoadPhase)phase;
+
+/**
+ The time elapsed between the start of the first phase and the end of the last one, in seconds.
+ */
+@property (readonly, nonatomic) NSTimeInterval totalDuration;
+
+@end
+
+/**
+ A latency histogram with logarithmic buckets, from 10 microseconds to about 15 minutes.
+ */
+@interface SXLatencyHistogram : NSObject
+
+- (void) addSample:(NSTimeInterval)seconds;
+
+/**
+ Returns the upper bound of the bucket holding the given percentile, in seconds.
+ @param percentile A value between 0 and 100
+ */
+- (NSTimeInterval) valueAtPercentile:(double)percentile;
+
+@property (readonly, nonatomic) NSUInteger count;
+
+/**
+ count, p50, p95 and p99 (in milliseconds) as a dictionary
+ */
+- (NSDictionary *) summary;
+
+@end
+
+/**
+ The delegate of `SXMetrics`
+ */
+@protocol SXMetricsDelegate <NSObject>
+
+/**
+ Called each time a request completes, on the queue that ran the request handler.
+ @param metrics The metrics instance
+ @param timeline The timeline of the completed request
+ */
+- (void) metrics:(SXMetrics *)metrics didRecordTimeline:(SXRequestTimeline *)timeline;
+
+@optional
+
+/**
+ Called each time a view finishes loading a resource, on the main thread.
+ @param metrics The metrics instance
+ @param timeline The timeline of the load
+ */
+- (void) metrics:(SXMetrics *)metrics didRecordViewLoad:(SXViewLoadTimeline *)timeline;
+
+@end
+
+/**
+ SXMetrics measures where time goes in the SDK. It is disabled by default; when disabled, requests carry no timeline
+ and instrumentation points are reduced to messages to nil.
+
+ Durations are aggregated in histograms keyed by a group (the route of the resource for requests and view loads)
+ and a metric name.
+ */
+@interface SXMetrics : NSObject
+
++ (SXMetrics *) sharedMetrics;
+
+/**
+ Returns YES if metrics are being collected. Cheap enough to be called on hot paths.
+ */
++ (BOOL) isEnabled;
+
+@property (assign, nonatomic, getter = isEnabled) BOOL enabled;
+
+@property (weak, nonatomic) id<SXMetricsDelegate> delegate;
+
+/**
+ Returns the name of the given phase, as used in snapshots.
+ */
++ (NSString *) nameForPhase:(SXMetricsPhase)phase;
+
+/**
+ Returns the name of the given view load phase, as used in snapshots.
+ */
++ (NSString *) nameForViewLoadPhase:(SXViewLoadPhase)phase;
+
+/**
+ Returns the route template of a resource, used as the group of its histograms so that their number stays bounded:
+ path words of the API are kept and identifiers are replaced by `:id`, e.g. `scores/:id/best` for
+ `scores/level1/best`. The query string is dropped.
+ */
++ (NSString *) routeForResource:(NSString *)resource;
+
+///---------------------
+/// @name Recording
+///---------------------
+
+/**
+ Adds the phases of a completed request to the histograms of its route and notifies the delegate.
+ */
+- (void) recordTimeline:(SXRequestTimeline *)timeline;
+
+/**
+ Adds the phases of a completed view load to the histograms of its route, in total and split between preloaded
+ and cold loads and between cache hits and misses, and notifies the delegate.
+ */
+- (void) recordViewLoad:(SXViewLoadTimeline *)timeline;
+
+/**
+ Associates a view load with the URL of its page, for the web cache to report the first byte of the page.
+ @param timeline The timeline, or nil to stop tracking the URL
+ @param URL The URL of the page
+ */
+- (void) trackViewLoad:(SXViewLoadTimeline *)timeline forURL:(NSURL *)URL;
+
+/**
+ Returns the view load tracked for the given URL, or nil.
+ */
+- (SXViewLoadTimeline *) viewLoadForURL:(NSURL *)URL;
+
+/**
+ Adds a duration to a histogram.
+ @param duration The duration in seconds
+ @param metric The metric name
+ @param group The group, usually a resource
+ */
+- (void) recordDuration:(NSTimeInterval)duration metric:(NSString *)metric group:(NSString *)group;
+
+/**
+ Sets the current value of a metric, replacing the previous one. Values describe state rather than
+ samples, so they are kept even while metrics are disabled.
+ @param value The value, a property list object
+ @param metric The metric name
+ @param group The group
+ */
+- (void) recordValue:(id)value metric:(NSString *)metric group:(NSString *)group;
+
+///---------------------
+/// @name Reading
+///---------------------
+
+/**
+ Returns group => metric => {count, p50, p95, p99} for durations, and group => metric => value for values
+ */
+- (NSDictionary *) snapshot;
+
+/**
+ A human readable dump of `snapshot`
+ */
+- (NSString *) snapshotDescription;
+
+- (void) reset;
+
+@end
@@ -0,0 +1,528 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXMetrics.h"
+#import "SXRequest.h"
+#import <mach/mach_time.h>
+
+#define SX_HISTOGRAM_BUCKET_COUNT 96
+#define SX_HISTOGRAM_MIN_VALUE 0.00001
+#define SX_HISTOGRAM_GROWTH 1.2
+
+static BOOL SXMetricsEnabled = NO;
+
+NSTimeInterval SXMetricsTimestamp(void)
+{
+    static double secondsPerTick = 0;
+    if (!secondsPerTick) {
+        mach_timebase_info_data_t timebase;
+        mach_timebase_info(&timebase);
+        secondsPerTick = (double)timebase.numer / timebase.denom / NSEC_PER_SEC;
+    }
+    return mach_absolute_time() * secondsPerTick;
+}
+
+#pragma mark - SXRequestTimeline
+
+@interface SXRequestTimeline () {
+    NSTimeInterval _starts[SXMetricsPhaseCount];
+    NSTimeInterval _ends[SXMetricsPhaseCount];
+}
+@property (strong, nonatomic) NSString *resource;
+@property (strong, nonatomic) NSString *method;
+@property (strong, nonatomic) NSString *requestId;
+@end
+
+@implementation SXRequestTimeline
+
+- (id) initWithRequest:(SXRequest *)request
+{
+    if (self = [super init]) {
+        self.resource = request.resource;
+        self.method = request.method;
+        self.requestId = request.requestId;
+    }
+    return self;
+}
+
+- (void) beginPhase:(SXMetricsPhase)phase
+{
+    @synchronized(self) {
+        if (phase < SXMetricsPhaseCount && !_starts[phase])
+            _starts[phase] = SXMetricsTimestamp();
+    }
+}
+
+- (void) endPhase:(SXMetricsPhase)phase
+{
+    @synchronized(self) {
+        if (phase < SXMetricsPhaseCount && _starts[phase] && !_ends[phase])
+            _ends[phase] = SXMetricsTimestamp();
+    }
+}
+
+- (NSTimeInterval) durationForPhase:(SXMetricsPhase)phase
+{
+    @synchronized(self) {
+        if (phase >= SXMetricsPhaseCount || !_starts[phase] || !_ends[phase])
+            return -1;
+        return _ends[phase] - _starts[phase];
+    }
+}
+
+- (NSTimeInterval) totalDuration
+{
+    NSTimeInterval first = 0, last = 0;
+    @synchronized(self) {
+        for (int i = 0; i < SXMetricsPhaseCount; i++) {
+            if (_starts[i] && (!first || _starts[i] < first))
+                first = _starts[i];
+            if (_ends[i] > last)
+                last = _ends[i];
+        }
+    }
+    return first && last > first ? last - first : 0;
+}
+
+- (NSString *) description
+{
+    NSMutableString *result = [NSMutableString stringWithFormat:@"<SXRequestTimeline %@ %@", self.method, self.resource];
+    for (int i = 0; i < SXMetricsPhaseCount; i++) {
+        NSTimeInterval duration = [self durationForPhase:i];
+        if (duration >= 0)
+            [result appendFormat:@" %@=%.2fms", [SXMetrics nameForPhase:i], duration * 1000];
+    }
+    [result appendString:@">"];
+    return result;
+}
+
+@end
+
+#pragma mark - SXViewLoadTimeline
+
+@interface SXViewLoadTimeline () {
+    NSTimeInterval _starts[SXViewLoadPhaseCount];
+    NSTimeInterval _ends[SXViewLoadPhaseCount];
+}
+@property (strong, nonatomic) NSString *resource;
+@end
+
+@implementation SXViewLoadTimeline
+
+- (id) initWithResource:(NSString *)resource
+{
+    if (self = [super init]) {
+        self.resource = resource;
+    }
+    return self;
+}
+
+- (void) beginPhase:(SXViewLoadPhase)phase
+{
+    @synchronized(self) {
+        if (phase < SXViewLoadPhaseCount && !_starts[phase])
+            _starts[phase] = SXMetricsTimestamp();
+    }
+}
+
+- (void) endPhase:(SXViewLoadPhase)phase
+{
+    @synchronized(self) {
+        if (phase < SXViewLoadPhaseCount && _starts[phase] && !_ends[phase])
+            _ends[phase] = SXMetricsTimestamp();
+    }
+}
+
+- (void) receivedFirstByteFromCache:(BOOL)cacheHit
+{
+    // Called on the loading thread of the web cache, while the view reads the timeline on the main thread
+    @synchronized(self) {
+        self.cacheHit = cacheHit;
+        [self endPhase:SXViewLoadPhaseFirstByte];
+        [self beginPhase:SXViewLoadPhaseRender];
+    }
+}
+
+- (BOOL) isCacheHit
+{
+    @synchronized(self) {
+        return _cacheHit;
+    }
+}
+
+- (NSTimeInterval) durationForPhase:(SXViewLoadPhase)phase
+{
+    @synchronized(self) {
+        if (phase >= SXViewLoadPhaseCount || !_starts[phase] || !_ends[phase])
+            return -1;
+        return _ends[phase] - _starts[phase];
+    }
+}
+
+- (NSTimeInterval) totalDuration
+{
+    NSTimeInterval first = 0, last = 0;
+    @synchronized(self) {
+        for (int i = 0; i < SXViewLoadPhaseCount; i++) {
+            if (_starts[i] && (!first || _starts[i] < first))
+                first = _starts[i];
+            if (_ends[i] > last)
+                last = _ends[i];
+        }
+    }
+    return first && last > first ? last - first : 0;
+}
+
+- (NSString *) description
+{
+    NSMutableString *result = [NSMutableString stringWithFormat:@"<SXViewLoadTimeline %@%@%@", self.resource,
+                               self.preloaded ? @" preloaded" : @"", self.cacheHit ? @" cached" : @""];
+    for (int i = 0; i < SXViewLoadPhaseCount; i++) {
+        NSTimeInterval duration = [self durationForPhase:i];
+        if (duration >= 0)
+            [result appendFormat:@" %@=%.2fms", [SXMetrics nameForViewLoadPhase:i], duration * 1000];
+    }
+    [result appendString:@">"];
+    return result;
+}
+
+@end
+
+#pragma mark - SXLatencyHistogram
+
+@interface SXLatencyHistogram () {
+    NSUInteger _buckets[SX_HISTOGRAM_BUCKET_COUNT];
+}
+@property (assign, nonatomic) NSUInteger count;
+@end
+
+@implementation SXLatencyHistogram
+
+- (void) addSample:(NSTimeInterval)seconds
+{
+    NSInteger bucket = 0;
+    if (seconds > SX_HISTOGRAM_MIN_VALUE)
+        bucket = (NSInteger)ceil(log(seconds / SX_HISTOGRAM_MIN_VALUE) / log(SX_HISTOGRAM_GROWTH));
+    bucket = MIN(MAX(bucket, 0), SX_HISTOGRAM_BUCKET_COUNT - 1);
+
+    _buckets[bucket]++;
+    self.count++;
+}
+
+- (NSTimeInterval) valueAtPercentile:(double)percentile
+{
+    if (!self.count)
+        return 0;
+
+    NSUInteger rank = (NSUInteger)ceil(self.count * MIN(MAX(percentile, 0), 100) / 100.0);
+    NSUInteger seen = 0;
+    for (NSUInteger i = 0; i < SX_HISTOGRAM_BUCKET_COUNT; i++) {
+        seen += _buckets[i];
+        if (seen >= MAX(rank, 1))
+            return SX_HISTOGRAM_MIN_VALUE * pow(SX_HISTOGRAM_GROWTH, i);
+    }
+    return SX_HISTOGRAM_MIN_VALUE * pow(SX_HISTOGRAM_GROWTH, SX_HISTOGRAM_BUCKET_COUNT - 1);
+}
+
+- (NSDictionary *) summary
+{
+    return @{@"count": [NSNumber numberWithUnsignedInteger:self.count],
+             @"p50": [NSNumber numberWithDouble:[self valueAtPercentile:50] * 1000],
+             @"p95": [NSNumber numberWithDouble:[self valueAtPercentile:95] * 1000],
+             @"p99": [NSNumber numberWithDouble:[self valueAtPercentile:99] * 1000]};
+}
+
+@end
+
+#pragma mark - SXMetrics
+
+@interface SXMetrics ()
+
+/// group => metric => SXLatencyHistogram
+@property (strong, nonatomic) NSMutableDictionary *histograms;
+
+/// group => metric => value
+@property (strong, nonatomic) NSMutableDictionary *values;
+
+/// page URL without fragment => SXViewLoadTimeline, for the loads in progress
+@property (strong, nonatomic) NSMutableDictionary *viewLoads;
+
+- (NSString *) viewLoadKeyForURL:(NSURL *)URL;
+
+@end
+
+@implementation SXMetrics
+
++ (SXMetrics *) sharedMetrics
+{
+    static SXMetrics *sharedMetrics = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedMetrics = [[SXMetrics alloc] init];
+    });
+    return sharedMetrics;
+}
+
++ (BOOL) isEnabled
+{
+    return SXMetricsEnabled;
+}
+
+- (id) init
+{
+    if (self = [super init]) {
+        self.histograms = [[NSMutableDictionary alloc] init];
+        self.values = [[NSMutableDictionary alloc] init];
+        self.viewLoads = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+- (BOOL) isEnabled
+{
+    return SXMetricsEnabled;
+}
+
+- (void) setEnabled:(BOOL)enabled
+{
+    SXMetricsEnabled = enabled;
+}
+
++ (NSString *) nameForPhase:(SXMetricsPhase)phase
+{
+    switch (phase) {
+        case SXMetricsPhaseTokenWait:  return @"tokenWait";
+        case SXMetricsPhaseDecoration: return @"decoration";
+        case SXMetricsPhaseSigning:    return @"signing";
+        case SXMetricsPhaseQueueWait:  return @"queueWait";
+        case SXMetricsPhaseNetwork:    return @"network";
+        case SXMetricsPhaseParse:      return @"parse";
+        case SXMetricsPhaseHandler:    return @"handler";
+        default:                       return @"unknown";
+    }
+}
+
++ (NSString *) nameForViewLoadPhase:(SXViewLoadPhase)phase
+{
+    switch (phase) {
+        case SXViewLoadPhaseTokenWait: return @"tokenWait";
+        case SXViewLoadPhaseRequest:   return @"request";
+        case SXViewLoadPhaseFirstByte: return @"firstByte";
+        case SXViewLoadPhaseRender:    return @"render";
+        default:                       return @"unknown";
+    }
+}
+
++ (NSString *) routeForResource:(NSString *)resource
+{
+    static NSSet *literalSegments = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        literalSegments = [NSSet setWithObjects:@"web", @"scores", @"ranks", @"best", @"players", @"me", @"friends",
+                           @"edit", @"newsfeed", @"rating", @"settings", @"leaderboards", @"overview", @"challenges",
+                           @"instances", @"turns", @"social", @"invitations", @"oauth", @"anonymousAccessToken",
+                           @"accessToken", @"accessTokenExternallyAuthenticated", @"authorize", @"network",
+                           @"ping", @"notifications", @"track", @"deviceTokens", @"developers", @"games", @"search",
+                           @"callback", @"linkExternallyAuthenticated", nil];
+    });
+
+    if (!resource)
+        return @"";
+
+    NSRange query = [resource rangeOfCharacterFromSet:[NSCharacterSet characterSetWithCharactersInString:@"?#"]];
+    if (NSNotFound != query.location)
+        resource = [resource substringToIndex:query.location];
+
+    NSMutableArray *segments = [NSMutableArray array];
+    for (NSString *segment in [resource componentsSeparatedByString:@"/"]) {
+        if (!segment.length)
+            continue;
+        [segments addObject:[literalSegments containsObject:segment] ? segment : @":id"];
+    }
+    return [segments componentsJoinedByString:@"/"];
+}
+
+#pragma mark - Recording
+
+- (void) recordTimeline:(SXRequestTimeline *)timeline
+{
+    if (!timeline || !SXMetricsEnabled)
+        return;
+
+    NSString *group = [[self class] routeForResource:timeline.resource];
+    for (int i = 0; i < SXMetricsPhaseCount; i++) {
+        NSTimeInterval duration = [timeline durationForPhase:i];
+        if (duration >= 0)
+            [self recordDuration:duration metric:[[self class] nameForPhase:i] group:group];
+    }
+    [self recordDuration:timeline.totalDuration metric:@"total" group:group];
+
+    SXLog(@"%@", timeline);
+    [self.delegate metrics:self didRecordTimeline:timeline];
+}
+
+- (void) recordViewLoad:(SXViewLoadTimeline *)timeline
+{
+    if (!timeline || !SXMetricsEnabled)
+        return;
+
+    NSString *group = [[self class] routeForResource:timeline.resource];
+    for (int i = 0; i < SXViewLoadPhaseCount; i++) {
+        NSTimeInterval duration = [timeline durationForPhase:i];
+        if (duration >= 0)
+            [self recordDuration:duration metric:[[self class] nameForViewLoadPhase:i] group:group];
+    }
+    NSTimeInterval total = timeline.totalDuration;
+    [self recordDuration:total metric:@"total" group:group];
+    [self recordDuration:total metric:timeline.preloaded ? @"totalPreloaded" : @"totalCold" group:group];
+    [self recordDuration:total metric:timeline.cacheHit ? @"totalCacheHit" : @"totalCacheMiss" group:group];
+
+    SXLog(@"%@", timeline);
+    if ([self.delegate respondsToSelector:@selector(metrics:didRecordViewLoad:)])
+        [self.delegate metrics:self didRecordViewLoad:timeline];
+}
+
+- (NSString *) viewLoadKeyForURL:(NSURL *)URL
+{
+    NSString *key = URL.absoluteString;
+    NSRange fragment = [key rangeOfString:@"#"];
+    return NSNotFound == fragment.location ? key : [key substringToIndex:fragment.location];
+}
+
+- (void) trackViewLoad:(SXViewLoadTimeline *)timeline forURL:(NSURL *)URL
+{
+    NSString *key = [self viewLoadKeyForURL:URL];
+    if (!key)
+        return;
+
+    @synchronized(self) {
+        if (timeline)
+            [self.viewLoads setObject:timeline forKey:key];
+        else
+            [self.viewLoads removeObjectForKey:key];
+    }
+}
+
+- (SXViewLoadTimeline *) viewLoadForURL:(NSURL *)URL
+{
+    if (!SXMetricsEnabled)
+        return nil;
+
+    NSString *key = [self viewLoadKeyForURL:URL];
+    if (!key)
+        return nil;
+
+    @synchronized(self) {
+        return [self.viewLoads objectForKey:key];
+    }
+}
+
+- (void) recordDuration:(NSTimeInterval)duration metric:(NSString *)metric group:(NSString *)group
+{
+    if (!SXMetricsEnabled || !metric || !group)
+        return;
+
+    @synchronized(self) {
+        NSMutableDictionary *metrics = [self.histograms objectForKey:group];
+        if (!metrics) {
+            metrics = [NSMutableDictionary dictionary];
+            [self.histograms setObject:metrics forKey:group];
+        }
+
+        SXLatencyHistogram *histogram = [metrics objectForKey:metric];
+        if (!histogram) {
+            histogram = [[SXLatencyHistogram alloc] init];
+            [metrics setObject:histogram forKey:metric];
+        }
+        [histogram addSample:duration];
+    }
+}
+
+- (void) recordValue:(id)value metric:(NSString *)metric group:(NSString *)group
+{
+    if (!value || !metric || !group)
+        return;
+
+    @synchronized(self) {
+        NSMutableDictionary *metrics = [self.values objectForKey:group];
+        if (!metrics) {
+            metrics = [NSMutableDictionary dictionary];
+            [self.values setObject:metrics forKey:group];
+        }
+        [metrics setObject:value forKey:metric];
+    }
+}
+
+#pragma mark - Reading
+
+- (NSDictionary *) snapshot
+{
+    NSMutableDictionary *result = [NSMutableDictionary dictionary];
+    @synchronized(self) {
+        for (NSString *group in self.histograms) {
+            NSDictionary *metrics = [self.histograms objectForKey:group];
+            NSMutableDictionary *summaries = [NSMutableDictionary dictionaryWithCapacity:metrics.count];
+            for (NSString *metric in metrics)
+                [summaries setObject:[[metrics objectForKey:metric] summary] forKey:metric];
+            [result setObject:summaries forKey:group];
+        }
+        for (NSString *group in self.values) {
+            NSMutableDictionary *summaries = [result objectForKey:group];
+            if (!summaries) {
+                summaries = [NSMutableDictionary dictionary];
+                [result setObject:summaries forKey:group];
+            }
+            [summaries addEntriesFromDictionary:[self.values objectForKey:group]];
+        }
+    }
+    return result;
+}
+
+- (NSString *) snapshotDescription
+{
+    NSDictionary *snapshot = [self snapshot];
+    NSMutableString *result = [NSMutableString string];
+    for (NSString *group in [snapshot.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+        [result appendFormat:@"%@\n", group];
+        NSDictionary *metrics = [snapshot objectForKey:group];
+        for (NSString *metric in [metrics.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+            NSDictionary *summary = [metrics objectForKey:metric];
+            if (![summary isKindOfClass:[NSDictionary class]]) {
+                [result appendFormat:@"  %-12s %@\n", metric.UTF8String, summary];
+                continue;
+            }
+            // Field widths only apply to C strings and numbers, not to objects
+            [result appendFormat:@"  %-12s n=%-6lu p50=%.2fms p95=%.2fms p99=%.2fms\n", metric.UTF8String,
+             [[summary objectForKey:@"count"] unsignedLongValue],
+             [[summary objectForKey:@"p50"] doubleValue],
+             [[summary objectForKey:@"p95"] doubleValue],
+             [[summary objectForKey:@"p99"] doubleValue]];
+        }
+    }
+    return result;
+}
+
+- (void) reset
+{
+    @synchronized(self) {
+        [self.histograms removeAllObjects];
+    }
+}
+
+@end
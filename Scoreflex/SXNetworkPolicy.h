@@ -0,0 +1,119 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import <Foundation/Foundation.h>
+#import "AFHTTPClient.h"
+
+/**
+ Name of the notification posted by `SXNetworkPolicy` when one of its decisions changes
+ */
+#define SX_NOTIFICATION_NETWORK_POLICY_CHANGED @"ScoreflexNetworkPolicyChanged"
+
+/**
+ @enum SXNetworkClass the kind of network the device is connected to
+ */
+typedef enum {
+    SXNetworkClassOffline,
+    SXNetworkClassCellular,
+    SXNetworkClassWiFi,
+} SXNetworkClass;
+
+/**
+ SXNetworkPolicy decides how hard the SDK may use the network. It combines the network class reported by
+ reachability with the round trip time and throughput measured on completed requests, and derives:
+
+ - the number of concurrent requests to the Scoreflex API
+ - the scale to apply to the size of downloaded images
+ - whether the request vault replays saved requests
+
+ Decisions are recomputed on each reachability change and measurement. When one changes,
+ `SX_NOTIFICATION_NETWORK_POLICY_CHANGED` is posted and the decisions are recorded in the `network` group
+ of `SXMetrics`.
+ */
+@interface SXNetworkPolicy : NSObject
+
+/**
+ The shared policy
+ */
++ (SXNetworkPolicy *) sharedPolicy;
+
+///---------------------
+/// @name Inputs
+///---------------------
+
+/**
+ Updates the network class from a reachability status. An unknown status counts as offline.
+ */
+- (void) updateWithReachabilityStatus:(AFNetworkReachabilityStatus)status;
+
+/**
+ Records a completed transfer, from the start of a request to the end of its response.
+ Small responses measure the round trip time, large ones the throughput.
+ @param length The length of the response body, in bytes
+ @param duration The duration of the transfer, in seconds
+ */
+- (void) recordTransferOfLength:(NSUInteger)length duration:(NSTimeInterval)duration;
+
+/**
+ If YES, the request vault does not replay saved requests on cellular networks. NO by default.
+ */
+@property (assign, nonatomic) BOOL defersReplayOnCellular;
+
+@property (readonly, nonatomic) SXNetworkClass networkClass;
+
+/**
+ The smoothed round trip time in seconds, or 0 if none was measured yet
+ */
+@property (readonly, nonatomic) NSTimeInterval roundTripTime;
+
+/**
+ The smoothed throughput in bytes per second, or 0 if none was measured yet
+ */
+@property (readonly, nonatomic) double throughput;
+
+/**
+ YES when the measured round trip time or throughput is poor, whatever the network class
+ */
+@property (readonly, nonatomic, getter = isSlow) BOOL slow;
+
+///---------------------
+/// @name Decisions
+///---------------------
+
+/**
+ The maximum number of concurrent requests to the Scoreflex API
+ */
+@property (readonly, nonatomic) NSInteger maxConcurrentRequests;
+
+/**
+ The factor, between 0 and 1, to apply to the pixel size of downloaded images
+ */
+@property (readonly, nonatomic) double imageScaleFactor;
+
+/**
+ YES if the request vault should replay saved requests
+ */
+@property (readonly, nonatomic) BOOL shouldReplayRequests;
+
+/**
+ Returns the current decisions and measurements, as recorded in `SXMetrics`.
+ */
+- (NSDictionary *) decisions;
+
+@end
@@ -0,0 +1,235 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXNetworkPolicy.h"
+#import "SXMetrics.h"
+
+/// Responses up to this length measure the round trip time, larger ones the throughput
+#define NETWORK_POLICY_SMALL_RESPONSE_LENGTH 16384
+
+/// Weight of a new measurement in the moving averages
+#define NETWORK_POLICY_SMOOTHING 0.2
+
+#define NETWORK_POLICY_SLOW_ROUND_TRIP_TIME 1.0
+#define NETWORK_POLICY_SLOW_THROUGHPUT (32 * 1024)
+
+@interface SXNetworkPolicy ()
+
+@property (assign, nonatomic) SXNetworkClass networkClass;
+@property (assign, nonatomic) NSTimeInterval roundTripTime;
+@property (assign, nonatomic) double throughput;
+@property (assign, nonatomic) NSInteger maxConcurrentRequests;
+@property (assign, nonatomic) double imageScaleFactor;
+@property (assign, nonatomic) BOOL shouldReplayRequests;
+
+- (void) reachabilityNotification:(NSNotification *)notification;
+
+/// Recomputes the decisions, and returns YES if one of them changed. Called while synchronized.
+- (BOOL) decide;
+
+- (void) publish;
+
+@end
+
+@implementation SXNetworkPolicy
+
++ (SXNetworkPolicy *) sharedPolicy
+{
+    static SXNetworkPolicy *sharedPolicy = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedPolicy = [[SXNetworkPolicy alloc] init];
+    });
+    return sharedPolicy;
+}
+
+- (id) init
+{
+    if (self = [super init]) {
+        self.networkClass = SXNetworkClassOffline;
+        [self decide];
+
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(reachabilityNotification:) name:AFNetworkingReachabilityDidChangeNotification object:nil];
+    }
+    return self;
+}
+
+- (void) dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+#pragma mark - Inputs
+
+- (void) reachabilityNotification:(NSNotification *)notification
+{
+    NSNumber *status = [notification.userInfo valueForKey:AFNetworkingReachabilityNotificationStatusItem];
+    [self updateWithReachabilityStatus:status.intValue];
+}
+
+- (void) updateWithReachabilityStatus:(AFNetworkReachabilityStatus)status
+{
+    SXNetworkClass networkClass;
+    switch (status) {
+        case AFNetworkReachabilityStatusReachableViaWiFi:
+            networkClass = SXNetworkClassWiFi;
+            break;
+        case AFNetworkReachabilityStatusReachableViaWWAN:
+            networkClass = SXNetworkClassCellular;
+            break;
+        default:
+            networkClass = SXNetworkClassOffline;
+            break;
+    }
+
+    BOOL changed;
+    @synchronized(self) {
+        if (networkClass != self.networkClass) {
+            SXLog(@"Network class changed to %i", networkClass);
+
+            // Measurements made on another network say nothing about this one
+            self.roundTripTime = 0;
+            self.throughput = 0;
+        }
+        self.networkClass = networkClass;
+        changed = [self decide];
+    }
+
+    if (changed)
+        [self publish];
+}
+
+- (void) recordTransferOfLength:(NSUInteger)length duration:(NSTimeInterval)duration
+{
+    if (duration <= 0)
+        return;
+
+    if (length <= NETWORK_POLICY_SMALL_RESPONSE_LENGTH)
+        [[SXMetrics sharedMetrics] recordDuration:duration metric:@"roundTrip" group:@"network"];
+
+    BOOL changed;
+    @synchronized(self) {
+        if (length <= NETWORK_POLICY_SMALL_RESPONSE_LENGTH) {
+            self.roundTripTime = self.roundTripTime > 0
+                ? self.roundTripTime + NETWORK_POLICY_SMOOTHING * (duration - self.roundTripTime)
+                : duration;
+        } else {
+            double throughput = length / duration;
+            self.throughput = self.throughput > 0
+                ? self.throughput + NETWORK_POLICY_SMOOTHING * (throughput - self.throughput)
+                : throughput;
+        }
+        changed = [self decide];
+    }
+
+    if (changed)
+        [self publish];
+}
+
+- (void) setDefersReplayOnCellular:(BOOL)defersReplayOnCellular
+{
+    BOOL changed;
+    @synchronized(self) {
+        _defersReplayOnCellular = defersReplayOnCellular;
+        changed = [self decide];
+    }
+
+    if (changed)
+        [self publish];
+}
+
+- (BOOL) isSlow
+{
+    @synchronized(self) {
+        return self.roundTripTime > NETWORK_POLICY_SLOW_ROUND_TRIP_TIME
+            || (self.throughput > 0 && self.throughput < NETWORK_POLICY_SLOW_THROUGHPUT);
+    }
+}
+
+#pragma mark - Decisions
+
+- (BOOL) decide
+{
+    NSInteger maxConcurrentRequests;
+    double imageScaleFactor;
+    BOOL shouldReplayRequests;
+
+    switch (self.networkClass) {
+        case SXNetworkClassWiFi:
+            maxConcurrentRequests = MAX_CONCURRENT_REQUESTS_PER_HOST;
+            imageScaleFactor = 1.0;
+            shouldReplayRequests = YES;
+            break;
+
+        case SXNetworkClassCellular:
+            // Fewer concurrent transfers on a shared, high latency link
+            maxConcurrentRequests = MAX(MAX_CONCURRENT_REQUESTS_PER_HOST / 2, 1);
+            imageScaleFactor = 0.75;
+            shouldReplayRequests = !self.defersReplayOnCellular;
+            break;
+
+        default:
+            // Requests are not throttled while reachability is still unknown at startup
+            maxConcurrentRequests = MAX_CONCURRENT_REQUESTS_PER_HOST;
+            imageScaleFactor = 1.0;
+            shouldReplayRequests = NO;
+            break;
+    }
+
+    if (SXNetworkClassOffline != self.networkClass && [self isSlow]) {
+        maxConcurrentRequests = 1;
+        imageScaleFactor = 0.5;
+    }
+
+    BOOL changed = maxConcurrentRequests != self.maxConcurrentRequests
+        || imageScaleFactor != self.imageScaleFactor
+        || shouldReplayRequests != self.shouldReplayRequests;
+
+    self.maxConcurrentRequests = maxConcurrentRequests;
+    self.imageScaleFactor = imageScaleFactor;
+    self.shouldReplayRequests = shouldReplayRequests;
+
+    return changed;
+}
+
+- (NSDictionary *) decisions
+{
+    @synchronized(self) {
+        return @{@"networkClass": [NSNumber numberWithInt:self.networkClass],
+                 @"roundTripTime": [NSNumber numberWithDouble:self.roundTripTime * 1000],
+                 @"throughput": [NSNumber numberWithDouble:self.throughput],
+                 @"maxConcurrentRequests": [NSNumber numberWithInteger:self.maxConcurrentRequests],
+                 @"imageScaleFactor": [NSNumber numberWithDouble:self.imageScaleFactor],
+                 @"shouldReplayRequests": [NSNumber numberWithBool:self.shouldReplayRequests]};
+    }
+}
+
+- (void) publish
+{
+    NSDictionary *decisions = [self decisions];
+    SXLog(@"Network policy changed: %@", decisions);
+
+    SXMetrics *metrics = [SXMetrics sharedMetrics];
+    for (NSString *name in decisions)
+        [metrics recordValue:[decisions objectForKey:name] metric:name group:@"network"];
+
+    [[NSNotificationCenter defaultCenter] postNotificationName:SX_NOTIFICATION_NETWORK_POLICY_CHANGED object:self userInfo:decisions];
+}
+
+@end
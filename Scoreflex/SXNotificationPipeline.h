@@ -0,0 +1,75 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ SXNotificationPipeline queues the Scoreflex push notifications received by the application until they can
+ be handled. Notifications with the same code and target are merged, the most recent one winning, and the
+ queue is drained in a single batch sorted by priority, so that a burst of notifications opens at most one view.
+ */
+@interface SXNotificationPipeline : NSObject
+
+/**
+ The shared pipeline
+ */
++ (SXNotificationPipeline *) sharedPipeline;
+
+/**
+ Called on the main thread with each drained batch, highest priority notification first.
+ While nil, notifications are kept in the queue.
+ */
+@property (copy, nonatomic) void (^handler)(NSArray *notifications);
+
+/// The number of queued notifications
+@property (readonly, nonatomic) NSUInteger pendingCount;
+
+/**
+ Returns the priority of a notification code, the highest one being handled first.
+ */
++ (NSInteger) priorityForCode:(int)code;
+
+/**
+ Returns the key identifying the code and target of a notification, used to merge duplicates.
+ */
++ (NSString *) keyForNotification:(NSDictionary *)notification;
+
+/**
+ Queues the `_sfx` payload of a push notification and schedules a drain if a handler is set.
+ At most `NOTIFICATION_PIPELINE_MAX_COUNT` notifications are kept, the lowest priority ones being dropped.
+ @return NO if the notification was merged with a queued one
+ */
+- (BOOL) enqueueNotification:(NSDictionary *)notification;
+
+/**
+ Returns the queued notifications sorted by priority, most recent first for equal priorities, and empties the queue.
+ */
+- (NSArray *) takePendingNotifications;
+
+/**
+ Drains the queue now and passes the batch to the handler, if any.
+ */
+- (void) flush;
+
+/**
+ Removes every queued notification.
+ */
+- (void) reset;
+
+@end
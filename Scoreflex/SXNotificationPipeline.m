@@ -0,0 +1,210 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXNotificationPipeline.h"
+#import "Scoreflex.h"
+
+#define NOTIFICATION_PIPELINE_NOTIFICATION_KEY @"notification"
+#define NOTIFICATION_PIPELINE_PRIORITY_KEY @"priority"
+#define NOTIFICATION_PIPELINE_SEQUENCE_KEY @"sequence"
+
+@interface SXNotificationPipeline ()
+
+/// key => {notification, priority, sequence}
+@property (strong, nonatomic) NSMutableDictionary *entries;
+
+/// Incremented for each enqueued notification, to keep the most recent one first
+@property (assign, nonatomic) NSUInteger sequence;
+
+@property (assign, nonatomic) BOOL drainScheduled;
+
+- (void) dropLowestPriorityEntry;
+
+@end
+
+@implementation SXNotificationPipeline
+
++ (SXNotificationPipeline *) sharedPipeline
+{
+    static SXNotificationPipeline *sharedPipeline = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedPipeline = [[SXNotificationPipeline alloc] init];
+    });
+    return sharedPipeline;
+}
+
+- (id) init
+{
+    if (self = [super init]) {
+        self.entries = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+#pragma mark - Notifications
+
++ (NSInteger) priorityForCode:(int)code
+{
+    switch (code) {
+        case SX_PUSH_NOTIFICATION_TYPE_YOUR_TURN_IN_CHALLENGE:
+            return 6;
+        case SX_PUSH_NOTIFICATION_TYPE_CHALLENGE_INVITATION:
+            return 5;
+        case SX_PUSH_NOTIFICATION_TYPE_CHALLENGE_ENDED:
+            return 4;
+        case SX_PUSH_NOTIFICATION_TYPE_FRIEND_BEAT_YOUR_HIGHSCORE:
+            return 3;
+        case SX_PUSH_NOTIFICATION_TYPE_FRIEND_JOINED_GAME:
+            return 2;
+        case SX_PUSH_NOTIFICATION_TYPE_PLAYER_LEVEL_CHANGED:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
++ (NSString *) keyForNotification:(NSDictionary *)notification
+{
+    NSDictionary *data = [notification objectForKey:@"data"];
+    if (![data isKindOfClass:[NSDictionary class]])
+        data = nil;
+
+    return [NSString stringWithFormat:@"%d|%@|%@|%@|%@",
+            [[notification objectForKey:@"code"] intValue],
+            [data objectForKey:@"targetPlayerId"] ?: @"",
+            [data objectForKey:@"challengeInstanceId"] ?: @"",
+            [data objectForKey:@"friendId"] ?: @"",
+            [data objectForKey:@"leaderboardId"] ?: @""];
+}
+
+- (BOOL) enqueueNotification:(NSDictionary *)notification
+{
+    if (![notification isKindOfClass:[NSDictionary class]])
+        return NO;
+
+    NSString *key = [SXNotificationPipeline keyForNotification:notification];
+    NSInteger priority = [SXNotificationPipeline priorityForCode:[[notification objectForKey:@"code"] intValue]];
+    BOOL added = NO;
+    BOOL schedule = NO;
+
+    @synchronized(self) {
+        added = [self.entries objectForKey:key] == nil;
+        self.sequence++;
+        [self.entries setObject:@{NOTIFICATION_PIPELINE_NOTIFICATION_KEY: notification,
+                                  NOTIFICATION_PIPELINE_PRIORITY_KEY: [NSNumber numberWithInteger:priority],
+                                  NOTIFICATION_PIPELINE_SEQUENCE_KEY: [NSNumber numberWithUnsignedInteger:self.sequence]}
+                         forKey:key];
+
+        if (self.entries.count > NOTIFICATION_PIPELINE_MAX_COUNT)
+            [self dropLowestPriorityEntry];
+
+        if (self.handler && !self.drainScheduled) {
+            self.drainScheduled = YES;
+            schedule = YES;
+        }
+    }
+
+    if (!added)
+        SXLog(@"Merged duplicate notification %@", key);
+
+    // Coalesce a burst of notifications into a single drain
+    if (schedule) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self flush];
+        });
+    }
+    return added;
+}
+
+- (void) dropLowestPriorityEntry
+{
+    NSString *lowestKey = nil;
+    NSDictionary *lowest = nil;
+    for (NSString *key in self.entries) {
+        NSDictionary *entry = [self.entries objectForKey:key];
+        NSComparisonResult result = lowest
+            ? [[entry objectForKey:NOTIFICATION_PIPELINE_PRIORITY_KEY] compare:[lowest objectForKey:NOTIFICATION_PIPELINE_PRIORITY_KEY]]
+            : NSOrderedAscending;
+        if (NSOrderedSame == result)
+            result = [[entry objectForKey:NOTIFICATION_PIPELINE_SEQUENCE_KEY] compare:[lowest objectForKey:NOTIFICATION_PIPELINE_SEQUENCE_KEY]];
+        if (NSOrderedAscending == result) {
+            lowestKey = key;
+            lowest = entry;
+        }
+    }
+
+    if (lowestKey) {
+        SXLog(@"Notification queue full, dropping %@", lowestKey);
+        [self.entries removeObjectForKey:lowestKey];
+    }
+}
+
+- (NSUInteger) pendingCount
+{
+    @synchronized(self) {
+        return self.entries.count;
+    }
+}
+
+- (NSArray *) takePendingNotifications
+{
+    NSArray *entries = nil;
+    @synchronized(self) {
+        entries = [self.entries allValues];
+        [self.entries removeAllObjects];
+    }
+
+    entries = [entries sortedArrayUsingComparator:^NSComparisonResult(NSDictionary *entry1, NSDictionary *entry2) {
+        NSComparisonResult result = [[entry2 objectForKey:NOTIFICATION_PIPELINE_PRIORITY_KEY] compare:[entry1 objectForKey:NOTIFICATION_PIPELINE_PRIORITY_KEY]];
+        if (NSOrderedSame == result)
+            result = [[entry2 objectForKey:NOTIFICATION_PIPELINE_SEQUENCE_KEY] compare:[entry1 objectForKey:NOTIFICATION_PIPELINE_SEQUENCE_KEY]];
+        return result;
+    }];
+
+    NSMutableArray *notifications = [NSMutableArray arrayWithCapacity:entries.count];
+    for (NSDictionary *entry in entries)
+        [notifications addObject:[entry objectForKey:NOTIFICATION_PIPELINE_NOTIFICATION_KEY]];
+    return notifications;
+}
+
+- (void) flush
+{
+    void (^handler)(NSArray *) = nil;
+    @synchronized(self) {
+        self.drainScheduled = NO;
+        handler = self.handler;
+    }
+    if (!handler)
+        return;
+
+    NSArray *notifications = [self takePendingNotifications];
+    if (notifications.count)
+        handler(notifications);
+}
+
+- (void) reset
+{
+    @synchronized(self) {
+        [self.entries removeAllObjects];
+        self.drainScheduled = NO;
+    }
+}
+
+@end
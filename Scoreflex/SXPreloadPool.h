@@ -0,0 +1,97 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import <Foundation/Foundation.h>
+#import "SXViewController.h"
+
+/**
+ SXPreloadPool holds the view controllers of preloaded resources, each with a live web view, within an entry and
+ memory budget. The least recently used controllers are evicted first, and everything is evicted on memory warnings.
+
+ Evicted controllers are not thrown away right away: up to `PRELOAD_POOL_RECYCLE_COUNT` of them are blanked and kept
+ to load the next resource, which saves the allocation of a controller, its view and its web view.
+
+ The pool is meant to be used from the main thread only.
+ */
+@interface SXPreloadPool : NSObject
+
+/**
+ The shared pool, with a budget of `PRELOAD_POOL_MAX_COUNT` entries and `PRELOAD_POOL_MAX_COST` bytes
+ */
++ (SXPreloadPool *) sharedPool;
+
+/// The maximum number of preloaded controllers
+@property (assign, nonatomic) NSUInteger maxCount;
+
+/// The maximum estimated memory used by the preloaded controllers, in bytes. 0 means no limit.
+@property (assign, nonatomic) NSUInteger maxCost;
+
+/// The number of preloaded controllers
+@property (readonly) NSUInteger count;
+
+/// The estimated memory used by the preloaded controllers, in bytes
+@property (readonly) NSUInteger totalCost;
+
+///---------------------
+/// @name Preloaded controllers
+///---------------------
+
+/**
+ Returns the controller preloading the given resource, or nil, and marks it as recently used.
+ */
+- (SXViewController *) controllerForResource:(NSString *)resource;
+
+/**
+ Removes the controller preloading the given resource from the pool and returns it, for it to be shown.
+ */
+- (SXViewController *) takeControllerForResource:(NSString *)resource;
+
+/**
+ Adds a controller preloading the given resource, evicting the least recently used ones if over budget.
+ */
+- (void) setController:(SXViewController *)controller forResource:(NSString *)resource;
+
+/**
+ Evicts the controller preloading the given resource.
+ */
+- (void) removeControllerForResource:(NSString *)resource;
+
+/**
+ Evicts every preloaded controller.
+ */
+- (void) removeAllControllers;
+
+/**
+ Evicts every preloaded controller and drops the recycled ones.
+ */
+- (void) handleMemoryWarning;
+
+///---------------------
+/// @name Recycling
+///---------------------
+
+/**
+ Returns a recycled controller, reset with `prepareForReuse`, or a new one.
+ */
+- (SXViewController *) dequeueReusableController;
+
+/// The number of evicted controllers waiting to be reused
+@property (readonly) NSUInteger recycledCount;
+
+@end
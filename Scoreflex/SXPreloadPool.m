@@ -0,0 +1,221 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXPreloadPool.h"
+#import "SXView.h"
+#import "Scoreflex.h"
+
+@interface SXPreloadPool ()
+
+/// resource => SXViewController
+@property (strong, nonatomic) NSMutableDictionary *controllers;
+
+/// resource => NSNumber, the estimated cost of each controller
+@property (strong, nonatomic) NSMutableDictionary *costs;
+
+/// Resources from the least to the most recently used
+@property (strong, nonatomic) NSMutableArray *resources;
+
+/// Evicted controllers waiting to be reused
+@property (strong, nonatomic) NSMutableArray *recycled;
+
+@property (assign, nonatomic) NSUInteger totalCost;
+
+- (NSUInteger) costOfController:(SXViewController *)controller;
+
+- (void) evictToCount:(NSUInteger)count cost:(NSUInteger)cost;
+
+- (void) evictResource:(NSString *)resource;
+
+@end
+
+@implementation SXPreloadPool
+
++ (SXPreloadPool *) sharedPool
+{
+    static SXPreloadPool *sharedPool = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedPool = [[SXPreloadPool alloc] init];
+    });
+    return sharedPool;
+}
+
+- (id) init
+{
+    if (self = [super init]) {
+        self.controllers = [[NSMutableDictionary alloc] init];
+        self.costs = [[NSMutableDictionary alloc] init];
+        self.resources = [[NSMutableArray alloc] init];
+        self.recycled = [[NSMutableArray alloc] init];
+        self.maxCount = PRELOAD_POOL_MAX_COUNT;
+        self.maxCost = PRELOAD_POOL_MAX_COST;
+    }
+    return self;
+}
+
+- (NSUInteger) count
+{
+    return self.controllers.count;
+}
+
+- (NSUInteger) recycledCount
+{
+    return self.recycled.count;
+}
+
+- (void) setMaxCount:(NSUInteger)maxCount
+{
+    _maxCount = maxCount;
+    [self evictToCount:self.maxCount cost:self.maxCost];
+}
+
+- (void) setMaxCost:(NSUInteger)maxCost
+{
+    _maxCost = maxCost;
+    [self evictToCount:self.maxCount cost:self.maxCost];
+}
+
+- (NSUInteger) costOfController:(SXViewController *)controller
+{
+    // The backing store of the web view, 4 bytes per pixel
+    CGSize size = controller.isViewLoaded ? controller.view.bounds.size : [UIScreen mainScreen].bounds.size;
+    CGFloat scale = [UIScreen mainScreen].scale;
+    return (NSUInteger)(size.width * scale * size.height * scale * 4);
+}
+
+#pragma mark - Preloaded controllers
+
+- (SXViewController *) controllerForResource:(NSString *)resource
+{
+    if (!resource)
+        return nil;
+
+    SXViewController *controller = [self.controllers objectForKey:resource];
+    if (controller) {
+        [self.resources removeObject:resource];
+        [self.resources addObject:resource];
+    }
+    return controller;
+}
+
+- (SXViewController *) takeControllerForResource:(NSString *)resource
+{
+    if (!resource)
+        return nil;
+
+    SXViewController *controller = [self.controllers objectForKey:resource];
+    if (controller) {
+        self.totalCost -= [[self.costs objectForKey:resource] unsignedIntegerValue];
+        [self.controllers removeObjectForKey:resource];
+        [self.costs removeObjectForKey:resource];
+        [self.resources removeObject:resource];
+    }
+    return controller;
+}
+
+- (void) setController:(SXViewController *)controller forResource:(NSString *)resource
+{
+    if (!controller || !resource)
+        return;
+
+    if ([self.controllers objectForKey:resource])
+        [self evictResource:resource];
+
+    // Make room first, so the new controller is never the one evicted
+    NSUInteger cost = [self costOfController:controller];
+    [self evictToCount:self.maxCount ? self.maxCount - 1 : 0 cost:self.maxCost > cost ? self.maxCost - cost : 0];
+    if (!self.maxCount) {
+        [controller prepareForReuse];
+        if (self.recycled.count < PRELOAD_POOL_RECYCLE_COUNT)
+            [self.recycled addObject:controller];
+        else
+            [controller.scoreflexView close];
+        return;
+    }
+
+    [self.controllers setObject:controller forKey:resource];
+    [self.costs setObject:[NSNumber numberWithUnsignedInteger:cost] forKey:resource];
+    [self.resources addObject:resource];
+    self.totalCost += cost;
+}
+
+- (void) removeControllerForResource:(NSString *)resource
+{
+    if (resource && [self.controllers objectForKey:resource])
+        [self evictResource:resource];
+}
+
+- (void) removeAllControllers
+{
+    [self evictToCount:0 cost:0];
+}
+
+- (void) handleMemoryWarning
+{
+    if (!self.controllers.count && !self.recycled.count)
+        return;
+
+    SXLog(@"Memory warning, evicting %lu preloaded resources", (unsigned long)self.controllers.count);
+    [self removeAllControllers];
+
+    // A recycled web view keeps its content and memory until it is closed
+    for (SXViewController *controller in self.recycled)
+        [controller.scoreflexView close];
+    [self.recycled removeAllObjects];
+}
+
+#pragma mark - Eviction
+
+- (void) evictToCount:(NSUInteger)count cost:(NSUInteger)cost
+{
+    while (self.resources.count && (self.resources.count > count || (self.maxCost && self.totalCost > cost)))
+        [self evictResource:[self.resources objectAtIndex:0]];
+}
+
+- (void) evictResource:(NSString *)resource
+{
+    SXViewController *controller = [self takeControllerForResource:resource];
+    if (!controller)
+        return;
+
+    SXLog(@"Evicting preloaded resource %@", resource);
+
+    // Keep the web view for the next resource rather than reallocating one
+    if (self.recycled.count < PRELOAD_POOL_RECYCLE_COUNT) {
+        [controller prepareForReuse];
+        [self.recycled addObject:controller];
+    } else {
+        [controller.scoreflexView close];
+    }
+}
+
+#pragma mark - Recycling
+
+- (SXViewController *) dequeueReusableController
+{
+    SXViewController *controller = [self.recycled lastObject];
+    if (controller) {
+        [self.recycled removeLastObject];
+        return controller;
+    }
+    return [[SXViewController alloc] initWithNibName:@"SXViewController" bundle:[Scoreflex bundle]];
+}
+
+@end
@@ -0,0 +1,82 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ SXPreloadPredictor learns how players move between Scoreflex resources, as a table of transition counts between
+ resources, and predicts the next resource to preload.
+
+ The table is kept small: at most `PREDICTOR_MAX_STATES` source resources with `PREDICTOR_MAX_SUCCESSORS` successors
+ each, and counts are halved when they reach `PREDICTOR_MAX_COUNT` so that the table follows changes of habits. It is
+ persisted in the `NSUserDefaults`, with the precision and recall of the predictions.
+ */
+@interface SXPreloadPredictor : NSObject
+
+/**
+ The shared predictor
+ */
++ (SXPreloadPredictor *) sharedPredictor;
+
+/**
+ Records that the given resource was opened, as a transition from the previously opened resource.
+ */
+- (void) recordVisit:(NSString *)resource;
+
+/**
+ Returns the most likely resource opened after the given one, or nil if no resource is likely enough: it must have
+ been opened at least `PREDICTOR_MIN_COUNT` times after it, in at least `PREDICTOR_MIN_PROBABILITY` of the cases.
+ */
+- (NSString *) predictedResourceAfter:(NSString *)resource;
+
+/**
+ Records that the given resource was preloaded in anticipation of the next visit, which will count as a hit or a miss.
+ */
+- (void) recordPrediction:(NSString *)resource;
+
+///---------------------
+/// @name Statistics
+///---------------------
+
+/// The number of predictions made
+@property (readonly) NSUInteger predictions;
+
+/// The number of predictions that matched the next visit
+@property (readonly) NSUInteger hits;
+
+/// The number of transitions between resources recorded since the statistics were reset
+@property (readonly) NSUInteger transitions;
+
+/// The ratio of predictions that matched the next visit, or 0 if no prediction was made
+@property (readonly) double precision;
+
+/// The ratio of transitions that were predicted, or 0 if no transition was recorded
+@property (readonly) double recall;
+
+/**
+ Returns the statistics as a dictionary, to be logged or reported.
+ */
+- (NSDictionary *) statistics;
+
+/**
+ Forgets every transition and statistic.
+ */
+- (void) reset;
+
+@end
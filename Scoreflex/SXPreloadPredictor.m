@@ -0,0 +1,242 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXPreloadPredictor.h"
+
+#define PREDICTOR_TRANSITIONS_KEY @"transitions"
+#define PREDICTOR_STATISTICS_KEY @"statistics"
+#define PREDICTOR_PREDICTIONS_KEY @"predictions"
+#define PREDICTOR_HITS_KEY @"hits"
+#define PREDICTOR_TRANSITION_COUNT_KEY @"transitionCount"
+
+@interface SXPreloadPredictor ()
+
+/// resource => next resource => NSNumber, the number of transitions
+@property (strong, nonatomic) NSMutableDictionary *table;
+
+/// The resource opened last, not persisted
+@property (strong, nonatomic) NSString *lastResource;
+
+/// The resource preloaded for the next visit, not persisted
+@property (strong, nonatomic) NSString *prediction;
+
+@property (assign) NSUInteger predictions;
+@property (assign) NSUInteger hits;
+@property (assign) NSUInteger transitions;
+
+- (void) recordTransitionFrom:(NSString *)from to:(NSString *)to;
+
+- (void) save;
+
+@end
+
+@implementation SXPreloadPredictor
+
++ (SXPreloadPredictor *) sharedPredictor
+{
+    static SXPreloadPredictor *sharedPredictor = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedPredictor = [[SXPreloadPredictor alloc] init];
+    });
+    return sharedPredictor;
+}
+
+- (id) init
+{
+    if (self = [super init]) {
+        NSDictionary *saved = [[NSUserDefaults standardUserDefaults] dictionaryForKey:USER_DEFAULTS_PRELOAD_PREDICTOR_KEY];
+
+        self.table = [NSMutableDictionary dictionary];
+        NSDictionary *transitions = [saved objectForKey:PREDICTOR_TRANSITIONS_KEY];
+        for (NSString *resource in transitions)
+            [self.table setObject:[[transitions objectForKey:resource] mutableCopy] forKey:resource];
+
+        NSDictionary *statistics = [saved objectForKey:PREDICTOR_STATISTICS_KEY];
+        self.predictions = [[statistics objectForKey:PREDICTOR_PREDICTIONS_KEY] unsignedIntegerValue];
+        self.hits = [[statistics objectForKey:PREDICTOR_HITS_KEY] unsignedIntegerValue];
+        self.transitions = [[statistics objectForKey:PREDICTOR_TRANSITION_COUNT_KEY] unsignedIntegerValue];
+    }
+    return self;
+}
+
+#pragma mark - Transitions
+
+- (void) recordVisit:(NSString *)resource
+{
+    if (!resource)
+        return;
+
+    @synchronized(self) {
+        // Reloads are not transitions
+        if ([resource isEqualToString:self.lastResource])
+            return;
+
+        if (self.lastResource) {
+            self.transitions++;
+            if (self.prediction && [self.prediction isEqualToString:resource])
+                self.hits++;
+            [self recordTransitionFrom:self.lastResource to:resource];
+        }
+
+        self.lastResource = resource;
+        self.prediction = nil;
+        [self save];
+    }
+}
+
+- (void) recordTransitionFrom:(NSString *)from to:(NSString *)to
+{
+    NSMutableDictionary *successors = [self.table objectForKey:from];
+    if (!successors) {
+        // Make room by forgetting the least visited resource
+        if (self.table.count >= PREDICTOR_MAX_STATES) {
+            NSString *leastVisited = nil;
+            NSUInteger leastTotal = NSUIntegerMax;
+            for (NSString *resource in self.table) {
+                NSUInteger total = 0;
+                for (NSNumber *count in [[self.table objectForKey:resource] allValues])
+                    total += count.unsignedIntegerValue;
+                if (total < leastTotal) {
+                    leastTotal = total;
+                    leastVisited = resource;
+                }
+            }
+            [self.table removeObjectForKey:leastVisited];
+        }
+        successors = [NSMutableDictionary dictionary];
+        [self.table setObject:successors forKey:from];
+    }
+
+    NSUInteger count = [[successors objectForKey:to] unsignedIntegerValue] + 1;
+    [successors setObject:[NSNumber numberWithUnsignedInteger:count] forKey:to];
+
+    // Age the counts so that recent habits win
+    if (count >= PREDICTOR_MAX_COUNT) {
+        for (NSString *resource in successors.allKeys) {
+            NSUInteger halved = [[successors objectForKey:resource] unsignedIntegerValue] / 2;
+            if (halved)
+                [successors setObject:[NSNumber numberWithUnsignedInteger:halved] forKey:resource];
+            else
+                [successors removeObjectForKey:resource];
+        }
+    }
+
+    // Forget the least frequent successor, other than the one just recorded
+    if (successors.count > PREDICTOR_MAX_SUCCESSORS) {
+        NSString *leastFrequent = nil;
+        for (NSString *resource in successors) {
+            if ([resource isEqualToString:to])
+                continue;
+            if (!leastFrequent || [[successors objectForKey:resource] compare:[successors objectForKey:leastFrequent]] == NSOrderedAscending)
+                leastFrequent = resource;
+        }
+        [successors removeObjectForKey:leastFrequent];
+    }
+}
+
+- (NSString *) predictedResourceAfter:(NSString *)resource
+{
+    if (!resource)
+        return nil;
+
+    @synchronized(self) {
+        NSDictionary *successors = [self.table objectForKey:resource];
+        NSString *best = nil;
+        NSUInteger bestCount = 0;
+        NSUInteger total = 0;
+        for (NSString *next in successors) {
+            NSUInteger count = [[successors objectForKey:next] unsignedIntegerValue];
+            total += count;
+            if (count > bestCount) {
+                bestCount = count;
+                best = next;
+            }
+        }
+
+        if (bestCount < PREDICTOR_MIN_COUNT || (double)bestCount / total < PREDICTOR_MIN_PROBABILITY)
+            return nil;
+        return best;
+    }
+}
+
+- (void) recordPrediction:(NSString *)resource
+{
+    @synchronized(self) {
+        self.prediction = resource;
+        self.predictions++;
+        [self save];
+    }
+}
+
+#pragma mark - Statistics
+
+- (double) precision
+{
+    @synchronized(self) {
+        return self.predictions ? (double)self.hits / self.predictions : 0;
+    }
+}
+
+- (double) recall
+{
+    @synchronized(self) {
+        return self.transitions ? (double)self.hits / self.transitions : 0;
+    }
+}
+
+- (NSDictionary *) statistics
+{
+    @synchronized(self) {
+        return @{PREDICTOR_PREDICTIONS_KEY: [NSNumber numberWithUnsignedInteger:self.predictions],
+                 PREDICTOR_HITS_KEY: [NSNumber numberWithUnsignedInteger:self.hits],
+                 PREDICTOR_TRANSITION_COUNT_KEY: [NSNumber numberWithUnsignedInteger:self.transitions],
+                 @"precision": [NSNumber numberWithDouble:self.precision],
+                 @"recall": [NSNumber numberWithDouble:self.recall]};
+    }
+}
+
+#pragma mark - Persistence
+
+- (void) save
+{
+    NSUserDefaults *userDefaults = [NSUserDefaults standardUserDefaults];
+    [userDefaults setObject:@{PREDICTOR_TRANSITIONS_KEY: self.table,
+                              PREDICTOR_STATISTICS_KEY: @{PREDICTOR_PREDICTIONS_KEY: [NSNumber numberWithUnsignedInteger:self.predictions],
+                                                          PREDICTOR_HITS_KEY: [NSNumber numberWithUnsignedInteger:self.hits],
+                                                          PREDICTOR_TRANSITION_COUNT_KEY: [NSNumber numberWithUnsignedInteger:self.transitions]}}
+                     forKey:USER_DEFAULTS_PRELOAD_PREDICTOR_KEY];
+    [userDefaults synchronize];
+}
+
+- (void) reset
+{
+    @synchronized(self) {
+        [self.table removeAllObjects];
+        self.lastResource = nil;
+        self.prediction = nil;
+        self.predictions = 0;
+        self.hits = 0;
+        self.transitions = 0;
+        [[NSUserDefaults standardUserDefaults] removeObjectForKey:USER_DEFAULTS_PRELOAD_PREDICTOR_KEY];
+        [[NSUserDefaults standardUserDefaults] synchronize];
+    }
+}
+
+@end
@@ -0,0 +1,150 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import <Foundation/Foundation.h>
+#import "SXResponse.h"
+#import "SXCancellationToken.h"
+
+/**
+ SXPromise is the eventual result of an asynchronous call, such as a request to the Scoreflex API.
+
+ A promise is pending until it is either fulfilled with a value (an `SXResponse` for API requests) or rejected
+ with an error. It settles only once. Callbacks always run on the main queue.
+
+ Promises compose, so that independent requests run in parallel and dependent ones are chained without nesting
+ handlers:
+
+     SXPromise *me = [Scoreflex get:@"players/me" params:nil handler:nil];
+     SXPromise *best = [Scoreflex get:@"scores/level1/best" params:nil handler:nil];
+     [[[SXPromise all:@[me, best]] timeout:10] done:^(id values, NSError *error) {
+         ...
+     }];
+ */
+@interface SXPromise : NSObject
+
+///---------------------
+/// @name Creating promises
+///---------------------
+
+/**
+ Returns a promise already fulfilled with the given value.
+ */
++ (SXPromise *) promiseWithValue:(id)value;
+
+/**
+ Returns a promise already rejected with the given error.
+ */
++ (SXPromise *) promiseWithError:(NSError *)error;
+
+/**
+ Returns a request handler settling the promise: rejected if the request fails, fulfilled with the response
+ otherwise. The given handler, if any, is called first.
+ @param handler The handler of the request, may be nil
+ */
+- (void(^)(SXResponse *response, NSError *error)) resolverWithHandler:(void(^)(SXResponse *response, NSError *error))handler;
+
+///---------------------
+/// @name Settling
+///---------------------
+
+/**
+ Fulfills the promise with the given value. Does nothing if the promise is already settled.
+ */
+- (void) fulfill:(id)value;
+
+/**
+ Rejects the promise with the given error. Does nothing if the promise is already settled.
+ */
+- (void) reject:(NSError *)error;
+
+/**
+ The token of the work behind the promise, if it can be cancelled. The promise is rejected when the token is cancelled.
+ */
+@property (strong, nonatomic) SXCancellationToken *cancellationToken;
+
+/**
+ Cancels the work behind the promise and rejects it with an `NSURLErrorCancelled` error.
+ */
+- (void) cancel;
+
+///---------------------
+/// @name State
+///---------------------
+
+@property (readonly) BOOL isPending;
+@property (readonly) BOOL isFulfilled;
+@property (readonly) BOOL isRejected;
+
+/// The value of a fulfilled promise
+@property (readonly) id value;
+
+/// The error of a rejected promise
+@property (readonly) NSError *error;
+
+///---------------------
+/// @name Chaining
+///---------------------
+
+/**
+ Calls the given block on the main queue once the promise is settled.
+ @return The receiver
+ */
+- (SXPromise *) done:(void(^)(id value, NSError *error))block;
+
+/**
+ Chains a step run with the value of the promise once it is fulfilled. The block may return an `SXPromise` to
+ wait for, an `NSError` to reject the returned promise, or any other value to fulfill it.
+ A rejection skips the block and is passed along.
+ @return A promise of the result of the block
+ */
+- (SXPromise *) then:(id(^)(id value))block;
+
+/**
+ Chains a step run with the error of the promise once it is rejected, with the same return rules as `then:`.
+ A fulfilled value skips the block and is passed along.
+ @return A promise of the result of the block
+ */
+- (SXPromise *) failed:(id(^)(NSError *error))block;
+
+/**
+ Returns a promise rejected with an `SXErrorRequestTimedOut` error if the receiver is still pending after the
+ given interval, and settled like the receiver otherwise. The work behind the receiver is not cancelled.
+ @param timeout The interval, in seconds
+ */
+- (SXPromise *) timeout:(NSTimeInterval)timeout;
+
+///---------------------
+/// @name Combining
+///---------------------
+
+/**
+ Returns a promise fulfilled with the values of all the given promises, in the same order, once they are all
+ fulfilled. It is rejected as soon as one of them is rejected. `NSNull` stands for nil values.
+ @param promises An array of `SXPromise`
+ */
++ (SXPromise *) all:(NSArray *)promises;
+
+/**
+ Returns a promise fulfilled with the value of the first of the given promises to be fulfilled. It is rejected
+ with the last error if they are all rejected, or with an `SXErrorInvalidParameter` error if there are none.
+ @param promises An array of `SXPromise`
+ */
++ (SXPromise *) any:(NSArray *)promises;
+
+@end
@@ -0,0 +1,270 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXPromise.h"
+#import "SXUtil.h"
+
+typedef enum {
+    SXPromiseStatePending,
+    SXPromiseStateFulfilled,
+    SXPromiseStateRejected,
+} SXPromiseState;
+
+@interface SXPromise ()
+
+@property (assign) SXPromiseState state;
+
+@property (strong) id value;
+
+@property (strong) NSError *error;
+
+/// Blocks waiting for the promise to settle
+@property (strong, nonatomic) NSMutableArray *callbacks;
+
+- (void) settleWithState:(SXPromiseState)state value:(id)value error:(NSError *)error;
+
+/**
+ Settles the promise with the result of a chained block, as described in `then:`.
+ */
+- (void) resolve:(id)result;
+
+@end
+
+@implementation SXPromise
+
+- (id) init
+{
+    if (self = [super init]) {
+        self.callbacks = [[NSMutableArray alloc] init];
+    }
+    return self;
+}
+
++ (SXPromise *) promiseWithValue:(id)value
+{
+    SXPromise *promise = [[SXPromise alloc] init];
+    [promise fulfill:value];
+    return promise;
+}
+
++ (SXPromise *) promiseWithError:(NSError *)error
+{
+    SXPromise *promise = [[SXPromise alloc] init];
+    [promise reject:error];
+    return promise;
+}
+
+- (void(^)(SXResponse *response, NSError *error)) resolverWithHandler:(void(^)(SXResponse *response, NSError *error))handler
+{
+    return ^(SXResponse *response, NSError *error) {
+        if (handler)
+            handler(response, error);
+
+        if (error)
+            [self reject:error];
+        else
+            [self fulfill:response];
+    };
+}
+
+#pragma mark - Settling
+
+- (void) fulfill:(id)value
+{
+    [self settleWithState:SXPromiseStateFulfilled value:value error:nil];
+}
+
+- (void) reject:(NSError *)error
+{
+    [self settleWithState:SXPromiseStateRejected value:nil error:error];
+}
+
+- (void) settleWithState:(SXPromiseState)state value:(id)value error:(NSError *)error
+{
+    NSArray *callbacks = nil;
+    @synchronized(self) {
+        if (SXPromiseStatePending != self.state)
+            return;
+        self.value = value;
+        self.error = error;
+        self.state = state;
+        callbacks = self.callbacks;
+        self.callbacks = nil;
+    }
+
+    for (dispatch_block_t callback in callbacks)
+        dispatch_async(dispatch_get_main_queue(), callback);
+}
+
+- (void) resolve:(id)result
+{
+    if ([result isKindOfClass:[SXPromise class]]) {
+        [(SXPromise *)result done:^(id value, NSError *error) {
+            [self settleWithState:error ? SXPromiseStateRejected : SXPromiseStateFulfilled value:value error:error];
+        }];
+    } else if ([result isKindOfClass:[NSError class]]) {
+        [self reject:result];
+    } else {
+        [self fulfill:result];
+    }
+}
+
+#pragma mark - Cancellation
+
+- (void) setCancellationToken:(SXCancellationToken *)cancellationToken
+{
+    _cancellationToken = cancellationToken;
+
+    // A cancelled request does not call its handler, settle here
+    __weak SXPromise *weakSelf = self;
+    [cancellationToken addCancellationHandler:^(NSError *error) {
+        [weakSelf reject:error ? error : [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil]];
+    }];
+}
+
+- (void) cancel
+{
+    [self.cancellationToken cancel];
+    [self reject:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil]];
+}
+
+#pragma mark - State
+
+- (BOOL) isPending
+{
+    return SXPromiseStatePending == self.state;
+}
+
+- (BOOL) isFulfilled
+{
+    return SXPromiseStateFulfilled == self.state;
+}
+
+- (BOOL) isRejected
+{
+    return SXPromiseStateRejected == self.state;
+}
+
+#pragma mark - Chaining
+
+- (SXPromise *) done:(void(^)(id value, NSError *error))block
+{
+    if (!block)
+        return self;
+
+    dispatch_block_t callback = ^{
+        block(self.value, self.error);
+    };
+
+    @synchronized(self) {
+        if (SXPromiseStatePending == self.state) {
+            [self.callbacks addObject:[callback copy]];
+            return self;
+        }
+    }
+
+    dispatch_async(dispatch_get_main_queue(), callback);
+    return self;
+}
+
+- (SXPromise *) then:(id(^)(id value))block
+{
+    SXPromise *next = [[SXPromise alloc] init];
+    [self done:^(id value, NSError *error) {
+        if (error)
+            [next reject:error];
+        else
+            [next resolve:block ? block(value) : value];
+    }];
+    return next;
+}
+
+- (SXPromise *) failed:(id(^)(NSError *error))block
+{
+    SXPromise *next = [[SXPromise alloc] init];
+    [self done:^(id value, NSError *error) {
+        if (error)
+            [next resolve:block ? block(error) : error];
+        else
+            [next fulfill:value];
+    }];
+    return next;
+}
+
+- (SXPromise *) timeout:(NSTimeInterval)timeout
+{
+    SXPromise *next = [[SXPromise alloc] init];
+    [next resolve:self];
+
+    double delayInSeconds = timeout;
+    dispatch_time_t popTime = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delayInSeconds * NSEC_PER_SEC));
+    dispatch_after(popTime, dispatch_get_main_queue(), ^(void){
+        [next reject:[SXUtil errorWithScoreflexCode:SXErrorRequestTimedOut]];
+    });
+    return next;
+}
+
+#pragma mark - Combining
+
++ (SXPromise *) all:(NSArray *)promises
+{
+    if (!promises.count)
+        return [SXPromise promiseWithValue:@[]];
+
+    // Callbacks all run on the main queue, no locking needed
+    SXPromise *result = [[SXPromise alloc] init];
+    NSMutableArray *values = [NSMutableArray arrayWithCapacity:promises.count];
+    for (NSUInteger i = 0; i < promises.count; i++)
+        [values addObject:[NSNull null]];
+
+    __block NSUInteger remaining = promises.count;
+    [promises enumerateObjectsUsingBlock:^(SXPromise *promise, NSUInteger index, BOOL *stop) {
+        [promise done:^(id value, NSError *error) {
+            if (error) {
+                [result reject:error];
+                return;
+            }
+            if (value)
+                [values replaceObjectAtIndex:index withObject:value];
+            if (0 == --remaining)
+                [result fulfill:[NSArray arrayWithArray:values]];
+        }];
+    }];
+    return result;
+}
+
++ (SXPromise *) any:(NSArray *)promises
+{
+    if (!promises.count)
+        return [SXPromise promiseWithError:[SXUtil errorWithScoreflexCode:SXErrorInvalidParameter]];
+
+    SXPromise *result = [[SXPromise alloc] init];
+    __block NSUInteger remaining = promises.count;
+    for (SXPromise *promise in promises) {
+        [promise done:^(id value, NSError *error) {
+            if (!error)
+                [result fulfill:value];
+            else if (0 == --remaining)
+                [result reject:error];
+        }];
+    }
+    return result;
+}
+
+@end
@@ -19,6 +19,8 @@
 
 #import <Foundation/Foundation.h>
 #import "SXResponse.h"
+#import "SXMetrics.h"
+#import "SXCancellationToken.h"
 
 typedef void(^SXRequestHandler)(SXResponse *response, NSError *error);
 
@@ -38,6 +40,44 @@ typedef void(^SXRequestHandler)(SXResponse *response, NSError *error);
 @property (strong, nonatomic) NSString *resource;
 @property (strong, nonatomic) SXRequestHandler handler;
 @property (strong, nonatomic) NSDictionary *params;
+
+/// The parameters as set, without those added by the SDK when the request is sent (language, location, sid...)
+@property (readonly, nonatomic) NSDictionary *rawParams;
 @property (strong, nonatomic) NSString *method;
 @property (readonly) NSString *requestId;
+
+/// The number of times this request has been tried by the request vault
+@property (assign, nonatomic) NSUInteger attemptCount;
+
+/// The time at which this request was first added to the request vault, since 1970
+@property (assign, nonatomic) NSTimeInterval enqueuedAt;
+
+/// The phase timings of the current run, when `SXMetrics` is enabled. Not copied nor archived.
+@property (strong, nonatomic) SXRequestTimeline *timeline;
+
+/**
+ The queue the handler is called on. If `NULL` (default), the callback queue of `SXClient` is used. Copied but not archived.
+ */
+@property (nonatomic, assign) dispatch_queue_t callbackQueue;
+
+/// The token cancelling this request, shared with its copies. Not archived.
+@property (readonly) SXCancellationToken *cancellationToken;
+
+/**
+ The date after which the request is abandoned and its handler called with an `SXErrorRequestTimedOut` error,
+ or nil for no deadline. This is the deadline of the `cancellationToken`. Not archived.
+ */
+@property (strong, nonatomic) NSDate *deadline;
+
+/**
+ Sets the deadline to the given interval from now.
+ @param timeout The time allowed to the request, including waiting for an access token and retries
+ */
+- (void) setTimeout:(NSTimeInterval)timeout;
+
+/**
+ Cancels the request and its copies wherever they are: waiting for an access token, waiting in the request
+ vault or running. The handler is not called and is released.
+ */
+- (void) cancel;
 @end
@@ -27,6 +27,8 @@
 
 @property (nonatomic, strong) NSString *requestId;
 
+@property (strong) SXCancellationToken *cancellationToken;
+
 @property (readonly) NSDictionary *decoratedParams;
 
 + (NSDictionary *)addParameterIfNotPresent:(NSString *)name value:(NSString *)value toParameters:(NSDictionary *)params;
@@ -39,6 +41,7 @@
 {
     if (self = [super init]) {
         self.requestId = [SXUtil UUIDString];
+        self.cancellationToken = [[SXCancellationToken alloc] init];
     }
     return self;
 }
@@ -49,9 +52,23 @@
     copy.handler = self.handler;
     copy.resource = self.resource;
     copy.params = [self.params copy];
+    copy.attemptCount = self.attemptCount;
+    copy.enqueuedAt = self.enqueuedAt;
+    copy.cancellationToken = self.cancellationToken;
+    copy.callbackQueue = self.callbackQueue;
     return copy;
 }
 
+- (void) dealloc
+{
+    if (_callbackQueue) {
+#if !OS_OBJECT_USE_OBJC
+        dispatch_release(_callbackQueue);
+#endif
+        _callbackQueue = NULL;
+    }
+}
+
 - (NSString *)description
 {
     return [NSString stringWithFormat:@"<SXRequest method=%@ resource=%@ params=%@", self.method, self.resource, self.params];
@@ -89,6 +106,49 @@
     return self;
 }
 
+#pragma mark - Callback queue
+
+- (void) setCallbackQueue:(dispatch_queue_t)callbackQueue
+{
+    if (callbackQueue != _callbackQueue) {
+        if (_callbackQueue) {
+#if !OS_OBJECT_USE_OBJC
+            dispatch_release(_callbackQueue);
+#endif
+            _callbackQueue = NULL;
+        }
+
+        if (callbackQueue) {
+#if !OS_OBJECT_USE_OBJC
+            dispatch_retain(callbackQueue);
+#endif
+            _callbackQueue = callbackQueue;
+        }
+    }
+}
+
+#pragma mark - Cancellation
+
+- (NSDate *) deadline
+{
+    return self.cancellationToken.deadline;
+}
+
+- (void) setDeadline:(NSDate *)deadline
+{
+    self.cancellationToken.deadline = deadline;
+}
+
+- (void) setTimeout:(NSTimeInterval)timeout
+{
+    self.deadline = [NSDate dateWithTimeIntervalSinceNow:timeout];
+}
+
+- (void) cancel
+{
+    [self.cancellationToken cancel];
+}
+
 #pragma mark - Parameters
 
 - (NSDictionary *)params
@@ -96,6 +156,11 @@
     return self.decoratedParams;
 }
 
+- (NSDictionary *)rawParams
+{
+    return _params;
+}
+
 - (NSDictionary *)decoratedParams
 {
     NSDictionary *params = _params;
@@ -0,0 +1,67 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import <Foundation/Foundation.h>
+#import "SXRequest.h"
+
+/**
+ The current version of the compact request record format.
+ */
+extern uint8_t const SXRequestCodecVersion;
+
+/**
+ SXRequestCodec serializes `SXRequest` objects to a compact binary record, used by the request vault
+ instead of `NSKeyedArchiver`.
+
+ A record is laid out as follows, all integers being little endian:
+
+ - magic `SX` (2 bytes)
+ - format version (1 byte)
+ - payload length (4 bytes)
+ - CRC32 of the payload (4 bytes)
+ - payload: request id, method, attempt count, enqueue time, resource and params
+
+ Strings are stored as a varint length followed by their UTF-8 bytes. The request id comes first in the
+ payload so it can be read without decoding the rest of the record.
+ */
+@interface SXRequestCodec : NSObject
+
+/**
+ Returns the compact record for the given request.
+ @param request The request to encode
+ */
++ (NSData *) dataWithRequest:(SXRequest *)request;
+
+/**
+ Decodes a record produced by `dataWithRequest:`. Data archived with `NSKeyedArchiver` by previous
+ versions of the SDK is also accepted.
+ @param data The record
+ @return The decoded request, or nil if the record is truncated or corrupted.
+ */
++ (SXRequest *) requestWithData:(NSData *)data;
+
+/**
+ Returns YES if the given record holds the request with the given identifier. Only the record header
+ and request id are read.
+ @param data The record
+ @param requestId The request identifier
+ */
++ (BOOL) data:(NSData *)data hasRequestId:(NSString *)requestId;
+
+@end
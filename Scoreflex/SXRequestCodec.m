@@ -0,0 +1,442 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXRequestCodec.h"
+
+uint8_t const SXRequestCodecVersion = 1;
+
+#define SX_RECORD_MAGIC_0 'S'
+#define SX_RECORD_MAGIC_1 'X'
+#define SX_RECORD_HEADER_LENGTH 11
+
+typedef enum {
+    SXRecordMethodNone = 0,
+    SXRecordMethodGet = 1,
+    SXRecordMethodPost = 2,
+    SXRecordMethodDelete = 3,
+    SXRecordMethodPut = 4,
+    SXRecordMethodOther = 0xFF,
+} SXRecordMethod;
+
+typedef enum {
+    SXRecordValueNull = 0,
+    SXRecordValueString = 1,
+    SXRecordValueInteger = 2,
+    SXRecordValueDouble = 3,
+    SXRecordValueBool = 4,
+    SXRecordValueDictionary = 5,
+    SXRecordValueArray = 6,
+    SXRecordValueArchived = 7,
+} SXRecordValueType;
+
+#pragma mark - CRC32
+
+static uint32_t SXCRC32(const uint8_t *bytes, NSUInteger length)
+{
+    static uint32_t table[256];
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+    });
+
+    uint32_t crc = 0xFFFFFFFF;
+    for (NSUInteger i = 0; i < length; i++)
+        crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFF;
+}
+
+#pragma mark - Writing
+
+static void SXWriteByte(NSMutableData *data, uint8_t byte)
+{
+    [data appendBytes:&byte length:1];
+}
+
+static void SXWriteVarint(NSMutableData *data, uint64_t value)
+{
+    uint8_t buffer[10];
+    NSUInteger length = 0;
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        buffer[length++] = value ? (byte | 0x80) : byte;
+    } while (value);
+    [data appendBytes:buffer length:length];
+}
+
+// nil strings are written with a length of 0, other strings with their length + 1
+static void SXWriteString(NSMutableData *data, NSString *string)
+{
+    if (!string) {
+        SXWriteVarint(data, 0);
+        return;
+    }
+    NSUInteger length = [string lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    SXWriteVarint(data, length + 1);
+    NSUInteger offset = data.length;
+    [data increaseLengthBy:length];
+    [string getBytes:(uint8_t *)data.mutableBytes + offset maxLength:length usedLength:NULL encoding:NSUTF8StringEncoding options:0 range:NSMakeRange(0, string.length) remainingRange:NULL];
+}
+
+static void SXWriteValue(NSMutableData *data, id value)
+{
+    if (!value || [value isKindOfClass:[NSNull class]]) {
+        SXWriteByte(data, SXRecordValueNull);
+    } else if ([value isKindOfClass:[NSString class]]) {
+        SXWriteByte(data, SXRecordValueString);
+        SXWriteString(data, value);
+    } else if ([value isKindOfClass:[NSNumber class]]) {
+        const char *type = [value objCType];
+        if (CFGetTypeID((__bridge CFTypeRef)value) == CFBooleanGetTypeID()) {
+            SXWriteByte(data, SXRecordValueBool);
+            SXWriteByte(data, [value boolValue] ? 1 : 0);
+        } else if (0 == strcmp(type, @encode(double)) || 0 == strcmp(type, @encode(float))) {
+            SXWriteByte(data, SXRecordValueDouble);
+            CFSwappedFloat64 swapped = CFConvertDoubleHostToSwapped([value doubleValue]);
+            [data appendBytes:&swapped length:sizeof(swapped)];
+        } else {
+            // Zigzag encoding keeps small negative numbers small
+            int64_t integer = [value longLongValue];
+            SXWriteByte(data, SXRecordValueInteger);
+            SXWriteVarint(data, ((uint64_t)integer << 1) ^ (uint64_t)(integer >> 63));
+        }
+    } else if ([value isKindOfClass:[NSDictionary class]]) {
+        SXWriteByte(data, SXRecordValueDictionary);
+        SXWriteVarint(data, [value count]);
+        [value enumerateKeysAndObjectsUsingBlock:^(id key, id object, BOOL *stop) {
+            SXWriteValue(data, key);
+            SXWriteValue(data, object);
+        }];
+    } else if ([value isKindOfClass:[NSArray class]]) {
+        SXWriteByte(data, SXRecordValueArray);
+        SXWriteVarint(data, [value count]);
+        for (id object in value)
+            SXWriteValue(data, object);
+    } else {
+        // Anything else goes through the archiver
+        NSData *archive = [NSKeyedArchiver archivedDataWithRootObject:value];
+        SXWriteByte(data, SXRecordValueArchived);
+        SXWriteVarint(data, archive.length);
+        [data appendData:archive];
+    }
+}
+
+static SXRecordMethod SXRecordMethodForString(NSString *method)
+{
+    if (!method)
+        return SXRecordMethodNone;
+
+    NSString *uppercase = method.uppercaseString;
+    if ([@"GET" isEqualToString:uppercase])
+        return SXRecordMethodGet;
+    if ([@"POST" isEqualToString:uppercase])
+        return SXRecordMethodPost;
+    if ([@"DELETE" isEqualToString:uppercase])
+        return SXRecordMethodDelete;
+    if ([@"PUT" isEqualToString:uppercase])
+        return SXRecordMethodPut;
+    return SXRecordMethodOther;
+}
+
+#pragma mark - Reading
+
+typedef struct {
+    const uint8_t *bytes;
+    NSUInteger length;
+    NSUInteger offset;
+    BOOL failed;
+} SXRecordReader;
+
+static uint8_t SXReadByte(SXRecordReader *reader)
+{
+    if (reader->failed || reader->offset >= reader->length) {
+        reader->failed = YES;
+        return 0;
+    }
+    return reader->bytes[reader->offset++];
+}
+
+static uint64_t SXReadVarint(SXRecordReader *reader)
+{
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t byte = SXReadByte(reader);
+        if (reader->failed)
+            return 0;
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return result;
+    }
+    reader->failed = YES;
+    return 0;
+}
+
+static const uint8_t *SXReadBytes(SXRecordReader *reader, uint64_t length)
+{
+    if (reader->failed || length > reader->length - reader->offset) {
+        reader->failed = YES;
+        return NULL;
+    }
+    const uint8_t *result = reader->bytes + reader->offset;
+    reader->offset += (NSUInteger)length;
+    return result;
+}
+
+static NSString *SXReadString(SXRecordReader *reader)
+{
+    uint64_t length = SXReadVarint(reader);
+    if (reader->failed || 0 == length)
+        return nil;
+
+    const uint8_t *bytes = SXReadBytes(reader, length - 1);
+    if (!bytes)
+        return nil;
+    return [[NSString alloc] initWithBytes:bytes length:(NSUInteger)(length - 1) encoding:NSUTF8StringEncoding];
+}
+
+static id SXReadValue(SXRecordReader *reader)
+{
+    uint8_t type = SXReadByte(reader);
+    if (reader->failed)
+        return nil;
+
+    switch (type) {
+        case SXRecordValueNull:
+            return [NSNull null];
+
+        case SXRecordValueString:
+            return SXReadString(reader);
+
+        case SXRecordValueInteger: {
+            uint64_t zigzag = SXReadVarint(reader);
+            return [NSNumber numberWithLongLong:(int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1)];
+        }
+
+        case SXRecordValueDouble: {
+            const uint8_t *bytes = SXReadBytes(reader, sizeof(CFSwappedFloat64));
+            if (!bytes)
+                return nil;
+            CFSwappedFloat64 swapped;
+            memcpy(&swapped, bytes, sizeof(swapped));
+            return [NSNumber numberWithDouble:CFConvertDoubleSwappedToHost(swapped)];
+        }
+
+        case SXRecordValueBool:
+            return [NSNumber numberWithBool:SXReadByte(reader) != 0];
+
+        case SXRecordValueDictionary: {
+            uint64_t count = SXReadVarint(reader);
+            NSMutableDictionary *result = [NSMutableDictionary dictionaryWithCapacity:(NSUInteger)MIN(count, 64)];
+            for (uint64_t i = 0; i < count && !reader->failed; i++) {
+                id key = SXReadValue(reader);
+                id object = SXReadValue(reader);
+                if (key && object)
+                    [result setObject:object forKey:key];
+            }
+            return [NSDictionary dictionaryWithDictionary:result];
+        }
+
+        case SXRecordValueArray: {
+            uint64_t count = SXReadVarint(reader);
+            NSMutableArray *result = [NSMutableArray arrayWithCapacity:(NSUInteger)MIN(count, 64)];
+            for (uint64_t i = 0; i < count && !reader->failed; i++) {
+                id object = SXReadValue(reader);
+                if (object)
+                    [result addObject:object];
+            }
+            return [NSArray arrayWithArray:result];
+        }
+
+        case SXRecordValueArchived: {
+            uint64_t length = SXReadVarint(reader);
+            const uint8_t *bytes = SXReadBytes(reader, length);
+            if (!bytes)
+                return nil;
+            return [NSKeyedUnarchiver unarchiveObjectWithData:[NSData dataWithBytesNoCopy:(void *)bytes length:(NSUInteger)length freeWhenDone:NO]];
+        }
+
+        default:
+            reader->failed = YES;
+            return nil;
+    }
+}
+
+static NSString *SXStringForRecordMethod(SXRecordMethod method, SXRecordReader *reader)
+{
+    switch (method) {
+        case SXRecordMethodNone:   return nil;
+        case SXRecordMethodGet:    return @"GET";
+        case SXRecordMethodPost:   return @"POST";
+        case SXRecordMethodDelete: return @"DELETE";
+        case SXRecordMethodPut:    return @"PUT";
+        case SXRecordMethodOther:  return SXReadString(reader);
+        default:
+            reader->failed = YES;
+            return nil;
+    }
+}
+
+/**
+ Checks the header and the CRC of the given record and positions the reader at the start of the payload.
+ */
+static BOOL SXOpenRecord(NSData *data, SXRecordReader *reader, BOOL checkCRC)
+{
+    const uint8_t *bytes = data.bytes;
+    if (data.length < SX_RECORD_HEADER_LENGTH || SX_RECORD_MAGIC_0 != bytes[0] || SX_RECORD_MAGIC_1 != bytes[1])
+        return NO;
+
+    if (bytes[2] > SXRequestCodecVersion) {
+        SXLog(@"Unsupported request record version: %i", bytes[2]);
+        return NO;
+    }
+
+    uint32_t length, crc;
+    memcpy(&length, bytes + 3, sizeof(length));
+    memcpy(&crc, bytes + 7, sizeof(crc));
+    length = CFSwapInt32LittleToHost(length);
+    crc = CFSwapInt32LittleToHost(crc);
+
+    if (data.length - SX_RECORD_HEADER_LENGTH != length)
+        return NO;
+
+    if (checkCRC && SXCRC32(bytes + SX_RECORD_HEADER_LENGTH, length) != crc) {
+        SXLog(@"Request record CRC mismatch");
+        return NO;
+    }
+
+    reader->bytes = bytes;
+    reader->length = data.length;
+    reader->offset = SX_RECORD_HEADER_LENGTH;
+    reader->failed = NO;
+    return YES;
+}
+
+static BOOL SXIsRecord(NSData *data)
+{
+    const uint8_t *bytes = data.bytes;
+    return data.length >= 2 && SX_RECORD_MAGIC_0 == bytes[0] && SX_RECORD_MAGIC_1 == bytes[1];
+}
+
+#pragma mark - SXRequestCodec
+
+@implementation SXRequestCodec
+
++ (NSData *) dataWithRequest:(SXRequest *)request
+{
+    NSMutableData *data = [NSMutableData dataWithCapacity:256];
+
+    // Header, length and CRC are filled in once the payload is written
+    uint8_t header[SX_RECORD_HEADER_LENGTH] = {SX_RECORD_MAGIC_0, SX_RECORD_MAGIC_1, SXRequestCodecVersion};
+    [data appendBytes:header length:sizeof(header)];
+
+    SXWriteString(data, request.requestId);
+
+    SXRecordMethod method = SXRecordMethodForString(request.method);
+    SXWriteByte(data, method);
+    if (SXRecordMethodOther == method)
+        SXWriteString(data, request.method);
+
+    SXWriteVarint(data, request.attemptCount);
+    CFSwappedFloat64 enqueuedAt = CFConvertDoubleHostToSwapped(request.enqueuedAt);
+    [data appendBytes:&enqueuedAt length:sizeof(enqueuedAt)];
+
+    SXWriteString(data, request.resource);
+    // Decorations are added again when the request is sent, with the language and location of that time
+    SXWriteValue(data, request.rawParams);
+
+    uint8_t *bytes = data.mutableBytes;
+    uint32_t length = (uint32_t)(data.length - SX_RECORD_HEADER_LENGTH);
+    uint32_t crc = CFSwapInt32HostToLittle(SXCRC32(bytes + SX_RECORD_HEADER_LENGTH, length));
+    length = CFSwapInt32HostToLittle(length);
+    memcpy(bytes + 3, &length, sizeof(length));
+    memcpy(bytes + 7, &crc, sizeof(crc));
+
+    return data;
+}
+
++ (SXRequest *) requestWithData:(NSData *)data
+{
+    if (!data)
+        return nil;
+
+    // Requests saved by previous versions of the SDK
+    if (!SXIsRecord(data)) {
+        id object = [NSKeyedUnarchiver unarchiveObjectWithData:data];
+        return [object isKindOfClass:[SXRequest class]] ? object : nil;
+    }
+
+    SXRecordReader reader;
+    if (!SXOpenRecord(data, &reader, YES))
+        return nil;
+
+    SXRequest *request = [[SXRequest alloc] init];
+    NSString *requestId = SXReadString(&reader);
+    request.method = SXStringForRecordMethod(SXReadByte(&reader), &reader);
+    request.attemptCount = (NSUInteger)SXReadVarint(&reader);
+
+    const uint8_t *enqueuedAt = SXReadBytes(&reader, sizeof(CFSwappedFloat64));
+    if (enqueuedAt) {
+        CFSwappedFloat64 swapped;
+        memcpy(&swapped, enqueuedAt, sizeof(swapped));
+        request.enqueuedAt = CFConvertDoubleSwappedToHost(swapped);
+    }
+
+    request.resource = SXReadString(&reader);
+    id params = SXReadValue(&reader);
+    request.params = [params isKindOfClass:[NSDictionary class]] ? params : nil;
+
+    if (reader.failed || reader.offset != reader.length)
+        return nil;
+
+    [request setValue:requestId forKey:@"requestId"];
+    return request;
+}
+
++ (BOOL) data:(NSData *)data hasRequestId:(NSString *)requestId
+{
+    if (!data || !requestId)
+        return NO;
+
+    if (!SXIsRecord(data))
+        return [[[self requestWithData:data] requestId] isEqualToString:requestId];
+
+    // Compare the UTF-8 bytes in place, the CRC is checked when the record is decoded
+    SXRecordReader reader;
+    if (!SXOpenRecord(data, &reader, NO))
+        return NO;
+
+    uint64_t length = SXReadVarint(&reader);
+    if (reader.failed || 0 == length)
+        return NO;
+
+    const char *expected = requestId.UTF8String;
+    size_t expectedLength = strlen(expected);
+    if (length - 1 != expectedLength)
+        return NO;
+
+    const uint8_t *bytes = SXReadBytes(&reader, expectedLength);
+    return bytes && 0 == memcmp(bytes, expected, expectedLength);
+}
+
+@end
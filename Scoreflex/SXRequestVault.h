@@ -21,14 +21,28 @@
 #import "SXRequest.h"
 #import "SXClient.h"
 
+@class SXPromise;
+
 @interface SXRequestVault : NSObject
 
 @property (nonatomic, weak) SXClient *client;
 
 - (id) initWithClient:(SXClient *)client;
 
+/**
+ Reads the saved requests and decodes them on a background queue. The load is shared until a vault is created
+ and replays them, or until the saved requests change, so the warm-up can start it before the shared client exists.
+ @return A promise of the array of saved `SXRequest`
+ */
++ (SXPromise *) loadSavedRequests;
+
 - (void) add:(SXRequest *)request;
 
+/**
+ Removes the saved requests, so that the next vault created has nothing to replay.
+ */
++ (void) reset;
+
 - (void) reset;
 
 @end
@@ -18,6 +18,9 @@
  */
 
 #import "SXRequestVault.h"
+#import "SXRequestCodec.h"
+#import "SXNetworkPolicy.h"
+#import "SXPromise.h"
 
 #pragma mark - RequestVaultOperation
 @interface SXRequestVaultOperation : NSOperation
@@ -27,19 +30,59 @@
 @property (nonatomic, strong) SXRequest *request;
 @property (weak, nonatomic) SXRequestVault *vault;
 
+/// The registration of the vault's cancellation handler on the token of the request
+@property (strong, nonatomic) id registration;
+
+/// YES once the operation has been run or cancelled
+@property (assign, nonatomic) BOOL claimed;
+
+/**
+ Returns YES the first time it is called: the caller, either `main` or the cancellation handler, owns the request.
+ */
+- (BOOL) claim;
+
 @end
 
 #pragma mark - Request vault
 
+/// The pending or unclaimed load of the saved requests, started by the warm-up or the first vault
+static SXPromise *SavedRequestsLoad = nil;
+
+/// Called when the saved requests change, so that the next vault does not replay a stale load
+static void SXInvalidateSavedRequestsLoad(void)
+{
+    @synchronized([SXRequestVault class]) {
+        SavedRequestsLoad = nil;
+    }
+}
+
+static NSArray *SXDecodeRequestQueue(NSArray *requestQueue)
+{
+    NSMutableArray *result = [NSMutableArray arrayWithCapacity:requestQueue.count];
+    for (NSData *archivedRequestData in requestQueue) {
+        SXRequest *request = [SXRequestCodec requestWithData:archivedRequestData];
+
+        // Corrupted records are dropped
+        if (request)
+            [result addObject:request];
+        else
+            SXLog(@"Skipping unreadable request vault entry");
+    }
+    return result;
+}
+
 @interface SXRequestVault ()
 
 - (void) save:(SXRequest *)request;
 
 - (void) forget:(SXRequest *)request;
 
-- (void) reachabilityNotification:(NSNotification *)notification;
+/**
+ Rewrites the saved record of a request, to keep its attempt count across launches.
+ */
+- (void) update:(SXRequest *)request;
 
-- (void) reachabilityChanged:(AFNetworkReachabilityStatus)status;
+- (void) networkPolicyChanged:(NSNotification *)notification;
 
 - (void) addToQueue:(SXRequest *)request;
 
@@ -57,15 +100,24 @@
         self.client = client;
         self.operationQueue = [[NSOperationQueue alloc] init];
 
-        // Register for reachability notifications
-        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(reachabilityNotification:) name:AFNetworkingReachabilityDidChangeNotification object:nil];
+        // Replay is driven by the network policy, which follows reachability
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(networkPolicyChanged:) name:SX_NOTIFICATION_NETWORK_POLICY_CHANGED object:nil];
 
         // Set initial reachability
-        [self reachabilityChanged:self.client.httpClient.networkReachabilityStatus];
-
-        // Add saved operations to queue
-        for (SXRequest *request in self.savedRequests)
-            [self addToQueue:request];
+        [[SXNetworkPolicy sharedPolicy] updateWithReachabilityStatus:self.client.httpClient.networkReachabilityStatus];
+        [self networkPolicyChanged:nil];
+
+        // Add saved operations to queue once decoded off the main thread. The load holds the records saved
+        // before this point: a load started earlier is dropped as soon as the records change.
+        SXPromise *load = nil;
+        @synchronized([SXRequestVault class]) {
+            load = [SXRequestVault loadSavedRequests];
+            SavedRequestsLoad = nil;
+        }
+        [load done:^(NSArray *requests, NSError *error) {
+            for (SXRequest *request in requests)
+                [self addToQueue:request];
+        }];
     }
     return self;
 }
@@ -83,12 +135,13 @@
         if (!requestQueue)
             requestQueue = @[];
 
-        // Build a new queue by appending the given requested, archived
-        requestQueue = [requestQueue arrayByAddingObject:[NSKeyedArchiver archivedDataWithRootObject:request]];
+        // Build a new queue by appending the given requested, encoded
+        requestQueue = [requestQueue arrayByAddingObject:[SXRequestCodec dataWithRequest:request]];
 
         // Save
         [userDefaults setObject:requestQueue forKey:USER_DEFAULTS_REQUEST_VAULT_QUEUE];
         [userDefaults synchronize];
+        SXInvalidateSavedRequestsLoad();
     }
 }
 
@@ -103,21 +156,47 @@
         if (!requestQueue)
             return;
 
-        NSArray *newRequestQueue = @[];
+        NSMutableArray *newRequestQueue = [NSMutableArray arrayWithCapacity:requestQueue.count];
         for (NSData *archivedRequestData in requestQueue) {
-            SXRequest *archivedRequest = [NSKeyedUnarchiver unarchiveObjectWithData:archivedRequestData];
 
-            // Skip the request to forget
-            if ([request.requestId isEqual:archivedRequest.requestId])
+            // Skip the request to forget, only its request id is read
+            if ([SXRequestCodec data:archivedRequestData hasRequestId:request.requestId])
                 continue;
 
             // Add the archivedRequestData to the new queue
-            newRequestQueue = [newRequestQueue arrayByAddingObject:archivedRequestData];
+            [newRequestQueue addObject:archivedRequestData];
         }
 
         // Save
         [userDefaults setObject:newRequestQueue forKey:USER_DEFAULTS_REQUEST_VAULT_QUEUE];
         [userDefaults synchronize];
+        SXInvalidateSavedRequestsLoad();
+    }
+}
+
+- (void) update:(SXRequest *)request
+{
+    @synchronized(self) {
+        NSUserDefaults *userDefaults = [NSUserDefaults standardUserDefaults];
+
+        NSArray *requestQueue = [userDefaults objectForKey:USER_DEFAULTS_REQUEST_VAULT_QUEUE];
+        if (!requestQueue)
+            return;
+
+        NSMutableArray *newRequestQueue = [NSMutableArray arrayWithArray:requestQueue];
+        for (NSUInteger i = 0; i < newRequestQueue.count; i++) {
+
+            // Only the request id of the records is read
+            if ([SXRequestCodec data:[newRequestQueue objectAtIndex:i] hasRequestId:request.requestId]) {
+                [newRequestQueue replaceObjectAtIndex:i withObject:[SXRequestCodec dataWithRequest:request]];
+                break;
+            }
+        }
+
+        // Save
+        [userDefaults setObject:newRequestQueue forKey:USER_DEFAULTS_REQUEST_VAULT_QUEUE];
+        [userDefaults synchronize];
+        SXInvalidateSavedRequestsLoad();
     }
 }
 
@@ -126,22 +205,41 @@
     NSUserDefaults *userDefaults = [NSUserDefaults standardUserDefaults];
 
     NSArray *requestQueue = [userDefaults objectForKey:USER_DEFAULTS_REQUEST_VAULT_QUEUE];
-    NSArray *result = @[];
-
     if (!requestQueue)
-        return result;
+        return @[];
 
-    for (NSData *archivedRequestData in requestQueue) {
-        result = [result arrayByAddingObject:[NSKeyedUnarchiver unarchiveObjectWithData:archivedRequestData]];
+    return SXDecodeRequestQueue(requestQueue);
+}
+
++ (SXPromise *) loadSavedRequests
+{
+    @synchronized(self) {
+        if (SavedRequestsLoad)
+            return SavedRequestsLoad;
+
+        // The records are read right away, so that requests saved afterwards are not replayed twice,
+        // and only decoded in the background
+        NSArray *requestQueue = [[NSUserDefaults standardUserDefaults] objectForKey:USER_DEFAULTS_REQUEST_VAULT_QUEUE];
+        SXPromise *promise = [[SXPromise alloc] init];
+        SavedRequestsLoad = promise;
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            [promise fulfill:requestQueue ? SXDecodeRequestQueue(requestQueue) : @[]];
+        });
+        return promise;
     }
-    return result;
 }
 
-- (void) reset
++ (void) reset
 {
     NSUserDefaults *userDefaults = [NSUserDefaults standardUserDefaults];
     [userDefaults removeObjectForKey:USER_DEFAULTS_REQUEST_VAULT_QUEUE];
     [userDefaults synchronize];
+    SXInvalidateSavedRequestsLoad();
+}
+
+- (void) reset
+{
+    [[self class] reset];
 }
 
 
@@ -149,6 +247,9 @@
 
 - (void) add:(SXRequest *)request
 {
+    if (!request.enqueuedAt)
+        request.enqueuedAt = [[NSDate date] timeIntervalSince1970];
+
     [self save:request];
     [self addToQueue:request];
 
@@ -160,32 +261,44 @@
 
     SXRequestVaultOperation *operation = [[SXRequestVaultOperation alloc] initWithRequest:request vault:self];
 
-    [self.operationQueue addOperation:operation];
-}
+    // A cancelled request is forgotten, and dropped from the queue if it is not running yet
+    __weak SXRequestVault *weakSelf = self;
+    __weak SXRequestVaultOperation *weakOperation = operation;
+    __weak SXRequest *weakRequest = request;
+    operation.registration = [request.cancellationToken addCancellationHandler:^(NSError *error) {
+        SXRequest *cancelledRequest = weakRequest;
+        if (cancelledRequest)
+            [weakSelf forget:cancelledRequest];
+
+        SXRequestVaultOperation *cancelledOperation = weakOperation;
+        if (![cancelledOperation claim])
+            return;
 
-#pragma mark - Reachability
+        [cancelledOperation cancel];
+        cancelledOperation.request = nil;
 
-- (void) reachabilityNotification:(NSNotification *)notification
-{
-    NSNumber *status = [notification.userInfo valueForKey:AFNetworkingReachabilityNotificationStatusItem];
-    [self reachabilityChanged:status.intValue];
+        // A running request reports its deadline through SXClient
+        if (error)
+            [weakSelf.client callHandlerOfRequest:cancelledRequest response:nil error:error];
+    }];
+    if (operation.isCancelled)
+        return;
+
+    [self.operationQueue addOperation:operation];
 }
 
-- (void) reachabilityChanged:(AFNetworkReachabilityStatus)status
-{
-    switch (status) {
-        case AFNetworkReachabilityStatusNotReachable:
-        case AFNetworkReachabilityStatusUnknown:
-            SXLog(@"Reachability changed to %i, stopping queue.", status);
-            [self.operationQueue setSuspended:YES];
-            break;
+#pragma mark - Network policy
 
-        default:
-            SXLog(@"Reachability changed to %i, starting queue.", status);
-            [self.operationQueue setSuspended:NO];
-            break;
+- (void) networkPolicyChanged:(NSNotification *)notification
+{
+    SXNetworkPolicy *policy = [SXNetworkPolicy sharedPolicy];
+    if (policy.shouldReplayRequests) {
+        SXLog(@"Network class changed to %i, starting queue.", policy.networkClass);
+        [self.operationQueue setSuspended:NO];
+    } else {
+        SXLog(@"Network class changed to %i, stopping queue.", policy.networkClass);
+        [self.operationQueue setSuspended:YES];
     }
-
 }
 
 @end
@@ -204,17 +317,36 @@
     return self;
 }
 
+- (BOOL) claim
+{
+    @synchronized(self) {
+        if (self.claimed)
+            return NO;
+        self.claimed = YES;
+        return YES;
+    }
+}
+
 - (void) main
 {
+    // Cancelled while waiting in the queue
+    if (![self claim])
+        return;
+
+    self.request.attemptCount++;
     SXRequest *requestCopy = [self.request copy];
 
     requestCopy.handler = ^(SXResponse *response, NSError *error) {
 
         SXLog(@"SXRequestVaultOperation complete with response:%@ error:%@", response, error);
 
-        // Handle network errors
-        if (error && [NSURLErrorDomain isEqualToString:error.domain] && error.code <= NSURLErrorBadURL) {
+        [self.request.cancellationToken removeCancellationHandler:self.registration];
+
+        // Handle network errors, unless the request has been cancelled or timed out
+        if (error && [NSURLErrorDomain isEqualToString:error.domain] && error.code <= NSURLErrorBadURL && !self.request.cancellationToken.isCancelled) {
 
+            // Keep the attempt count in the saved record
+            [self.vault update:self.request];
             [self.vault addToQueue:self.request];
 
             return;
@@ -0,0 +1,94 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import <Foundation/Foundation.h>
+#import "Scoreflex.h"
+#import "SXRequest.h"
+
+/**
+ SXScoreIndex keeps, per player and per leaderboard, the best and most recent scores submitted from this device.
+ It is persisted in the `NSUserDefaults`, along with the sort order of the leaderboards, and used to avoid posting scores that cannot change the player's ranking.
+ */
+@interface SXScoreIndex : NSObject
+
+/**
+ The shared score index
+ */
++ (SXScoreIndex *) sharedIndex;
+
+///---------------------
+/// @name Sort order
+///---------------------
+
+- (void) setOrder:(SXScoreOrder)order forLeaderboard:(NSString *)leaderboardId;
+
+- (SXScoreOrder) orderForLeaderboard:(NSString *)leaderboardId;
+
+///---------------------
+/// @name Scores
+///---------------------
+
+/**
+ Returns YES if the score would improve the best score of the player on the leaderboard, without recording it.
+ @param score The score
+ @param playerId The player identifier
+ @param leaderboardId The identifier of the leaderboard
+ */
+- (BOOL) isImprovingScore:(long long)score player:(NSString *)playerId leaderboard:(NSString *)leaderboardId;
+
+/**
+ Records a score and returns YES if it improves the best score of the player on the leaderboard.
+ The first score recorded for a leaderboard always improves it.
+ @param score The score
+ @param playerId The player identifier
+ @param leaderboardId The identifier of the leaderboard
+ */
+- (BOOL) recordScore:(long long)score player:(NSString *)playerId leaderboard:(NSString *)leaderboardId;
+
+/**
+ Returns the best recorded score, or nil
+ */
+- (NSNumber *) bestScoreForPlayer:(NSString *)playerId leaderboard:(NSString *)leaderboardId;
+
+/**
+ Returns up to `SCORE_INDEX_RECENT_COUNT` recorded scores, most recent last
+ */
+- (NSArray *) recentScoresForPlayer:(NSString *)playerId leaderboard:(NSString *)leaderboardId;
+
+///---------------------
+/// @name Deferred scores
+///---------------------
+
+/**
+ Keeps a score submission request to be posted later.
+ @return The number of deferred requests
+ */
+- (NSUInteger) deferRequest:(SXRequest *)request;
+
+/**
+ Returns the deferred requests and removes them from the index.
+ */
+- (NSArray *) drainDeferredRequests;
+
+/**
+ Removes every recorded score, sort order and deferred request.
+ */
+- (void) reset;
+
+@end
@@ -0,0 +1,237 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXScoreIndex.h"
+#import "SXRequestCodec.h"
+
+#define SCORE_INDEX_PLAYERS_KEY @"players"
+#define SCORE_INDEX_DEFERRED_KEY @"deferred"
+#define SCORE_INDEX_ORDERS_KEY @"orders"
+#define SCORE_INDEX_BEST_KEY @"best"
+#define SCORE_INDEX_RECENT_KEY @"recent"
+
+@interface SXScoreIndex ()
+
+/// playerId => leaderboardId => {best, recent}, as stored in the NSUserDefaults
+@property (strong, nonatomic) NSMutableDictionary *players;
+
+/// Encoded SXRequests waiting to be posted
+@property (strong, nonatomic) NSMutableArray *deferred;
+
+/// leaderboardId => SXScoreOrder, persisted along with the scores
+@property (strong, nonatomic) NSMutableDictionary *orders;
+
+- (NSMutableDictionary *) entryForPlayer:(NSString *)playerId leaderboard:(NSString *)leaderboardId create:(BOOL)create;
+
+- (BOOL) score:(long long)score improves:(NSNumber *)best leaderboard:(NSString *)leaderboardId;
+
+- (void) save;
+
+@end
+
+@implementation SXScoreIndex
+
++ (SXScoreIndex *) sharedIndex
+{
+    static SXScoreIndex *sharedIndex = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedIndex = [[SXScoreIndex alloc] init];
+    });
+    return sharedIndex;
+}
+
+- (id) init
+{
+    if (self = [super init]) {
+        NSDictionary *saved = [[NSUserDefaults standardUserDefaults] dictionaryForKey:USER_DEFAULTS_SCORE_INDEX_KEY];
+        self.orders = [NSMutableDictionary dictionaryWithDictionary:[saved objectForKey:SCORE_INDEX_ORDERS_KEY]];
+        self.players = [NSMutableDictionary dictionary];
+        self.deferred = [NSMutableArray arrayWithArray:[saved objectForKey:SCORE_INDEX_DEFERRED_KEY]];
+
+        // Deep mutable copy of the saved scores
+        NSDictionary *players = [saved objectForKey:SCORE_INDEX_PLAYERS_KEY];
+        for (NSString *playerId in players) {
+            NSMutableDictionary *leaderboards = [NSMutableDictionary dictionary];
+            NSDictionary *savedLeaderboards = [players objectForKey:playerId];
+            for (NSString *leaderboardId in savedLeaderboards)
+                [leaderboards setObject:[[savedLeaderboards objectForKey:leaderboardId] mutableCopy] forKey:leaderboardId];
+            [self.players setObject:leaderboards forKey:playerId];
+        }
+    }
+    return self;
+}
+
+#pragma mark - Sort order
+
+- (void) setOrder:(SXScoreOrder)order forLeaderboard:(NSString *)leaderboardId
+{
+    if (!leaderboardId)
+        return;
+
+    @synchronized(self) {
+        NSNumber *value = [NSNumber numberWithInt:order];
+        if ([value isEqual:[self.orders objectForKey:leaderboardId]])
+            return;
+        [self.orders setObject:value forKey:leaderboardId];
+        [self save];
+    }
+}
+
+- (SXScoreOrder) orderForLeaderboard:(NSString *)leaderboardId
+{
+    @synchronized(self) {
+        NSNumber *order = leaderboardId ? [self.orders objectForKey:leaderboardId] : nil;
+        return order ? (SXScoreOrder)order.intValue : SXScoreOrderDescending;
+    }
+}
+
+#pragma mark - Scores
+
+- (NSMutableDictionary *) entryForPlayer:(NSString *)playerId leaderboard:(NSString *)leaderboardId create:(BOOL)create
+{
+    NSMutableDictionary *leaderboards = [self.players objectForKey:playerId];
+    if (!leaderboards) {
+        if (!create)
+            return nil;
+        leaderboards = [NSMutableDictionary dictionary];
+        [self.players setObject:leaderboards forKey:playerId];
+    }
+
+    NSMutableDictionary *entry = [leaderboards objectForKey:leaderboardId];
+    if (!entry && create) {
+        entry = [NSMutableDictionary dictionary];
+        [leaderboards setObject:entry forKey:leaderboardId];
+    }
+    return entry;
+}
+
+- (BOOL) score:(long long)score improves:(NSNumber *)best leaderboard:(NSString *)leaderboardId
+{
+    SXScoreOrder order = [self orderForLeaderboard:leaderboardId];
+    return !best
+        || (SXScoreOrderDescending == order && score > best.longLongValue)
+        || (SXScoreOrderAscending == order && score < best.longLongValue);
+}
+
+- (BOOL) isImprovingScore:(long long)score player:(NSString *)playerId leaderboard:(NSString *)leaderboardId
+{
+    if (!playerId || !leaderboardId)
+        return YES;
+
+    @synchronized(self) {
+        NSNumber *best = [[self entryForPlayer:playerId leaderboard:leaderboardId create:NO] objectForKey:SCORE_INDEX_BEST_KEY];
+        return [self score:score improves:best leaderboard:leaderboardId];
+    }
+}
+
+- (BOOL) recordScore:(long long)score player:(NSString *)playerId leaderboard:(NSString *)leaderboardId
+{
+    if (!playerId || !leaderboardId)
+        return YES;
+
+    @synchronized(self) {
+        NSMutableDictionary *entry = [self entryForPlayer:playerId leaderboard:leaderboardId create:YES];
+        BOOL improves = [self score:score improves:[entry objectForKey:SCORE_INDEX_BEST_KEY] leaderboard:leaderboardId];
+
+        if (improves)
+            [entry setObject:[NSNumber numberWithLongLong:score] forKey:SCORE_INDEX_BEST_KEY];
+
+        NSMutableArray *recent = [NSMutableArray arrayWithArray:[entry objectForKey:SCORE_INDEX_RECENT_KEY]];
+        [recent addObject:[NSNumber numberWithLongLong:score]];
+        if (recent.count > SCORE_INDEX_RECENT_COUNT)
+            [recent removeObjectsInRange:NSMakeRange(0, recent.count - SCORE_INDEX_RECENT_COUNT)];
+        [entry setObject:recent forKey:SCORE_INDEX_RECENT_KEY];
+
+        [self save];
+        return improves;
+    }
+}
+
+- (NSNumber *) bestScoreForPlayer:(NSString *)playerId leaderboard:(NSString *)leaderboardId
+{
+    if (!playerId || !leaderboardId)
+        return nil;
+
+    @synchronized(self) {
+        return [[self entryForPlayer:playerId leaderboard:leaderboardId create:NO] objectForKey:SCORE_INDEX_BEST_KEY];
+    }
+}
+
+- (NSArray *) recentScoresForPlayer:(NSString *)playerId leaderboard:(NSString *)leaderboardId
+{
+    if (!playerId || !leaderboardId)
+        return @[];
+
+    @synchronized(self) {
+        NSArray *recent = [[self entryForPlayer:playerId leaderboard:leaderboardId create:NO] objectForKey:SCORE_INDEX_RECENT_KEY];
+        return recent ? [NSArray arrayWithArray:recent] : @[];
+    }
+}
+
+#pragma mark - Deferred scores
+
+- (NSUInteger) deferRequest:(SXRequest *)request
+{
+    @synchronized(self) {
+        [self.deferred addObject:[SXRequestCodec dataWithRequest:request]];
+        [self save];
+        return self.deferred.count;
+    }
+}
+
+- (NSArray *) drainDeferredRequests
+{
+    @synchronized(self) {
+        NSMutableArray *result = [NSMutableArray arrayWithCapacity:self.deferred.count];
+        for (NSData *data in self.deferred) {
+            SXRequest *request = [SXRequestCodec requestWithData:data];
+            if (request)
+                [result addObject:request];
+        }
+        [self.deferred removeAllObjects];
+        [self save];
+        return result;
+    }
+}
+
+#pragma mark - Persistence
+
+- (void) save
+{
+    NSUserDefaults *userDefaults = [NSUserDefaults standardUserDefaults];
+    [userDefaults setObject:@{SCORE_INDEX_PLAYERS_KEY: self.players,
+                              SCORE_INDEX_DEFERRED_KEY: self.deferred,
+                              SCORE_INDEX_ORDERS_KEY: self.orders}
+                     forKey:USER_DEFAULTS_SCORE_INDEX_KEY];
+    [userDefaults synchronize];
+}
+
+- (void) reset
+{
+    @synchronized(self) {
+        [self.players removeAllObjects];
+        [self.deferred removeAllObjects];
+        [self.orders removeAllObjects];
+        [[NSUserDefaults standardUserDefaults] removeObjectForKey:USER_DEFAULTS_SCORE_INDEX_KEY];
+        [[NSUserDefaults standardUserDefaults] synchronize];
+    }
+}
+
+@end
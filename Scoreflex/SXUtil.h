@@ -19,6 +19,8 @@
 
 #import <Foundation/Foundation.h>
 
+@class SXPromise;
+
 /**
  This class contains static utilities that would be better implemented as categories if it wasn't for this bug:
  https://developer.apple.com/library/mac/#qa/qa2006/qa1490.html
@@ -44,8 +46,17 @@
 /// @name Device
 ///--------------
 
+/**
+ Returns the device identifier without blocking, or nil while it is still being computed.
+ */
 + (NSString *)deviceIdentifier;
 
+/**
+ Returns a promise of the device identifier. It is computed once with OpenUDID on a background queue,
+ which scans the shared pasteboards, then persisted in the `NSUserDefaults`.
+ */
++ (SXPromise *)deviceIdentifierPromise;
+
 + (NSString *)deviceModel;
 
 ///--------------
@@ -66,6 +77,12 @@
  */
 + (NSString *)messageForScoreflexErrorCode:(NSInteger)errorCode;
 
+/**
+ Returns an error in the `SXErrorDomain` with the given code and its generic description.
+ @param errorCode The scoreflex error code.
+ */
++ (NSError *)errorWithScoreflexCode:(NSInteger)errorCode;
+
 ///--------------
 /// @name URL checking
 ///--------------
@@ -125,6 +142,7 @@
  - `SXErrorGameDoesNotExist`
  - `SXErrorLeaderboardConfigDoesNotExist`
  - `SXErrorServiceException`
+ - `SXErrorRequestTimedOut`
 
  The following codes are also predefined:
 
@@ -153,6 +171,7 @@ extern NSInteger const SXErrorDeveloperDoesNotExist;
 extern NSInteger const SXErrorGameDoesNotExist;
 extern NSInteger const SXErrorLeaderboardConfigDoesNotExist;
 extern NSInteger const SXErrorServiceException;
+extern NSInteger const SXErrorRequestTimedOut;
 
 extern NSInteger const SXCodeLogout;
 extern NSInteger const SXCodeCloseWebView;
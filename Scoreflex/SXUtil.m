@@ -20,6 +20,7 @@
 #import "SXUtil.h"
 #import "OpenUDID.h"
 #import "SXConfiguration.h"
+#import "SXPromise.h"
 
 #import <sys/utsname.h>
 
@@ -40,6 +41,7 @@ NSInteger const SXErrorDeveloperDoesNotExist = 12001;
 NSInteger const SXErrorGameDoesNotExist = 12002;
 NSInteger const SXErrorLeaderboardConfigDoesNotExist = 12004;
 NSInteger const SXErrorServiceException = 12009;
+NSInteger const SXErrorRequestTimedOut = 100001;
 
 NSInteger const SXCodeLogout = 200000;
 NSInteger const SXCodeCloseWebView = 200001;
@@ -156,8 +158,35 @@ NSInteger const SXCodeShare = 200010;
 
 + (NSString *)deviceIdentifier
 {
-//    SXLog(@"Received opendUDID: %@", [OpenUDID value]);
-    return [OpenUDID value];
+    SXPromise *promise = [self deviceIdentifierPromise];
+    return promise.isFulfilled ? promise.value : nil;
+}
+
++ (SXPromise *)deviceIdentifierPromise
+{
+    static SXPromise *promise = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        promise = [[SXPromise alloc] init];
+
+        NSString *identifier = [[NSUserDefaults standardUserDefaults] stringForKey:USER_DEFAULTS_DEVICE_IDENTIFIER_KEY];
+        if (identifier) {
+            [promise fulfill:identifier];
+            return;
+        }
+
+        // OpenUDID opens up to 100 pasteboards, keep it off the launch path
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            NSString *identifier = [OpenUDID value];
+            SXLog(@"Received OpenUDID: %@", identifier);
+
+            NSUserDefaults *userDefaults = [NSUserDefaults standardUserDefaults];
+            [userDefaults setObject:identifier forKey:USER_DEFAULTS_DEVICE_IDENTIFIER_KEY];
+            [userDefaults synchronize];
+            [promise fulfill:identifier];
+        });
+    });
+    return promise;
 }
 
 #pragma mark - Errors
@@ -211,62 +240,67 @@ NSInteger const SXCodeShare = 200010;
         result = NSLocalizedString(@"When a leaderboard config does not exist", nil);
     else if (errorCode == SXErrorServiceException)
         result = NSLocalizedString(@"When there is a service exception", nil);
+    else if (errorCode == SXErrorRequestTimedOut)
+        result = NSLocalizedString(@"When a request did not complete before its deadline", nil);
 
     return result;
 
 }
 
-#pragma mark - URL Checking
-
-+ (BOOL) isScoreflexURL:(NSURL *)URL
++ (NSError *)errorWithScoreflexCode:(NSInteger)errorCode
 {
-    // Check base path
-    SXConfiguration *configuration = [SXConfiguration sharedConfiguration];
+    NSString *message = [self messageForScoreflexErrorCode:errorCode];
+    return [[NSError alloc] initWithDomain:SXErrorDomain code:errorCode userInfo:message ? @{NSLocalizedDescriptionKey: message} : nil];
+}
 
-    NSString *urlString = URL.absoluteString;
+#pragma mark - URL Checking
 
-    // Remove protocol
-    urlString = [urlString stringByReplacingOccurrencesOfString:@"http:" withString:@""];
-    urlString = [urlString stringByReplacingOccurrencesOfString:@"https:" withString:@""];
+/// The base URL the matcher was compiled for, and its compiled parts
+static NSURL *MatcherBaseURL = nil;
+static NSString *MatcherHost = nil;
+static NSNumber *MatcherPort = nil;
+static NSString *MatcherPath = nil;
 
-    NSString *noProtocolBaseURLString = configuration.baseURL.absoluteString;
-    noProtocolBaseURLString = [noProtocolBaseURLString stringByReplacingOccurrencesOfString:@"http:" withString:@""];
-    noProtocolBaseURLString = [noProtocolBaseURLString stringByReplacingOccurrencesOfString:@"https:" withString:@""];
+/**
+ Returns the resource of the given URL, still percent encoded, if the URL is a Scoreflex URL, or nil. The scheme is
+ ignored, and the host, port and path prefix are compared to those of the base URL, split once per base URL.
+ */
+static NSString *SXScoreflexResource(NSURL *URL)
+{
+    NSString *host, *basePath;
+    NSNumber *port;
+    NSURL *baseURL = [SXConfiguration sharedConfiguration].baseURL;
+    @synchronized([SXUtil class]) {
+        if (MatcherBaseURL != baseURL) {
+            MatcherBaseURL = baseURL;
+            MatcherHost = baseURL.host;
+            MatcherPort = baseURL.port;
+            MatcherPath = baseURL ? CFBridgingRelease(CFURLCopyPath((__bridge CFURLRef)baseURL.absoluteURL)) : nil;
+        }
+        host = MatcherHost;
+        port = MatcherPort;
+        basePath = MatcherPath;
+    }
 
-    NSRange rangeOfBaseUrl = [urlString rangeOfString:noProtocolBaseURLString];
+    if (!host || !URL.host || NSOrderedSame != [URL.host caseInsensitiveCompare:host])
+        return nil;
+    if (port != URL.port && ![port isEqualToNumber:URL.port])
+        return nil;
 
-    return 0 == rangeOfBaseUrl.location;
+    NSString *path = CFBridgingRelease(CFURLCopyPath((__bridge CFURLRef)URL.absoluteURL));
+    if (![path hasPrefix:basePath])
+        return nil;
+    return [path substringFromIndex:basePath.length];
+}
 
++ (BOOL) isScoreflexURL:(NSURL *)URL
+{
+    return nil != SXScoreflexResource(URL);
 }
 
 + (NSString *) resourceForScoreflexURL:(NSURL *)URL
 {
-    if (![self isScoreflexURL:URL])
-        return nil;
-
-    SXConfiguration *configuration = [SXConfiguration sharedConfiguration];
-
-    NSString *urlString = URL.absoluteString;
-    // Remove protocol
-    urlString = [urlString stringByReplacingOccurrencesOfString:@"http:" withString:@""];
-    urlString = [urlString stringByReplacingOccurrencesOfString:@"https:" withString:@""];
-
-    NSString *noProtocolBaseURLString = configuration.baseURL.absoluteString;
-    noProtocolBaseURLString = [noProtocolBaseURLString stringByReplacingOccurrencesOfString:@"http:" withString:@""];
-    noProtocolBaseURLString = [noProtocolBaseURLString stringByReplacingOccurrencesOfString:@"https:" withString:@""];
-
-
-    NSRange rangeOfBaseUrl = [urlString rangeOfString:noProtocolBaseURLString];
-
-
-    // Compute the resource
-    NSString *resource = [urlString substringFromIndex:rangeOfBaseUrl.length];
-    if (URL.query) {
-        NSRange rangeOfQuery = [resource rangeOfString:URL.query];
-        if (rangeOfQuery.location != NSNotFound)
-            resource = [resource substringToIndex:rangeOfQuery.location - 1];
-    }
-    return resource;
+    return SXScoreflexResource(URL);
 }
 
 + (NSDictionary *) paramsForScoreflexURL:(NSURL *)URL
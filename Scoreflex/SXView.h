@@ -20,8 +20,15 @@
 #import <UIKit/UIKit.h>
 
 @class SXViewController;
+@class SXView;
 @protocol SXViewDelegate;
 
+/**
+ A block handling a web callback of a Scoreflex page, given the view showing the page and the query parameters of
+ the callback. Returns YES if the callback was handled.
+ */
+typedef BOOL (^SXWebCallbackHandler)(SXView *view, NSDictionary *params);
+
 /**
  A `UIView` that displays Scoreflex content. An `SXView` holds a `UIWebView` that displays scoreflex web content.
  */
@@ -47,7 +54,8 @@
 ///=================================
 
 /**
- Removes this view from the hierarchy
+ Removes this view from the hierarchy. Panel views returned by `Scoreflex` are done once closed: their web view is
+ reused by the next panel and they stay blank, so keep no reference to them and get a new view for the next panel.
  */
 - (void) close;
 
@@ -114,6 +122,25 @@ Returns YES if the current screen is not the last of the history stack.
  */
 -(void) goForward;
 
+///=================================
+///@name Handling web callbacks
+///=================================
+
+/**
+ Sets the handler of the web callbacks with the given code, sent by Scoreflex pages on success. Replaces the handler
+ of the SDK if there is one. Handlers are called on the main thread.
+ @param handler The handler, or nil to ignore the callbacks with this code
+ @param code The callback code
+ */
++ (void) setWebCallbackHandler:(SXWebCallbackHandler)handler forCode:(NSInteger)code;
+
+/**
+ Sets the handler of the web callbacks with the given error code, sent by Scoreflex pages on errors.
+ @param handler The handler, or nil to ignore the callbacks with this code
+ @param code The error code
+ */
++ (void) setWebCallbackHandler:(SXWebCallbackHandler)handler forErrorCode:(NSInteger)code;
+
 @end
 
 /**
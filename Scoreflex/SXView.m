@@ -24,6 +24,10 @@
 #import "SXViewController.h"
 #import "Scoreflex.h"
 #import "SXGooglePlusUtil.h"
+#import "SXViewPool.h"
+#import "SXWebCache.h"
+#import "Scoreflex_private.h"
+#import "SXMetrics.h"
 
 @interface SXView () <UIWebViewDelegate>
 
@@ -32,8 +36,43 @@
 ///============================
 - (void) prepare;
 
+/**
+ Adds a web view, replacing the current one if any.
+ @param webView The web view to add, or nil to create a new one
+ */
+- (void) installWebView:(UIWebView *)webView;
+
 @property (nonatomic, weak) UIWebView *webView;
 
+/// Set by the view pool on the views it vends
+@property (nonatomic, assign) BOOL reusable;
+
+/// Incremented by the view pool each time the view is recycled
+@property (nonatomic, assign) NSUInteger reuseGeneration;
+
+/// Whether the view reloads when the logged user changes, NO while it sits in the view pool
+@property (nonatomic, assign) BOOL reloadsOnLogin;
+
+/// The load in progress, if metrics are enabled
+@property (nonatomic, strong) SXViewLoadTimeline *loadTimeline;
+
+/// The URL of the page of the load in progress
+@property (nonatomic, strong) NSURL *loadURL;
+
+/// The session the content was loaded for, nil until something is loaded
+@property (nonatomic, strong) NSString *loadedSid;
+
+/// The resource waiting for a session to be loaded
+@property (nonatomic, strong) NSString *pendingResource;
+
+/// The last resource reported to the preload predictor
+@property (nonatomic, strong) NSString *visitedResource;
+
+/**
+ Stops tracking the load in progress, recording it if it completed.
+ */
+- (void) endLoadTimeline:(BOOL)completed;
+
 ///=================================
 ///@name Loading scoreflex resources
 ///=================================
@@ -77,6 +116,11 @@
  */
 - (BOOL)handleWebCallback:(NSURLRequest *)request;
 
+/**
+ Fills the web callback handler tables with the handlers of the SDK, once.
+ */
++ (void) registerDefaultWebCallbackHandlers;
+
 /**
  Deactivate scoreflex
  @param params The query parameters
@@ -185,6 +229,16 @@
     return self;
 }
 
+- (id) initWithFrame:(CGRect)frame webView:(UIWebView *)webView
+{
+    if (self = [super initWithFrame:frame]) {
+        [self installWebView:webView];
+        self.reloadsOnLogin = YES;
+        self.alpha = 0;
+    }
+    return self;
+}
+
 - (id) initWithViewController:(UIViewController *)viewController
 {
     if (self = [super initWithFrame:viewController.view.bounds]) {
@@ -196,6 +250,11 @@
 
 -(void) userLoggedIn:(NSNotification *) notification
 {
+    // Views waiting for the session load once it is ready, and content of the same session is still valid
+    NSString *sid = [notification.userInfo objectForKey:SX_NOTIFICATION_USER_LOGED_IN_SID_KEY];
+    if (!self.loadedSid || [self.loadedSid isEqualToString:sid])
+        return;
+
     [self reload];
 //    NSLog(@"received event");
 //   [[NSNotificationCenter defaultCenter]
@@ -210,16 +269,9 @@
 
 - (void) prepare
 {
-    UIWebView *webView = [[UIWebView alloc] initWithFrame:self.bounds];
-    webView.backgroundColor = [UIColor clearColor];
-    [self addSubview:webView];
-    webView.autoresizingMask = UIViewAutoresizingFlexibleWidth|UIViewAutoresizingFlexibleHeight;
-    self.webView = webView;
-    self.webView.delegate = self;
-    self.webView.hidden = YES;
-    self.webView.scrollView.bounces = NO;
+    [self installWebView:nil];
     // When not in full screen mode, start at alpha = 0
-    [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(userLoggedIn:) name:SX_NOTIFICATION_USER_LOGED_IN object:nil];
+    self.reloadsOnLogin = YES;
     if (!self.viewController)
         self.alpha = 0;
 }
@@ -233,12 +285,123 @@
 }
 */
 
++ (UIWebView *) newWebView
+{
+    UIWebView *webView = [[UIWebView alloc] initWithFrame:CGRectZero];
+    webView.backgroundColor = [UIColor clearColor];
+    webView.autoresizingMask = UIViewAutoresizingFlexibleWidth|UIViewAutoresizingFlexibleHeight;
+    webView.hidden = YES;
+    webView.scrollView.bounces = NO;
+    return webView;
+}
+
+- (void) installWebView:(UIWebView *)webView
+{
+    UIWebView *previousWebView = self.webView;
+    previousWebView.delegate = nil;
+    [previousWebView stopLoading];
+    [previousWebView removeFromSuperview];
+
+    if (!webView)
+        webView = [[self class] newWebView];
+    webView.frame = self.bounds;
+    webView.hidden = YES;
+    [self insertSubview:webView atIndex:0];
+    self.webView = webView;
+    self.webView.delegate = self;
+}
+
+#pragma mark - Reuse
+
+- (void) prepareForReuse
+{
+    [self.webView stopLoading];
+
+    // The history of a web view cannot be cleared, going back must not lead to the content of the previous use
+    if (self.webView.canGoBack || self.webView.canGoForward) {
+        [self installWebView:nil];
+    } else {
+        // Blank the document without a navigation, which would be reported to the delegate
+        [self.webView stringByEvaluatingJavaScriptFromString:@"document.open();document.close();"];
+    }
+    self.webView.hidden = YES;
+    self.authState = nil;
+    self.authNextURL = nil;
+    self.loadedSid = nil;
+    self.pendingResource = nil;
+    self.visitedResource = nil;
+    [self endLoadTimeline:NO];
+}
+
+- (UIWebView *) takeWebView
+{
+    UIWebView *webView = self.webView;
+    [self endLoadTimeline:NO];
+    self.pendingResource = nil;
+    if (!webView)
+        return nil;
+
+    webView.delegate = nil;
+    [webView stopLoading];
+    [webView removeFromSuperview];
+    self.webView = nil;
+
+    // The history of a web view cannot be cleared, going back must not lead to the content of the previous use
+    if (webView.canGoBack || webView.canGoForward)
+        return nil;
+
+    // Blank the document without a navigation
+    [webView stringByEvaluatingJavaScriptFromString:@"document.open();document.close();"];
+    webView.hidden = YES;
+    return webView;
+}
+
+- (void) recordVisit:(NSString *)resource
+{
+    if (!resource || [self.visitedResource isEqualToString:resource])
+        return;
+
+    self.visitedResource = resource;
+    [Scoreflex didOpenResource:resource];
+}
+
+#pragma mark - Metrics
+
+- (void) endLoadTimeline:(BOOL)completed
+{
+    if (!self.loadTimeline)
+        return;
+
+    [[SXMetrics sharedMetrics] trackViewLoad:nil forURL:self.loadURL];
+    if (completed) {
+        // When the page did not go through the web cache, its first byte is not known and the phase lasts until the end
+        [self.loadTimeline endPhase:SXViewLoadPhaseFirstByte];
+        [self.loadTimeline endPhase:SXViewLoadPhaseRender];
+        [[SXMetrics sharedMetrics] recordViewLoad:self.loadTimeline];
+    }
+    self.loadTimeline = nil;
+    self.loadURL = nil;
+}
+
+- (void) setReloadsOnLogin:(BOOL)reloadsOnLogin
+{
+    if (_reloadsOnLogin == reloadsOnLogin)
+        return;
+
+    _reloadsOnLogin = reloadsOnLogin;
+    if (reloadsOnLogin)
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(userLoggedIn:) name:SX_NOTIFICATION_USER_LOGED_IN object:nil];
+    else
+        [[NSNotificationCenter defaultCenter] removeObserver:self name:SX_NOTIFICATION_USER_LOGED_IN object:nil];
+}
+
 #pragma mark - Closing
 
 - (void) close
 {
     if (!self.viewController) {
         [self removeFromSuperview];
+        [[SXViewPool sharedPool] recycleView:self];
     } else {
 
         if (((SXViewController*)self.viewController).fromTop == YES) {
@@ -264,6 +427,8 @@
 
 -(void) loadUrlAfterLoggedIn:(NSString *) resource params:(NSDictionary*)params {
 
+    [self.loadTimeline beginPhase:SXViewLoadPhaseTokenWait];
+
     SXRequest *request = [[SXRequest alloc] init];
     request.resource = resource;
     request.method = @"GET";
@@ -273,19 +438,30 @@
         [((SXViewController*)self.viewController) setState:SXViewControllerStateInitial];
     }
 
-    [[SXClient sharedClient]  fetchAnonymousAccessTokenAndCall:^(AFHTTPRequestOperation *operation, id responseObject) {
-        if (self.viewController) {
-            ((SXViewController*)self.viewController) .request = request;
-            [((SXViewController*)self.viewController) load];
+    // All the views wait for the same session, fetched once
+    self.pendingResource = resource;
+    [[[SXClient sharedClient] sessionReady] done:^(id sid, NSError *error) {
+        // The view was reused for something else in the meantime
+        if (![resource isEqualToString:self.pendingResource])
+            return;
+        self.pendingResource = nil;
+
+        if (error) {
+            if (self.viewController) {
+                ((SXViewController*)self.viewController).request = request;
+                ((SXViewController*)self.viewController) .messageLabel.text = [error localizedDescription];
+                [((SXViewController*)self.viewController)  setState:SXViewControllerStateError];
+            }
+            return;
         }
 
-    } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
         if (self.viewController) {
-            ((SXViewController*)self.viewController).request = request;
-            ((SXViewController*)self.viewController) .messageLabel.text = [error localizedDescription];
-            [((SXViewController*)self.viewController)  setState:SXViewControllerStateError];
+            ((SXViewController*)self.viewController) .request = request;
+            [((SXViewController*)self.viewController) load];
+        } else {
+            [self setResource:resource params:params];
         }
-    } nbRetry:0];
+    }];
 }
 
 #pragma mark - Resource & URL
@@ -302,6 +478,11 @@
 
     if ([SXConfiguration sharedConfiguration].sid != nil)
     {
+        self.pendingResource = nil;
+        self.loadedSid = [SXConfiguration sharedConfiguration].sid;
+        [self.loadTimeline endPhase:SXViewLoadPhaseTokenWait];
+        [self.loadTimeline beginPhase:SXViewLoadPhaseRequest];
+
         SXRequest *request = [[SXRequest alloc] init];
         request.resource = resource;
         request.method = @"GET";
@@ -311,6 +492,15 @@
 
     // Force http
         urlRequest.URL = [NSURL URLWithString:[NSString stringWithFormat:@"%@#start", [urlRequest.URL.  absoluteString stringByReplacingOccurrencesOfString:@"https:" withString:@"http:"]]];
+
+        [self.loadTimeline endPhase:SXViewLoadPhaseRequest];
+        if (self.loadTimeline) {
+            // The web cache reports the first byte of the page
+            [[SXMetrics sharedMetrics] trackViewLoad:nil forURL:self.loadURL];
+            self.loadURL = urlRequest.URL;
+            [[SXMetrics sharedMetrics] trackViewLoad:self.loadTimeline forURL:self.loadURL];
+            [self.loadTimeline beginPhase:SXViewLoadPhaseFirstByte];
+        }
         [self.webView loadRequest:urlRequest];
     } else  {
         SXLog(@"will load after loading");
@@ -390,6 +580,17 @@
 - (void) openResource:(NSString *)resource params:(NSDictionary *)params forceFullScreen:(BOOL)forceFullScreen
 {
     if (!forceFullScreen || self.viewController) {
+        BOOL preloading = [self.viewController isKindOfClass:[SXViewController class]] && ((SXViewController *)self.viewController).isPreloading;
+        if (!preloading)
+            [self recordVisit:resource];
+
+        // Keep the load started before waiting for an access token
+        if ([SXMetrics isEnabled] && ![self.loadTimeline.resource isEqualToString:resource]) {
+            [self endLoadTimeline:NO];
+            self.loadTimeline = [[SXViewLoadTimeline alloc] initWithResource:resource];
+            self.loadTimeline.preloaded = preloading;
+        }
+
         if ([SXConfiguration sharedConfiguration].sid != nil) {
             [self setResource:resource params:params];
         } else {
@@ -485,6 +686,8 @@
     if ([@"WebKitErrorDomain" isEqualToString:error.domain] && 102 == error.code)
         return;
 
+    [self endLoadTimeline:NO];
+
     if ([self.delegate respondsToSelector:@selector(scoreflexView:receivedError:forURL:)])
         [self.delegate scoreflexView:self receivedError:error forURL:webView.request.URL];
 }
@@ -496,11 +699,64 @@
     [UIView animateWithDuration:.3 animations:^{
         self.alpha = 1;
     }];
+    [self endLoadTimeline:YES];
     if ([self.delegate respondsToSelector:@selector(scoreflexView:finishedLoadingURL:)])
         [self.delegate scoreflexView:self finishedLoadingURL:webView.request.URL];
 }
 #pragma mark - Handling web callbacks
 
+/// code => SXWebCallbackHandler, for successes and for errors
+static NSMutableDictionary *SuccessHandlers = nil;
+static NSMutableDictionary *ErrorHandlers = nil;
+
++ (void) registerDefaultWebCallbackHandlers
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        SuccessHandlers = [[NSMutableDictionary alloc] init];
+        ErrorHandlers = [[NSMutableDictionary alloc] init];
+
+        [SuccessHandlers setObject:^BOOL(SXView *view, NSDictionary *params) { return [view handleMoveToNewUrl:params]; } forKey:[NSNumber numberWithInteger:SXCodeMoveToNewURL]];
+        [SuccessHandlers setObject:^BOOL(SXView *view, NSDictionary *params) { return [view handleCloseWebView:params]; } forKey:[NSNumber numberWithInteger:SXCodeCloseWebView]];
+        [SuccessHandlers setObject:^BOOL(SXView *view, NSDictionary *params) { return [view handleNeedsAuth:params]; } forKey:[NSNumber numberWithInteger:SXCodeNeedsAuth]];
+        [SuccessHandlers setObject:^BOOL(SXView *view, NSDictionary *params) { return [view handleAuthGranted:params]; } forKey:[NSNumber numberWithInteger:SXCodeAuthGranted]];
+        [SuccessHandlers setObject:^BOOL(SXView *view, NSDictionary *params) { return [view handleLogout:params]; } forKey:[NSNumber numberWithInteger:SXCodeLogout]];
+        [SuccessHandlers setObject:^BOOL(SXView *view, NSDictionary *params) { return [view handleNeedsClientAuth:params]; } forKey:[NSNumber numberWithInteger:SXCodeNeedsClientAuth]];
+        [SuccessHandlers setObject:^BOOL(SXView *view, NSDictionary *params) { return [view handleStartChallenge:params]; } forKey:[NSNumber numberWithInteger:SXCodeStartChallenge]];
+        [SuccessHandlers setObject:^BOOL(SXView *view, NSDictionary *params) { return [view handlePlayLevel:params]; } forKey:[NSNumber numberWithInteger:SXCodePlayLevel]];
+        [SuccessHandlers setObject:^BOOL(SXView *view, NSDictionary *params) { return [view handleLinkService:params]; } forKey:[NSNumber numberWithInteger:SXCodeLinkService]];
+        [SuccessHandlers setObject:^BOOL(SXView *view, NSDictionary *params) { return [view handleInvitation:params]; } forKey:[NSNumber numberWithInteger:SXCodeSendInvitation]];
+        [SuccessHandlers setObject:^BOOL(SXView *view, NSDictionary *params) { return [view handleShare:params]; } forKey:[NSNumber numberWithInteger:SXCodeShare]];
+
+        [ErrorHandlers setObject:^BOOL(SXView *view, NSDictionary *params) { return [view handleInvalidSIDError:params]; } forKey:[NSNumber numberWithInteger:SXErrorInvalidSid]];
+        [ErrorHandlers setObject:^BOOL(SXView *view, NSDictionary *params) { return [view handleInactiveGameError:params]; } forKey:[NSNumber numberWithInteger:SXErrorInactigveGame]];
+        // Registered last as it shares its code with SXErrorInactigveGame, and has always taken precedence
+        [ErrorHandlers setObject:^BOOL(SXView *view, NSDictionary *params) { return [view handleSecureConnectionRequiredError:params]; } forKey:[NSNumber numberWithInteger:SXErrorSecureConnectionRequired]];
+    });
+}
+
++ (void) setWebCallbackHandler:(SXWebCallbackHandler)handler forCode:(NSInteger)code
+{
+    [self registerDefaultWebCallbackHandlers];
+    @synchronized(SuccessHandlers) {
+        if (handler)
+            [SuccessHandlers setObject:[handler copy] forKey:[NSNumber numberWithInteger:code]];
+        else
+            [SuccessHandlers removeObjectForKey:[NSNumber numberWithInteger:code]];
+    }
+}
+
++ (void) setWebCallbackHandler:(SXWebCallbackHandler)handler forErrorCode:(NSInteger)code
+{
+    [self registerDefaultWebCallbackHandlers];
+    @synchronized(ErrorHandlers) {
+        if (handler)
+            [ErrorHandlers setObject:[handler copy] forKey:[NSNumber numberWithInteger:code]];
+        else
+            [ErrorHandlers removeObjectForKey:[NSNumber numberWithInteger:code]];
+    }
+}
+
 - (BOOL) handleWebCallback:(NSURLRequest *)request
 {
     NSURL *URL = request.URL;
@@ -511,60 +767,16 @@
     NSInteger status = [[queryParameters valueForKey:@"status"] integerValue];
     NSInteger code = [[queryParameters valueForKey:@"code"] integerValue];
 
-    if (!status || !code)
+    if (!status || !code || 404 == status)
         return NO;
 
-    // Successes
-    if (300 > status) {
-
-        if (code == SXCodeMoveToNewURL)
-            return [self handleMoveToNewUrl:queryParameters];
-
-        else if (code == SXCodeCloseWebView)
-            return [self handleCloseWebView:queryParameters];
-
-        else if (code == SXCodeNeedsAuth)
-            return [self handleNeedsAuth:queryParameters];
-
-        else if (code == SXCodeAuthGranted)
-            return [self handleAuthGranted:queryParameters];
-
-        else if (code == SXCodeLogout)
-            return [self handleLogout:queryParameters];
-
-        else if (code == SXCodeNeedsClientAuth)
-            return [self handleNeedsClientAuth:queryParameters];
-
-        else if (code == SXCodeStartChallenge)
-            return [self handleStartChallenge:queryParameters];
-
-        else if (code == SXCodePlayLevel)
-            return [self handlePlayLevel:queryParameters];
-
-        else if (code == SXCodeLinkService)
-            return [self handleLinkService:queryParameters];
-        
-        else if (code == SXCodeSendInvitation)
-            return [self handleInvitation:queryParameters];
-        
-        else if (code == SXCodeShare)
-            return [self handleShare:queryParameters];
-
-    } else {
-        if (404 == status)
-            return false;
-
-        if (code == SXErrorInvalidSid)
-            return [self handleInvalidSIDError:queryParameters];
-
-        else if (code == SXErrorSecureConnectionRequired)
-            return [self handleSecureConnectionRequiredError:queryParameters];
-
-        else if (code == SXErrorInactigveGame)
-            return [self handleInactiveGameError:queryParameters];
+    [[self class] registerDefaultWebCallbackHandlers];
+    NSMutableDictionary *handlers = 300 > status ? SuccessHandlers : ErrorHandlers;
+    SXWebCallbackHandler handler;
+    @synchronized(handlers) {
+        handler = [handlers objectForKey:[NSNumber numberWithInteger:code]];
     }
-
-    return NO;
+    return handler ? handler(self, queryParameters) : NO;
 }
 
 - (BOOL) handleInactiveGameError:(NSDictionary *)params
@@ -611,8 +823,9 @@
     }
     NSDictionary *instanceGetParams = @{@"fields": @"core,turn,outcome,config"};
 
-    [Scoreflex get:[NSString stringWithFormat:@"challenges/instances/%@", [dataJson valueForKey:@"challengeInstanceId"]] params:instanceGetParams
-           handler:^(SXResponse *response, NSError *error) {
+    // Promise callbacks run on the main queue, whatever the callback queue of the handlers
+    [[Scoreflex get:[NSString stringWithFormat:@"challenges/instances/%@", [dataJson valueForKey:@"challengeInstanceId"]] params:instanceGetParams
+           handler:nil] done:^(SXResponse *response, NSError *error) {
                NSDictionary *userInfo = [NSDictionary dictionaryWithObjectsAndKeys:[response object], SX_NOTIFICATION_START_CHALLENGE_CONFIG_KEY, nil];
 
 //               [NSDictionary dictionaryWithObjects:[response object], [dataJson valueForKey:@"challengeConfigId"] forKey:SX_NOTIFICATION_START_CHALLENGE_CONFIG_KEY, SX_NOTIFICATION_START_CHALLENGE_CONFIG_ID_KEY];
@@ -667,7 +880,10 @@
     for (NSHTTPCookie *cookie in cookies)
         [storage deleteCookie:cookie];
 
-    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    // The cached pages hold data of the player
+    [[SXWebCache sharedCache] removeShells];
+
+    self.reloadsOnLogin = NO;
     [[SXClient sharedClient] fetchAnonymousAccessTokenIfNeeded];
     [self close];
 
@@ -724,21 +940,25 @@
                                         @"devicePlatform" : @"iOS",
                                         @"deviceModel" : [SXUtil deviceModel],
                                         }];
-    NSString *udid = [SXUtil deviceIdentifier];
-    if (udid)
-        [oauthParams setValue:udid forKey:@"deviceId"];
 
-    SXRequest *request = [[SXRequest alloc] init];
-    request.method = @"POST";
-    request.resource = @"/oauth/accessToken";
-    request.params = [NSDictionary dictionaryWithDictionary:oauthParams];
-    request.handler = ^(SXResponse *response, NSError *error) {
-        [self handleLoginResponse:response error:error];
-    };
+    // The device identifier may still be computed in the background, wait for it like the anonymous token fetch
+    [[SXUtil deviceIdentifierPromise] done:^(id udid, NSError *identifierError) {
+        if (udid)
+            [oauthParams setValue:udid forKey:@"deviceId"];
 
-    // Send the request.
-    SXClient *client = [SXClient sharedClient];
-    [client requestAuthenticated:request];
+        SXRequest *request = [[SXRequest alloc] init];
+        request.method = @"POST";
+        request.resource = @"/oauth/accessToken";
+        request.params = [NSDictionary dictionaryWithDictionary:oauthParams];
+        request.handler = ^(SXResponse *response, NSError *error) {
+            [self handleLoginResponse:response error:error];
+        };
+        request.callbackQueue = dispatch_get_main_queue();
+
+        // Send the request.
+        SXClient *client = [SXClient sharedClient];
+        [client requestAuthenticated:request];
+    }];
 
     return YES;
 }
@@ -792,11 +1012,11 @@
 
     NSDictionary *userInfo = @{SX_NOTIFICATION_USER_LOGED_IN_SID_KEY: sid,
                                SX_NOTIFICATION_USER_LOGED_IN_ACCESS_TOKEN_KEY:accessToken};
-    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    self.reloadsOnLogin = NO;
     [[NSNotificationCenter defaultCenter] postNotificationName:SX_NOTIFICATION_USER_LOGED_IN
                                                         object:self
                                                       userInfo:userInfo];
-    [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(userLoggedIn:) name:SX_NOTIFICATION_USER_LOGED_IN object:nil];
+    self.reloadsOnLogin = YES;
     if (self.authNextURL)
         [self openURL:self.authNextURL forceFullScreen:NO];
 
@@ -878,6 +1098,7 @@
                 request.handler = ^(SXResponse *response, NSError *error) {
                     [self handleLoginResponse:response error:error];
                 };
+                request.callbackQueue = dispatch_get_main_queue();
                 SXClient *client = [SXClient sharedClient];
                 [client requestAuthenticated:request];
             }
@@ -1080,6 +1301,7 @@
 }
 
 -(void) dealloc {
+    [self endLoadTimeline:NO];
     [[NSNotificationCenter defaultCenter] removeObserver:self];
 }
 
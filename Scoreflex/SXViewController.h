@@ -42,10 +42,18 @@ typedef enum {
 @property (assign, nonatomic) BOOL fromTop;
 @property (assign, nonatomic) BOOL cancelled;
 @property (strong, nonatomic) NSTimer *timer;
+
+/// YES while the controller loads its resource before being shown
+@property (readonly, nonatomic) BOOL isPreloading;
 - (IBAction)touchBack:(id)sender;
 - (IBAction)touchClose:(id)sender;
 - (IBAction)touchRetry:(id)sender;
 - (void) preload;
 - (void) load;
+
+/**
+ Resets the controller, keeping its view and web view, before it is used for another resource.
+ */
+- (void) prepareForReuse;
 - (void) setState:(SXViewControllerState)state;
 @end
@@ -22,6 +22,7 @@
 #import "SXView_private.h"
 #import "Scoreflex.h"
 #import "SXConfiguration.h"
+#import "SXPreloadPool.h"
 
 
 @interface SXViewController () <SXViewDelegate>
@@ -73,6 +74,9 @@
         [self setState:SXViewControllerStateInitial];
     } else {
         [self setState:SXViewControllerStateWebContent];
+
+        // The resource was loaded ahead of time, this is when the player actually opens it
+        [self.scoreflexView recordVisit:self.request.resource];
     }
 
     // Set the initial state
@@ -91,10 +95,24 @@
     [self.scoreflexView openResource:self.request.resource params:self.request.params forceFullScreen:NO];
 }
 
+- (void) prepareForReuse
+{
+    [self.timer invalidate];
+    self.timer = nil;
+    self.request = nil;
+    self.currentScoreflexURL = nil;
+    self.isPreloading = NO;
+    self.cancelled = NO;
+    self.fromTop = NO;
+    [self.scoreflexView prepareForReuse];
+}
+
 - (void)didReceiveMemoryWarning
 {
     [super didReceiveMemoryWarning];
-    // Dispose of any resources that can be recreated.
+
+    // Preloaded web views are the first thing to go
+    [[SXPreloadPool sharedPool] handleMemoryWarning];
 }
 
 
@@ -0,0 +1,68 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import <Foundation/Foundation.h>
+#import "SXView.h"
+
+/**
+ SXViewPool keeps the web views of the panel views that have been closed, so that the next panel can be shown
+ without allocating a new `UIWebView`. Pooled web views are blanked.
+
+ Only the views vended by `dequeueView` are recycled. Each dequeue returns a new `SXView`, and a recycled view gives
+ its web view up, so a closed view kept by the game stays blank and never shows or closes another panel.
+ The pool is meant to be used from the main thread only.
+ */
+@interface SXViewPool : NSObject
+
+/**
+ The shared pool, keeping up to `PANEL_POOL_MAX_COUNT` views
+ */
++ (SXViewPool *) sharedPool;
+
+/// The maximum number of idle web views kept
+@property (assign, nonatomic) NSUInteger maxCount;
+
+/// The number of idle web views
+@property (readonly) NSUInteger count;
+
+/**
+ Returns a new view around an idle web view, or around a new one if the pool is empty. The view is not attached to
+ any superview.
+ */
+- (SXView *) dequeueView;
+
+/**
+ Takes the web view of the given closed view, blanked, for a later `dequeueView`. The view shows nothing afterwards.
+ Views that were not vended by the pool, or that are shown in a view controller or attached to a superview, are left
+ alone. Web views with a history, or that don't fit in the pool, are dropped.
+ @return YES if the web view was pooled
+ */
+- (BOOL) recycleView:(SXView *)view;
+
+/**
+ Allocates web views until the pool holds the given number of idle ones, capped by `maxCount`.
+ */
+- (void) warmUp:(NSUInteger)count;
+
+/**
+ Drops every idle web view.
+ */
+- (void) removeAllViews;
+
+@end
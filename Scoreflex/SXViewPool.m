@@ -0,0 +1,113 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXViewPool.h"
+#import "SXView_private.h"
+
+@interface SXViewPool ()
+
+/// Idle web views, the most recently recycled last
+@property (strong, nonatomic) NSMutableArray *webViews;
+
+@end
+
+@implementation SXViewPool
+
++ (SXViewPool *) sharedPool
+{
+    static SXViewPool *sharedPool = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedPool = [[SXViewPool alloc] init];
+    });
+    return sharedPool;
+}
+
+- (id) init
+{
+    if (self = [super init]) {
+        self.webViews = [[NSMutableArray alloc] init];
+        self.maxCount = PANEL_POOL_MAX_COUNT;
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(removeAllViews) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+    }
+    return self;
+}
+
+- (NSUInteger) count
+{
+    return self.webViews.count;
+}
+
+- (void) setMaxCount:(NSUInteger)maxCount
+{
+    _maxCount = maxCount;
+    if (self.webViews.count > maxCount)
+        [self.webViews removeObjectsInRange:NSMakeRange(0, self.webViews.count - maxCount)];
+}
+
+#pragma mark - Pooling
+
+- (SXView *) dequeueView
+{
+    // Each dequeue vends a new view, so that a handle kept by the game on a closed view never acts on another panel
+    UIWebView *webView = [self.webViews lastObject];
+    if (webView)
+        [self.webViews removeLastObject];
+
+    SXView *view = [[SXView alloc] initWithFrame:CGRectZero webView:webView];
+    view.reusable = YES;
+    return view;
+}
+
+- (BOOL) recycleView:(SXView *)view
+{
+    if (!view.reusable || view.viewController || view.superview)
+        return NO;
+
+    // The closed view stays blank and inert, whatever the game does with it later
+    view.reuseGeneration++;
+    view.reusable = NO;
+    view.reloadsOnLogin = NO;
+    view.delegate = nil;
+    UIWebView *webView = [view takeWebView];
+    if (!webView || self.webViews.count >= self.maxCount)
+        return NO;
+
+    [self.webViews addObject:webView];
+    return YES;
+}
+
+- (void) warmUp:(NSUInteger)count
+{
+    NSUInteger target = MIN(count, self.maxCount);
+    while (self.webViews.count < target)
+        [self.webViews addObject:[SXView newWebView]];
+}
+
+- (void) removeAllViews
+{
+    [self.webViews removeAllObjects];
+}
+
+- (void) dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+@end
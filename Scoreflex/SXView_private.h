@@ -38,6 +38,44 @@
  */
 -(void) userLoggedIn:(NSNotification *) notification;
 
+/**
+ Initializes a panel view around a web view taken from another view with `takeWebView`.
+ @param frame The frame of the view
+ @param webView The web view, or nil to create a new one
+ */
+- (id) initWithFrame:(CGRect)frame webView:(UIWebView *)webView;
+
+/**
+ Returns a new web view, configured like the ones of `SXView`.
+ */
++ (UIWebView *) newWebView;
+
+/**
+ Stops loading and blanks the web view, so that the view can be used for another resource without reallocating it.
+ */
+- (void) prepareForReuse;
+
+/**
+ Stops loading, blanks the web view and detaches it from the view, which shows nothing afterwards.
+ @return The web view, or nil if it has a history, which cannot be cleared
+ */
+- (UIWebView *) takeWebView;
+
+/// Set by the view pool on the views it vends, whose web view is recycled when closed
+@property (nonatomic, assign) BOOL reusable;
+
+/// Incremented by the view pool each time the view is recycled, for deferred work to check the view was not closed
+@property (nonatomic, assign) NSUInteger reuseGeneration;
+
+/// Whether the view reloads when the logged user changes, NO while it sits in the view pool
+@property (nonatomic, assign) BOOL reloadsOnLogin;
+
+/**
+ Reports that the player opened a resource, unless it is the one already shown, which happens when a full screen
+ view appears again after a modal dismissal or a return from the background.
+ */
+- (void) recordVisit:(NSString *)resource;
+
 
 @end
 
@@ -0,0 +1,72 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class SXPromise;
+
+/// Opens a connection to the API host, resolving its name and negotiating TLS ahead of the first request
+extern NSString * const SXWarmUpStepPreconnect;
+
+/// Computes the device identifier
+extern NSString * const SXWarmUpStepDeviceIdentifier;
+
+/// Decodes the requests saved in the request vault
+extern NSString * const SXWarmUpStepRequestVault;
+
+/// Not a step: the time `SX_NOTIFICATION_INITIALIZED` is posted
+extern NSString * const SXWarmUpMilestoneInitialized;
+
+/**
+ SXWarmUp runs the independent steps of a cold start concurrently when the client id is set, and keeps a
+ startup timeline: when each step began and ended, and when the SDK was initialized, relative to `start`.
+
+ The timeline is recorded as values of the `startup` group of `SXMetrics` and logged once the SDK is initialized.
+ */
+@interface SXWarmUp : NSObject
+
+/**
+ The shared warm-up
+ */
++ (SXWarmUp *) sharedWarmUp;
+
+/**
+ Resets the timeline and starts the warm-up steps. Called by `+[Scoreflex setClientId:secret:sandboxMode:]`.
+ @param baseURL The base URL of the API
+ @return A promise fulfilled once every step has ended. Steps do not fail, they only warm things up.
+ */
+- (SXPromise *) startWithBaseURL:(NSURL *)baseURL;
+
+/**
+ Returns step => {begin, end} in milliseconds since the start of the warm-up. Steps that have not ended yet have no end.
+ */
+- (NSDictionary *) timeline;
+
+/**
+ The time between the start of the warm-up and the initialization of the SDK in seconds, or a negative value
+ if the SDK is not initialized yet.
+ */
+@property (readonly, nonatomic) NSTimeInterval timeToInitialized;
+
+/**
+ A human readable dump of `timeline`
+ */
+- (NSString *) timelineDescription;
+
+@end
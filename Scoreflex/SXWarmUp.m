@@ -0,0 +1,222 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXWarmUp.h"
+#import "SXPromise.h"
+#import "SXMetrics.h"
+#import "SXUtil.h"
+#import "SXRequestVault.h"
+#import "Scoreflex.h"
+
+#define WARM_UP_METRICS_GROUP @"startup"
+#define WARM_UP_BEGIN_KEY @"begin"
+#define WARM_UP_END_KEY @"end"
+
+NSString * const SXWarmUpStepPreconnect = @"preconnect";
+NSString * const SXWarmUpStepDeviceIdentifier = @"deviceIdentifier";
+NSString * const SXWarmUpStepRequestVault = @"requestVault";
+NSString * const SXWarmUpMilestoneInitialized = @"initialized";
+
+@interface SXWarmUp ()
+
+@property (assign, nonatomic) NSTimeInterval startedAt;
+
+/// step => begin timestamp
+@property (strong, nonatomic) NSMutableDictionary *begins;
+
+/// step => end timestamp
+@property (strong, nonatomic) NSMutableDictionary *ends;
+
+@property (strong, nonatomic) NSOperationQueue *preconnectQueue;
+
+/**
+ Runs a step and records its begin and end in the timeline.
+ @param block Starts the step and returns a promise fulfilled when it ends
+ */
+- (SXPromise *) runStep:(NSString *)step block:(SXPromise *(^)(void))block;
+
+- (void) beginStep:(NSString *)step;
+
+- (void) endStep:(NSString *)step;
+
+- (SXPromise *) preconnectToURL:(NSURL *)baseURL;
+
+- (void) initialized:(NSNotification *)notification;
+
+@end
+
+@implementation SXWarmUp
+
++ (SXWarmUp *) sharedWarmUp
+{
+    static SXWarmUp *sharedWarmUp = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedWarmUp = [[SXWarmUp alloc] init];
+    });
+    return sharedWarmUp;
+}
+
+- (id) init
+{
+    if (self = [super init]) {
+        self.begins = [[NSMutableDictionary alloc] init];
+        self.ends = [[NSMutableDictionary alloc] init];
+        self.preconnectQueue = [[NSOperationQueue alloc] init];
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(initialized:) name:SX_NOTIFICATION_INITIALIZED object:nil];
+    }
+    return self;
+}
+
+- (void) dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+#pragma mark - Steps
+
+- (SXPromise *) startWithBaseURL:(NSURL *)baseURL
+{
+    @synchronized(self) {
+        self.startedAt = SXMetricsTimestamp();
+        [self.begins removeAllObjects];
+        [self.ends removeAllObjects];
+    }
+
+    NSArray *steps = @[[self runStep:SXWarmUpStepPreconnect block:^SXPromise *{
+                           return [self preconnectToURL:baseURL];
+                       }],
+                       [self runStep:SXWarmUpStepDeviceIdentifier block:^SXPromise *{
+                           return [SXUtil deviceIdentifierPromise];
+                       }],
+                       [self runStep:SXWarmUpStepRequestVault block:^SXPromise *{
+                           return [SXRequestVault loadSavedRequests];
+                       }]];
+    return [SXPromise all:steps];
+}
+
+- (SXPromise *) runStep:(NSString *)step block:(SXPromise *(^)(void))block
+{
+    [self beginStep:step];
+    return [block() done:^(id value, NSError *error) {
+        [self endStep:step];
+    }];
+}
+
+- (SXPromise *) preconnectToURL:(NSURL *)baseURL
+{
+    SXPromise *promise = [[SXPromise alloc] init];
+    if (!baseURL) {
+        [promise fulfill:nil];
+        return promise;
+    }
+
+    // Any answer leaves a resolved name, a TLS session and a kept-alive connection for the first API request
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:baseURL
+                                                           cachePolicy:NSURLRequestReloadIgnoringLocalCacheData
+                                                       timeoutInterval:WARM_UP_PRECONNECT_TIMEOUT];
+    request.HTTPMethod = @"HEAD";
+    [NSURLConnection sendAsynchronousRequest:request queue:self.preconnectQueue completionHandler:^(NSURLResponse *response, NSData *data, NSError *error) {
+        if (error)
+            SXLog(@"Could not pre-connect to %@: %@", baseURL, error);
+        [promise fulfill:nil];
+    }];
+    return promise;
+}
+
+#pragma mark - Timeline
+
+- (void) beginStep:(NSString *)step
+{
+    @synchronized(self) {
+        [self.begins setObject:[NSNumber numberWithDouble:SXMetricsTimestamp()] forKey:step];
+    }
+}
+
+- (void) endStep:(NSString *)step
+{
+    NSTimeInterval end = SXMetricsTimestamp();
+    NSTimeInterval startedAt = 0;
+    @synchronized(self) {
+        [self.ends setObject:[NSNumber numberWithDouble:end] forKey:step];
+        startedAt = self.startedAt;
+    }
+    [[SXMetrics sharedMetrics] recordValue:[NSNumber numberWithDouble:(end - startedAt) * 1000] metric:step group:WARM_UP_METRICS_GROUP];
+}
+
+- (void) initialized:(NSNotification *)notification
+{
+    @synchronized(self) {
+        if (!self.startedAt || [self.ends objectForKey:SXWarmUpMilestoneInitialized])
+            return;
+    }
+
+    [self beginStep:SXWarmUpMilestoneInitialized];
+    [self endStep:SXWarmUpMilestoneInitialized];
+    SXLog(@"Startup timeline:\n%@", [self timelineDescription]);
+}
+
+- (NSTimeInterval) timeToInitialized
+{
+    @synchronized(self) {
+        NSNumber *end = [self.ends objectForKey:SXWarmUpMilestoneInitialized];
+        return end ? end.doubleValue - self.startedAt : -1;
+    }
+}
+
+- (NSDictionary *) timeline
+{
+    NSMutableDictionary *result = [NSMutableDictionary dictionary];
+    @synchronized(self) {
+        for (NSString *step in self.begins) {
+            NSMutableDictionary *entry = [NSMutableDictionary dictionary];
+            [entry setObject:[NSNumber numberWithDouble:([[self.begins objectForKey:step] doubleValue] - self.startedAt) * 1000] forKey:WARM_UP_BEGIN_KEY];
+            NSNumber *end = [self.ends objectForKey:step];
+            if (end)
+                [entry setObject:[NSNumber numberWithDouble:(end.doubleValue - self.startedAt) * 1000] forKey:WARM_UP_END_KEY];
+            [result setObject:entry forKey:step];
+        }
+    }
+    return result;
+}
+
+- (NSString *) timelineDescription
+{
+    NSDictionary *timeline = [self timeline];
+    NSArray *steps = [timeline keysSortedByValueUsingComparator:^NSComparisonResult(NSDictionary *entry1, NSDictionary *entry2) {
+        NSNumber *end1 = [entry1 objectForKey:WARM_UP_END_KEY];
+        NSNumber *end2 = [entry2 objectForKey:WARM_UP_END_KEY];
+        if (!end1 || !end2)
+            return end1 ? NSOrderedAscending : (end2 ? NSOrderedDescending : NSOrderedSame);
+        return [end1 compare:end2];
+    }];
+
+    NSMutableString *result = [NSMutableString string];
+    for (NSString *step in steps) {
+        NSDictionary *entry = [timeline objectForKey:step];
+        NSNumber *end = [entry objectForKey:WARM_UP_END_KEY];
+        if (end)
+            [result appendFormat:@"  %-18s %8.2fms - %8.2fms\n", step.UTF8String, [[entry objectForKey:WARM_UP_BEGIN_KEY] doubleValue], end.doubleValue];
+        else
+            [result appendFormat:@"  %-18s %8.2fms - pending\n", step.UTF8String, [[entry objectForKey:WARM_UP_BEGIN_KEY] doubleValue]];
+    }
+    return result;
+}
+
+@end
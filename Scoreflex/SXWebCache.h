@@ -0,0 +1,102 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ SXWebCache is the on-disk store behind `SXWebCacheProtocol`. It keeps the responses of Scoreflex web resources in a
+ directory of the caches folder named after the SDK version, so that an update of the SDK starts with a clean store.
+
+ Bodies are content addressed: they are saved under the SHA-1 of their bytes, and an index maps each URL to its body,
+ status and headers. Assets shared by several pages are stored once. The least recently used entries are removed when
+ the store grows over `WEB_CACHE_MAX_SIZE` bytes.
+
+ All methods are thread safe.
+ */
+@interface SXWebCache : NSObject
+
+/**
+ The shared cache, stored in the caches folder of the application
+ */
++ (SXWebCache *) sharedCache;
+
+/**
+ Initializes a cache stored in the given directory, which is created if needed.
+ */
+- (id) initWithDirectory:(NSString *)directory;
+
+/// The directory holding the index and the bodies
+@property (readonly, nonatomic) NSString *directory;
+
+/// The maximum size of the stored bodies, in bytes
+@property (assign, nonatomic) NSUInteger maxSize;
+
+/// The size of the stored bodies, in bytes
+@property (readonly) NSUInteger size;
+
+/**
+ Returns the key under which the response to the given URL is stored: the URL without its fragment, and without the
+ query parameters that change between loads of the same page.
+ */
++ (NSString *) keyForURL:(NSURL *)URL;
+
+///---------------------
+/// @name Entries
+///---------------------
+
+/**
+ Returns the stored response for the given URL, or nil.
+ */
+- (NSCachedURLResponse *) cachedResponseForURL:(NSURL *)URL;
+
+/**
+ Stores a response and its body.
+ @param response The response, only successful HTTP responses are stored
+ @param data The body of the response
+ @param shell YES for web pages, which are only served when the network is unavailable
+ */
+- (void) storeResponse:(NSHTTPURLResponse *)response data:(NSData *)data shell:(BOOL)shell;
+
+/**
+ Returns the date at which the entry of the given URL was last fetched or revalidated, or nil.
+ */
+- (NSDate *) validationDateForURL:(NSURL *)URL;
+
+/**
+ Marks the entry of the given URL as fresh, after the server answered that it did not change.
+ */
+- (void) markValidatedForURL:(NSURL *)URL;
+
+/**
+ Removes the stored web pages, which hold data of the current player.
+ */
+- (void) removeShells;
+
+/**
+ Removes every entry.
+ */
+- (void) removeAllEntries;
+
+/**
+ Writes the index now if it has changes. Changes are otherwise written `WEB_CACHE_SAVE_DELAY` seconds after the first
+ one, and when the application enters the background.
+ */
+- (void) flush;
+
+@end
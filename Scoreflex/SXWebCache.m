@@ -0,0 +1,363 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXWebCache.h"
+#import <UIKit/UIKit.h>
+#import <CommonCrypto/CommonCrypto.h>
+
+#define WEB_CACHE_INDEX_FILE @"index.plist"
+#define WEB_CACHE_HASH_KEY @"hash"
+#define WEB_CACHE_LENGTH_KEY @"length"
+#define WEB_CACHE_STATUS_KEY @"status"
+#define WEB_CACHE_HEADERS_KEY @"headers"
+#define WEB_CACHE_SHELL_KEY @"shell"
+#define WEB_CACHE_ACCESSED_KEY @"accessed"
+#define WEB_CACHE_VALIDATED_KEY @"validated"
+
+static dispatch_queue_t sx_web_cache_save_queue() {
+    static dispatch_queue_t sx_web_cache_save_queue;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sx_web_cache_save_queue = dispatch_queue_create("com.scoreflex.webcache.save", DISPATCH_QUEUE_SERIAL);
+    });
+
+    return sx_web_cache_save_queue;
+}
+
+@interface SXWebCache ()
+
+/// key => entry dictionary, as stored in the index file
+@property (strong, nonatomic) NSMutableDictionary *entries;
+
+/// The hashes of the stored bodies, counted once per entry using them
+@property (strong, nonatomic) NSCountedSet *hashes;
+
+/// The size of the stored bodies, kept up to date as entries are added and removed
+@property (assign, nonatomic) NSUInteger storedSize;
+
+/// YES when the index has changes that are not written yet
+@property (assign, nonatomic) BOOL dirty;
+
+/// YES while a write of the index is scheduled
+@property (assign, nonatomic) BOOL saveScheduled;
+
+@property (strong, nonatomic) NSString *directory;
+
+- (NSString *) pathForHash:(NSString *)hash;
+
+- (void) addEntry:(NSMutableDictionary *)entry forKey:(NSString *)key;
+
+- (void) removeEntryForKey:(NSString *)key;
+
+/// Releases the body of an entry removed from the index, deleting it unless another entry has the same content
+- (void) releaseBodyOfEntry:(NSDictionary *)entry;
+
+- (void) trimToSize:(NSUInteger)size;
+
+/// Schedules a write of the index, so that a burst of changes is written once. Called while synchronized.
+- (void) save;
+
+/// Writes the index if it changed. Called on the save queue.
+- (void) writeIndex;
+
+@end
+
+@implementation SXWebCache
+
++ (SXWebCache *) sharedCache
+{
+    static SXWebCache *sharedCache = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSString *caches = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+        NSString *root = [caches stringByAppendingPathComponent:@"ScoreflexWebCache"];
+
+        // Stores of previous SDK versions are not used anymore
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        for (NSString *version in [fileManager contentsOfDirectoryAtPath:root error:nil]) {
+            if (![version isEqualToString:SDX_VERSION])
+                [fileManager removeItemAtPath:[root stringByAppendingPathComponent:version] error:nil];
+        }
+
+        sharedCache = [[SXWebCache alloc] initWithDirectory:[root stringByAppendingPathComponent:SDX_VERSION]];
+    });
+    return sharedCache;
+}
+
+- (id) initWithDirectory:(NSString *)directory
+{
+    if (self = [super init]) {
+        self.directory = directory;
+        self.maxSize = WEB_CACHE_MAX_SIZE;
+        [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+
+        NSDictionary *saved = [NSDictionary dictionaryWithContentsOfFile:[directory stringByAppendingPathComponent:WEB_CACHE_INDEX_FILE]];
+        self.entries = [NSMutableDictionary dictionaryWithCapacity:saved.count];
+        self.hashes = [[NSCountedSet alloc] init];
+        for (NSString *key in saved)
+            [self addEntry:[[saved objectForKey:key] mutableCopy] forKey:key];
+
+        // Pending changes are written before the application may be killed
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(flush) name:UIApplicationDidEnterBackgroundNotification object:nil];
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(flush) name:UIApplicationWillTerminateNotification object:nil];
+    }
+    return self;
+}
+
+- (void) dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
++ (NSString *) keyForURL:(NSURL *)URL
+{
+    NSString *key = URL.absoluteString;
+    NSRange fragment = [key rangeOfString:@"#"];
+    if (NSNotFound != fragment.location)
+        key = [key substringToIndex:fragment.location];
+
+    NSRange query = [key rangeOfString:@"?"];
+    if (NSNotFound == query.location)
+        return key;
+
+    // The location is sent with every request and would make every load a miss
+    NSMutableArray *kept = [NSMutableArray array];
+    for (NSString *component in [[key substringFromIndex:query.location + 1] componentsSeparatedByString:@"&"]) {
+        if (![component hasPrefix:@"location="])
+            [kept addObject:component];
+    }
+    key = [key substringToIndex:query.location];
+    return kept.count ? [NSString stringWithFormat:@"%@?%@", key, [kept componentsJoinedByString:@"&"]] : key;
+}
+
+- (NSUInteger) size
+{
+    @synchronized(self) {
+        return self.storedSize;
+    }
+}
+
+- (NSString *) pathForHash:(NSString *)hash
+{
+    return [self.directory stringByAppendingPathComponent:hash];
+}
+
+#pragma mark - Entries
+
+- (NSCachedURLResponse *) cachedResponseForURL:(NSURL *)URL
+{
+    NSString *key = [[self class] keyForURL:URL];
+    @synchronized(self) {
+        NSMutableDictionary *entry = [self.entries objectForKey:key];
+        if (!entry)
+            return nil;
+
+        NSData *data = [NSData dataWithContentsOfFile:[self pathForHash:[entry objectForKey:WEB_CACHE_HASH_KEY]]];
+        if (!data) {
+            // The body was purged by the system
+            [self removeEntryForKey:key];
+            [self save];
+            return nil;
+        }
+
+        [entry setObject:[NSDate date] forKey:WEB_CACHE_ACCESSED_KEY];
+        NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:URL
+                                                                  statusCode:[[entry objectForKey:WEB_CACHE_STATUS_KEY] integerValue]
+                                                                 HTTPVersion:@"HTTP/1.1"
+                                                                headerFields:[entry objectForKey:WEB_CACHE_HEADERS_KEY]];
+        return [[NSCachedURLResponse alloc] initWithResponse:response data:data userInfo:nil storagePolicy:NSURLCacheStorageNotAllowed];
+    }
+}
+
+- (void) storeResponse:(NSHTTPURLResponse *)response data:(NSData *)data shell:(BOOL)shell
+{
+    if (!data || response.statusCode < 200 || response.statusCode >= 300)
+        return;
+    if (data.length > self.maxSize)
+        return;
+
+    unsigned char digest[CC_SHA1_DIGEST_LENGTH];
+    CC_SHA1(data.bytes, (CC_LONG)data.length, digest);
+    NSMutableString *hash = [NSMutableString stringWithCapacity:CC_SHA1_DIGEST_LENGTH * 2];
+    for (int i = 0; i < CC_SHA1_DIGEST_LENGTH; i++)
+        [hash appendFormat:@"%02x", digest[i]];
+
+    // The body is stored decoded
+    NSMutableDictionary *headers = [NSMutableDictionary dictionaryWithDictionary:response.allHeaderFields];
+    [headers removeObjectForKey:@"Content-Encoding"];
+    [headers setObject:[NSString stringWithFormat:@"%lu", (unsigned long)data.length] forKey:@"Content-Length"];
+
+    NSString *key = [[self class] keyForURL:response.URL];
+    NSDate *now = [NSDate date];
+    @synchronized(self) {
+        NSString *path = [self pathForHash:hash];
+        if (![[NSFileManager defaultManager] fileExistsAtPath:path] && ![data writeToFile:path atomically:YES]) {
+            SXLog(@"Could not store web resource %@", key);
+            return;
+        }
+
+        // The new entry is counted before the previous one is released, as they may share their body
+        NSDictionary *previous = [self.entries objectForKey:key];
+        [self addEntry:[NSMutableDictionary dictionaryWithObjectsAndKeys:
+                        hash, WEB_CACHE_HASH_KEY,
+                        [NSNumber numberWithUnsignedInteger:data.length], WEB_CACHE_LENGTH_KEY,
+                        [NSNumber numberWithInteger:response.statusCode], WEB_CACHE_STATUS_KEY,
+                        headers, WEB_CACHE_HEADERS_KEY,
+                        [NSNumber numberWithBool:shell], WEB_CACHE_SHELL_KEY,
+                        now, WEB_CACHE_ACCESSED_KEY,
+                        now, WEB_CACHE_VALIDATED_KEY,
+                        nil]
+                forKey:key];
+        if (previous)
+            [self releaseBodyOfEntry:previous];
+        [self trimToSize:self.maxSize];
+        [self save];
+    }
+}
+
+- (NSDate *) validationDateForURL:(NSURL *)URL
+{
+    NSString *key = [[self class] keyForURL:URL];
+    @synchronized(self) {
+        return [[self.entries objectForKey:key] objectForKey:WEB_CACHE_VALIDATED_KEY];
+    }
+}
+
+- (void) markValidatedForURL:(NSURL *)URL
+{
+    NSString *key = [[self class] keyForURL:URL];
+    @synchronized(self) {
+        NSMutableDictionary *entry = [self.entries objectForKey:key];
+        if (!entry)
+            return;
+        [entry setObject:[NSDate date] forKey:WEB_CACHE_VALIDATED_KEY];
+        [self save];
+    }
+}
+
+- (void) removeShells
+{
+    @synchronized(self) {
+        for (NSString *key in self.entries.allKeys) {
+            if ([[[self.entries objectForKey:key] objectForKey:WEB_CACHE_SHELL_KEY] boolValue])
+                [self removeEntryForKey:key];
+        }
+        [self save];
+    }
+}
+
+- (void) removeAllEntries
+{
+    @synchronized(self) {
+        for (NSString *key in self.entries.allKeys)
+            [self removeEntryForKey:key];
+        [self save];
+    }
+}
+
+#pragma mark - Housekeeping
+
+- (void) addEntry:(NSMutableDictionary *)entry forKey:(NSString *)key
+{
+    NSString *hash = [entry objectForKey:WEB_CACHE_HASH_KEY];
+    if (!hash)
+        return;
+
+    // Bodies shared by several entries are only counted once
+    if (![self.hashes countForObject:hash])
+        self.storedSize += [[entry objectForKey:WEB_CACHE_LENGTH_KEY] unsignedIntegerValue];
+    [self.hashes addObject:hash];
+    [self.entries setObject:entry forKey:key];
+}
+
+- (void) removeEntryForKey:(NSString *)key
+{
+    NSDictionary *entry = [self.entries objectForKey:key];
+    if (!entry)
+        return;
+
+    [self.entries removeObjectForKey:key];
+    [self releaseBodyOfEntry:entry];
+}
+
+- (void) releaseBodyOfEntry:(NSDictionary *)entry
+{
+    NSString *hash = [entry objectForKey:WEB_CACHE_HASH_KEY];
+    if (!hash)
+        return;
+
+    [self.hashes removeObject:hash];
+    if ([self.hashes countForObject:hash])
+        return;
+    self.storedSize -= MIN(self.storedSize, [[entry objectForKey:WEB_CACHE_LENGTH_KEY] unsignedIntegerValue]);
+    [[NSFileManager defaultManager] removeItemAtPath:[self pathForHash:hash] error:nil];
+}
+
+- (void) trimToSize:(NSUInteger)size
+{
+    if (self.storedSize <= size)
+        return;
+
+    NSArray *keys = [self.entries keysSortedByValueUsingComparator:^NSComparisonResult(NSDictionary *a, NSDictionary *b) {
+        return [[a objectForKey:WEB_CACHE_ACCESSED_KEY] compare:[b objectForKey:WEB_CACHE_ACCESSED_KEY]];
+    }];
+    for (NSString *key in keys) {
+        if (self.storedSize <= size)
+            break;
+        SXLog(@"Evicting cached web resource %@", key);
+        [self removeEntryForKey:key];
+    }
+}
+
+- (void) save
+{
+    self.dirty = YES;
+    if (self.saveScheduled)
+        return;
+
+    self.saveScheduled = YES;
+    __weak SXWebCache *weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(WEB_CACHE_SAVE_DELAY * NSEC_PER_SEC)), sx_web_cache_save_queue(), ^{
+        [weakSelf writeIndex];
+    });
+}
+
+- (void) writeIndex
+{
+    NSDictionary *index;
+    @synchronized(self) {
+        self.saveScheduled = NO;
+        if (!self.dirty)
+            return;
+        self.dirty = NO;
+        index = [[NSDictionary alloc] initWithDictionary:self.entries copyItems:YES];
+    }
+
+    // Writes are serialized by the save queue, so an older index never replaces a newer one
+    [index writeToFile:[self.directory stringByAppendingPathComponent:WEB_CACHE_INDEX_FILE] atomically:YES];
+}
+
+- (void) flush
+{
+    dispatch_sync(sx_web_cache_save_queue(), ^{
+        [self writeIndex];
+    });
+}
+
+@end
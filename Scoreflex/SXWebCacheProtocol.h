@@ -0,0 +1,45 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ SXWebCacheProtocol serves the Scoreflex web resources loaded by `SXView` from `SXWebCache`.
+
+ - Static assets (style sheets, scripts, images and fonts) are served from the cache when present. They are then
+   revalidated in the background, at most every `WEB_CACHE_REVALIDATE_INTERVAL` seconds, and the next load gets the
+   new version if they changed.
+ - Web pages are always fetched, and stored. The stored page is only served when the network is unavailable, so that
+   views open offline with their last known content instead of an error.
+
+ The protocol is registered by `+[Scoreflex setClientId:secret:sandboxMode:]`.
+ */
+@interface SXWebCacheProtocol : NSURLProtocol
+
+/**
+ Returns YES if the URL is a static asset, which is served from the cache first.
+ */
++ (BOOL) isStaticAssetURL:(NSURL *)URL;
+
+/**
+ Returns YES if the URL is a Scoreflex web page, which is served from the cache only when offline.
+ */
++ (BOOL) isShellURL:(NSURL *)URL;
+
+@end
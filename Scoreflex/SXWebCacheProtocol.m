@@ -0,0 +1,217 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXWebCacheProtocol.h"
+#import "SXWebCache.h"
+#import "SXUtil.h"
+#import "SXMetrics.h"
+
+static NSString * const SXWebCacheHandledKey = @"SXWebCacheHandled";
+
+@interface SXWebCacheProtocol () <NSURLConnectionDataDelegate>
+
+@property (strong, nonatomic) NSURLConnection *connection;
+
+@property (strong, nonatomic) NSHTTPURLResponse *response;
+
+@property (strong, nonatomic) NSMutableData *data;
+
+/**
+ Sends the given stored response to the client.
+ */
+- (void) serveCachedResponse:(NSCachedURLResponse *)cachedResponse;
+
+/**
+ Asks the server whether the stored version of the request's resource is still current, and stores the new version
+ if not.
+ */
++ (void) revalidateRequest:(NSURLRequest *)request;
+
+@end
+
+@implementation SXWebCacheProtocol
+
++ (BOOL) isStaticAssetURL:(NSURL *)URL
+{
+    static NSSet *extensions = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        extensions = [NSSet setWithObjects:@"css", @"js", @"png", @"jpg", @"jpeg", @"gif", @"svg", @"ico", @"woff", @"ttf", @"otf", nil];
+    });
+    return [extensions containsObject:URL.pathExtension.lowercaseString];
+}
+
++ (BOOL) isShellURL:(NSURL *)URL
+{
+    return [[SXUtil resourceForScoreflexURL:URL] hasPrefix:@"web/"];
+}
+
+#pragma mark - NSURLProtocol
+
++ (BOOL) canInitWithRequest:(NSURLRequest *)request
+{
+    if ([NSURLProtocol propertyForKey:SXWebCacheHandledKey inRequest:request])
+        return NO;
+    if (![@"GET" isEqualToString:request.HTTPMethod])
+        return NO;
+
+    NSString *scheme = request.URL.scheme.lowercaseString;
+    if (![@"http" isEqualToString:scheme] && ![@"https" isEqualToString:scheme])
+        return NO;
+
+    if ([self isShellURL:request.URL])
+        return YES;
+
+    // Assets are cached when loaded by a Scoreflex page, wherever they are hosted
+    return [self isStaticAssetURL:request.URL]
+        && ([SXUtil isScoreflexURL:request.URL] || (request.mainDocumentURL && [SXUtil isScoreflexURL:request.mainDocumentURL]));
+}
+
++ (NSURLRequest *) canonicalRequestForRequest:(NSURLRequest *)request
+{
+    return request;
+}
+
+- (void) startLoading
+{
+    NSURL *URL = self.request.URL;
+    if (![[self class] isShellURL:URL]) {
+        NSCachedURLResponse *cachedResponse = [[SXWebCache sharedCache] cachedResponseForURL:URL];
+        if (cachedResponse) {
+            [self serveCachedResponse:cachedResponse];
+            [[self class] revalidateRequest:self.request];
+            return;
+        }
+    }
+
+    NSMutableURLRequest *request = [self.request mutableCopy];
+    [NSURLProtocol setProperty:@YES forKey:SXWebCacheHandledKey inRequest:request];
+    self.connection = [NSURLConnection connectionWithRequest:request delegate:self];
+}
+
+- (void) stopLoading
+{
+    [self.connection cancel];
+    self.connection = nil;
+}
+
+- (void) serveCachedResponse:(NSCachedURLResponse *)cachedResponse
+{
+    SXLog(@"Serving %@ from the web cache", self.request.URL);
+    [[[SXMetrics sharedMetrics] viewLoadForURL:self.request.URL] receivedFirstByteFromCache:YES];
+    [self.client URLProtocol:self didReceiveResponse:cachedResponse.response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+    [self.client URLProtocol:self didLoadData:cachedResponse.data];
+    [self.client URLProtocolDidFinishLoading:self];
+}
+
++ (void) revalidateRequest:(NSURLRequest *)request
+{
+    SXWebCache *cache = [SXWebCache sharedCache];
+    NSDate *validated = [cache validationDateForURL:request.URL];
+    if (validated && -[validated timeIntervalSinceNow] < WEB_CACHE_REVALIDATE_INTERVAL)
+        return;
+
+    // Mark it right away so that the pages loading the same asset don't revalidate it again
+    [cache markValidatedForURL:request.URL];
+
+    NSHTTPURLResponse *cachedResponse = (NSHTTPURLResponse *)[cache cachedResponseForURL:request.URL].response;
+    NSMutableURLRequest *revalidation = [request mutableCopy];
+    revalidation.cachePolicy = NSURLRequestReloadIgnoringLocalCacheData;
+    [NSURLProtocol setProperty:@YES forKey:SXWebCacheHandledKey inRequest:revalidation];
+    NSString *ETag = [cachedResponse.allHeaderFields objectForKey:@"Etag"];
+    if (ETag)
+        [revalidation setValue:ETag forHTTPHeaderField:@"If-None-Match"];
+    NSString *lastModified = [cachedResponse.allHeaderFields objectForKey:@"Last-Modified"];
+    if (lastModified)
+        [revalidation setValue:lastModified forHTTPHeaderField:@"If-Modified-Since"];
+
+    static NSOperationQueue *queue = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        queue = [[NSOperationQueue alloc] init];
+        queue.maxConcurrentOperationCount = 1;
+    });
+
+    [NSURLConnection sendAsynchronousRequest:revalidation queue:queue completionHandler:^(NSURLResponse *response, NSData *data, NSError *error) {
+        if (error || ![response isKindOfClass:[NSHTTPURLResponse class]])
+            return;
+
+        NSHTTPURLResponse *HTTPResponse = (NSHTTPURLResponse *)response;
+        if (200 == HTTPResponse.statusCode) {
+            SXLog(@"Web resource %@ changed", request.URL);
+            [cache storeResponse:HTTPResponse data:data shell:NO];
+        }
+    }];
+}
+
+#pragma mark - NSURLConnectionDataDelegate
+
+- (NSURLRequest *) connection:(NSURLConnection *)connection willSendRequest:(NSURLRequest *)request redirectResponse:(NSURLResponse *)redirectResponse
+{
+    if (!redirectResponse)
+        return request;
+
+    // Let the client follow the redirection, through this protocol again if it applies
+    NSMutableURLRequest *redirect = [request mutableCopy];
+    [NSURLProtocol removePropertyForKey:SXWebCacheHandledKey inRequest:redirect];
+    [self.client URLProtocol:self wasRedirectedToRequest:redirect redirectResponse:redirectResponse];
+    [connection cancel];
+    [self.client URLProtocol:self didFailWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil]];
+    return nil;
+}
+
+- (void) connection:(NSURLConnection *)connection didReceiveResponse:(NSURLResponse *)response
+{
+    if ([response isKindOfClass:[NSHTTPURLResponse class]])
+        self.response = (NSHTTPURLResponse *)response;
+    self.data = [NSMutableData data];
+    [[[SXMetrics sharedMetrics] viewLoadForURL:self.request.URL] receivedFirstByteFromCache:NO];
+    [self.client URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+}
+
+- (void) connection:(NSURLConnection *)connection didReceiveData:(NSData *)data
+{
+    [self.data appendData:data];
+    [self.client URLProtocol:self didLoadData:data];
+}
+
+- (void) connectionDidFinishLoading:(NSURLConnection *)connection
+{
+    if (self.response)
+        [[SXWebCache sharedCache] storeResponse:self.response data:self.data shell:[[self class] isShellURL:self.request.URL]];
+    self.connection = nil;
+    [self.client URLProtocolDidFinishLoading:self];
+}
+
+- (void) connection:(NSURLConnection *)connection didFailWithError:(NSError *)error
+{
+    self.connection = nil;
+
+    // Offline: open the page with its last known content, unless part of it was already sent
+    if (!self.data) {
+        NSCachedURLResponse *cachedResponse = [[SXWebCache sharedCache] cachedResponseForURL:self.request.URL];
+        if (cachedResponse) {
+            [self serveCachedResponse:cachedResponse];
+            return;
+        }
+    }
+    [self.client URLProtocol:self didFailWithError:error];
+}
+
+@end
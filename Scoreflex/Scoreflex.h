@@ -21,6 +21,7 @@
 #import <CoreLocation/CoreLocation.h>
 #import "SXResponse.h"
 #import "SXView.h"
+#import "SXPromise.h"
 
 /**
  @enum SXGravity enumeration to use for the gravity of scoreflex panels
@@ -30,6 +31,23 @@ typedef enum {
     SXGravityTop,
 } SXGravity;
 
+/**
+ @enum SXScoreOrder the sort order of a leaderboard
+ */
+typedef enum {
+    SXScoreOrderDescending,
+    SXScoreOrderAscending,
+} SXScoreOrder;
+
+/**
+ @enum SXScorePolicy what to do with a submitted score that does not improve the player's best score
+ */
+typedef enum {
+    SXScorePolicySubmit,
+    SXScorePolicyDefer,
+    SXScorePolicySkip,
+} SXScorePolicy;
+
 /**
  Name of the notification that is sent using NSNotificationCenter sent when a challenge must be started
  */
@@ -284,11 +302,52 @@ typedef enum {
  */
 + (void) submitScore:(NSString *) leaderboardId params:(id) params handler:(void(^)(SXResponse *response, NSError *error))handler;
 
+/**
+ Sets the sort order of a leaderboard, used to decide whether a submitted score improves the player's best score.
+ Leaderboards are descending (higher is better) by default.
+ @param order The sort order
+ @param leaderboardId The identifier of the leaderboard
+ */
++ (void) setScoreOrder:(SXScoreOrder)order forLeaderboard:(NSString *)leaderboardId;
+
+/**
+ Sets what to do with submitted scores that cannot change the player's ranking.
+
+ - `SXScorePolicySubmit` (default): post every score right away
+ - `SXScorePolicyDefer`: keep non-improving scores locally and post them later, each with its own request, once 10 of
+   them are kept, when the application enters the background or on `flushDeferredScores`
+ - `SXScorePolicySkip`: drop non-improving scores
+
+ When a score is deferred or skipped, the submission handler is called right away with a nil response and a nil error,
+ instead of the response of the API.
+ @param policy The policy
+ */
++ (void) setScorePolicy:(SXScorePolicy)policy;
+
+/**
+ Sets whether requests saved with postEventually and deferred scores are only replayed over Wi-Fi.
+ Requests made directly are not affected. Defaults to NO.
+ @param defers YES to wait for a Wi-Fi connection before replaying saved requests
+ */
++ (void) setDefersRequestReplayOnCellular:(BOOL)defers;
+
+/**
+ Returns the best score submitted from this device by the current player, or nil if none was submitted.
+ @param leaderboardId The identifier of the leaderboard
+ */
++ (NSNumber *) bestScoreForLeaderboard:(NSString *)leaderboardId;
+
+/**
+ Posts the scores deferred by the `SXScorePolicyDefer` policy now.
+ */
++ (void) flushDeferredScores;
+
 /**
  Submit a score to a leaderboard and call handler
  @param leaderboardId The identifier for the level the user just finished
  @param params A key-value coding compliant object that returns an NSString for the `score` key.
  @param gravity Determines where the widget will be attached (SXGravityTop or SXGravityBottom).
+ @return The panel, attached right away. It loads the ranks once the score is submitted, or after a few seconds without an answer.
  */
 + (UIView *) submitScoreAndShowRanksPanel:(NSString*) leaderboardId params:(id) params gravity:(SXGravity)gravity;
 
@@ -302,7 +361,8 @@ typedef enum {
 
 
 /**
- End the turn of a challenge and show challenge detail
+ End the turn of a challenge and show challenge detail. The detail view is prepared while the turn is submitted, and
+ presented once it is, or after a few seconds without an answer.
  @param challengeInstanceId The identifier of the challenge
  @param params A key-value coding compliant object
  */
@@ -509,35 +569,45 @@ typedef enum {
 /// @name Accessing the Scoreflex REST API
 ///---------------------------------------
 
+/**
+ Sets the queue the handlers of the REST API calls are called on, for games running their logic off the main thread.
+ Responses are processed on a background queue either way. Defaults to the main queue.
+ @param queue The callback queue, or NULL for the main queue
+ */
++ (void) setCallbackQueue:(dispatch_queue_t)queue;
+
 
 /**
  Perform a GET request to the API
  @param resource The relative resource path, ommiting the first "/" and ommiting the API version number.
     Example: `scores/best`
  @param params A dictionary with parameter names and corresponding values to be serialized as query string parameters.
- @param handler A block to be executed when the request is done executing.
+ @param handler A block to be executed when the request is done executing, may be nil.
+ @return A promise of the `SXResponse`, settled after the handler is called.
  */
 
-+ (void) get:(NSString *)resource params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler;
++ (SXPromise *) get:(NSString *)resource params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler;
 
 /**
  Perform a POST request to the API
  @param resource The relative resource path, ommiting the first "/" and ommiting the API version number.
  Example: `scores/best`
  @param params A dictionary with parameter names and corresponding values that will constitute the POST request's body.
- @param handler A block to be executed when the request is done executing.
+ @param handler A block to be executed when the request is done executing, may be nil.
+ @return A promise of the `SXResponse`, settled after the handler is called.
  */
 
-+ (void) post:(NSString *)resource params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler;
++ (SXPromise *) post:(NSString *)resource params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler;
 
 /**
  Perform a DELETE request to the API
  @param resource The relative resource path, ommiting the first "/" and ommiting the API version number.
  @param params A dictionary with parameter names and corresponding values to be serialized as query string parameters.
- @param handler A block to be executed when the request is done executing.
+ @param handler A block to be executed when the request is done executing, may be nil.
+ @return A promise of the `SXResponse`, settled after the handler is called.
  */
 
-+ (void) delete:(NSString *)resource params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler;
++ (SXPromise *) delete:(NSString *)resource params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler;
 
 /**
  Perform a POST request to the API, retrying later (even after application restarts) in the case of a network error.
@@ -545,18 +615,20 @@ typedef enum {
  Example: `scores/best`
  @param params A dictionary with parameter names and corresponding values that will constitute the POST request's body.
  @param handler A block to be executed when the request is done executing. Note that this handler will not be executed if the request completes after a network error.
+ @return A promise of the `SXResponse`, settled after the handler is called.
  */
 
-+ (void) postEventually:(NSString *)resource params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler;
++ (SXPromise *) postEventually:(NSString *)resource params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler;
 
 /**
  Perform a PUT request to the API
  @param resource The relative resource path, ommiting the first "/" and ommiting the API version number.
  Example: `scores/best`
  @param params A dictionary with parameter names and corresponding values that will constitute the POST request's body.
- @param handler A block to be executed when the request is done executing.
+ @param handler A block to be executed when the request is done executing, may be nil.
+ @return A promise of the `SXResponse`, settled after the handler is called.
  */
-+ (void) put:(NSString *)resource params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler;
++ (SXPromise *) put:(NSString *)resource params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler;
 
 
 ///----------------
@@ -622,7 +694,8 @@ typedef enum {
 ///-------------------------
 
 /**
- Preload the specified resource in a hidden webview and hold a reference of it untill it is shown or freed
+ Preload the specified resource in a hidden webview and hold a reference of it untill it is shown, freed or evicted
+ to make room for other preloaded resources
  @param resource The path of the resource to preload
  */
 + (void) preloadResource:(NSString *) resource;
@@ -633,6 +706,37 @@ typedef enum {
  */
 + (void) freePreloadedResource:(NSString *) resource;
 
+/**
+ Sets how many resources can be preloaded at once, and how much memory their web views may use. The least recently
+ used preloaded resources are freed first when over budget. Defaults to 3 resources and 16 MB.
+ @param maxCount The maximum number of preloaded resources
+ @param maxBytes The estimated memory budget in bytes, 0 for no limit
+ */
++ (void) setPreloadBudget:(NSUInteger)maxCount memory:(NSUInteger)maxBytes;
+
+/**
+ Allocates panel views and their web views ahead of time, so that the next panels are shown without the cost of
+ creating them. Call it during a loading screen. The web views of closed panel views are also kept and reused, up
+ to 2 of them; a closed panel view stays blank and must not be shown again.
+ @param count The number of panel views to prepare, capped by 2
+ */
++ (void) warmUpPanelViews:(NSUInteger)count;
+
+/**
+ Enables or disables predictive preloading. The SDK learns which resources players open one after the other, and
+ preloads the most likely next resource when there is room in the preload budget and the network is fast enough.
+ Enabled by default.
+ @param enabled NO to only preload the resources given to `preloadResource:`
+ */
++ (void) setPredictivePreloadingEnabled:(BOOL)enabled;
+
+/**
+ Returns how well predictive preloading performs: the number of `predictions`, of `hits` (predictions matching the
+ next resource opened) and of `transitionCount` (resources opened after another), and the resulting `precision` and
+ `recall` between 0 and 1.
+ */
++ (NSDictionary *) preloadPredictionStatistics;
+
 
 ///-------------------------
 /// @name Handling Apple Push Notifications
@@ -666,6 +770,8 @@ typedef enum {
         }
     }
 
+ Notifications received in a burst are merged by code and target, and only the highest priority one opens a view.
+
  @param the notification dictionnary
  */
 + (BOOL) handleNotification:(NSDictionary*) notificationDictionnary;
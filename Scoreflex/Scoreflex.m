@@ -24,18 +24,31 @@
 #import <QuartzCore/QuartzCore.h>
 #import "SXGooglePlusUtil.h"
 #import "SXFacebookUtil.h"
+#import "SXScoreIndex.h"
+#import "SXNetworkPolicy.h"
+#import "SXPromise.h"
+#import "SXPreloadPool.h"
+#import "SXViewPool.h"
+#import "SXView_private.h"
+#import "SXWebCacheProtocol.h"
+#import "SXPreloadPredictor.h"
+#import "SXNotificationPipeline.h"
+#import "SXWarmUp.h"
 //#import <NSJSONSerialization.h>
 
-static NSMutableArray *_notificationStack = nil;
-static NSMutableDictionary *_preloadedWebview = nil;
 static double _startPlayingTime;
 static CLLocationManager *LocationManager = nil;
 static BOOL _isReachable = NO;
 static NSString *_currentLanguageCode = nil;
+static SXScorePolicy _scorePolicy = SXScorePolicySubmit;
+static BOOL _predictivePreloadingEnabled = YES;
 
 @interface Scoreflex ()
 + (NSString *)scoreflexLanguageCodeForLocaleLanguageCode:(NSString *)localeLanguageCode;
 + (void) attachView:(UIView *)view gravity:(SXGravity)gravity;
++ (UIViewController *) presentFullScreenViewController:(SXViewController *)viewController;
++ (void) handleScoreflexNotifications:(NSArray *)scoreflexNotifications;
++ (void) showScoreflexNotification:(NSDictionary *)scoreflexNotification;
 @end
 
 @implementation Scoreflex
@@ -45,7 +58,12 @@ static NSString *_currentLanguageCode = nil;
     static dispatch_once_t onceToken;
     dispatch_once(&onceToken, ^{
         LocationManager = [[CLLocationManager alloc] init];
-        _preloadedWebview = [[NSMutableDictionary alloc] init];
+
+        // Deferred scores are sent when the game goes to the background
+        [[NSNotificationCenter defaultCenter] addObserverForName:UIApplicationDidEnterBackgroundNotification object:nil queue:nil usingBlock:^(NSNotification *note) {
+            if ([Scoreflex isInitialized])
+                [Scoreflex flushDeferredScores];
+        }];
     });
 }
 + (void) setClientId:(NSString *)clientId secret:(NSString *)secret sandboxMode:(BOOL)sandboxMode
@@ -55,6 +73,13 @@ static NSString *_currentLanguageCode = nil;
     configuration.clientSecret = secret;
     configuration.baseURL = [NSURL URLWithString:sandboxMode ? SANDBOX_API_URL : PRODUCTION_API_URL];
 
+    // Load the configuration, pre-connect, compute the device identifier and decode the saved requests concurrently.
+    // The token fetch waits for the device identifier and the request vault replays the decoded requests.
+    [[SXWarmUp sharedWarmUp] startWithBaseURL:configuration.baseURL];
+
+    // Serve web views from the local cache when possible
+    [NSURLProtocol registerClass:[SXWebCacheProtocol class]];
+
     // Fetch anonymous access token right away
     BOOL isFetching = [[SXClient sharedClient] fetchAnonymousAccessTokenIfNeededAndCall:^(AFHTTPRequestOperation *operation, id responseObject) {
         [[NSNotificationCenter defaultCenter] postNotificationName:SX_NOTIFICATION_INITIALIZED
@@ -65,7 +90,8 @@ static NSString *_currentLanguageCode = nil;
 
     }];
     if (NO == isFetching) {
-        [self get:@"/network/ping" params:nil handler:^(SXResponse *response, NSError *error) {
+        // Promise callbacks run on the main queue, whatever the callback queue of the handlers
+        [[self get:@"/network/ping" params:nil handler:nil] done:^(id response, NSError *error) {
             if (nil == error) {
                 [[NSNotificationCenter defaultCenter] postNotificationName:SX_NOTIFICATION_INITIALIZED
                                                                     object:self
@@ -78,23 +104,15 @@ static NSString *_currentLanguageCode = nil;
         }];
     }
 
-    // Handle the notification if some are here
-    NSMutableArray *stack = [Scoreflex getNotificationStack];
-    if ([stack count] > 0)
-    {
-        NSDictionary *notificationData = [stack lastObject];
-        [stack removeObject:notificationData];
-        [Scoreflex handleScoreflexNotification:notificationData];
-    }
-}
-
-+(NSMutableArray *) getNotificationStack
-{
-    if (_notificationStack == nil)
-    {
-        _notificationStack = [[NSMutableArray alloc] init];
-    }
-    return _notificationStack;
+    // Handle the notifications received before the initialization, and the next ones, in batches
+    SXNotificationPipeline *pipeline = [SXNotificationPipeline sharedPipeline];
+    pipeline.handler = ^(NSArray *notifications) {
+        [[[SXClient sharedClient] sessionReady] done:^(id value, NSError *error) {
+            if (nil == error)
+                [Scoreflex handleScoreflexNotifications:notifications];
+        }];
+    };
+    [pipeline flush];
 }
 
 + (BOOL) handleURL:(NSURL *)url sourceApplication:(NSString *)sourceApplication annotation:(id)annotation
@@ -147,21 +165,93 @@ static NSString *_currentLanguageCode = nil;
 
 +(void) submitScore:(NSString *) leaderboardId score:(long) score handler:(void(^)(SXResponse *response, NSError *error))handler {
     NSDictionary *params = @{@"score": [NSNumber numberWithLong:score]};
-    NSString *resource = [NSString stringWithFormat:@"/scores/%@", leaderboardId];
-    [self postEventually:resource params:params handler:handler];
+    [self submitScore:leaderboardId params:params handler:handler];
 }
 
 +(void) submitScore:(NSString *) leaderboardId params:(id) params handler:(void(^)(SXResponse *response, NSError *error))handler {
     NSString *resource = [NSString stringWithFormat:@"/scores/%@", leaderboardId];
-    [self postEventually:resource params:params handler:handler];
+    id score = [params valueForKey:@"score"];
+    NSString *playerId = [self getPlayerId];
+
+    // Without a score or a player, we can't tell if the score improves anything
+    if (!score || !playerId) {
+        [self postEventually:resource params:params handler:handler];
+        return;
+    }
+
+    // The score is only recorded once accepted, a failed submission must not hide the next ones
+    long long value = [score longLongValue];
+    void (^recordingHandler)(SXResponse *, NSError *) = ^(SXResponse *response, NSError *error) {
+        if (nil == error)
+            [[SXScoreIndex sharedIndex] recordScore:value player:playerId leaderboard:leaderboardId];
+        if (handler)
+            handler(response, error);
+    };
+
+    if (SXScorePolicySubmit == _scorePolicy || [[SXScoreIndex sharedIndex] isImprovingScore:value player:playerId leaderboard:leaderboardId]) {
+        [self postEventually:resource params:params handler:recordingHandler];
+        return;
+    }
+
+    SXLog(@"Score %@ does not improve the best score on %@", score, leaderboardId);
+
+    if (SXScorePolicyDefer == _scorePolicy) {
+        SXRequest *request = [[SXRequest alloc] init];
+        request.method = @"POST";
+        request.resource = resource;
+        request.params = params;
+        if ([[SXScoreIndex sharedIndex] deferRequest:request] >= SCORE_INDEX_FLUSH_COUNT)
+            [self flushDeferredScores];
+    }
+
+    if (handler)
+        handler(nil, nil);
+}
+
++ (void) setScoreOrder:(SXScoreOrder)order forLeaderboard:(NSString *)leaderboardId
+{
+    [[SXScoreIndex sharedIndex] setOrder:order forLeaderboard:leaderboardId];
+}
+
++ (void) setScorePolicy:(SXScorePolicy)policy
+{
+    _scorePolicy = policy;
+}
+
++ (void) setDefersRequestReplayOnCellular:(BOOL)defers
+{
+    [SXNetworkPolicy sharedPolicy].defersReplayOnCellular = defers;
+}
+
++ (NSNumber *) bestScoreForLeaderboard:(NSString *)leaderboardId
+{
+    return [[SXScoreIndex sharedIndex] bestScoreForPlayer:[self getPlayerId] leaderboard:leaderboardId];
+}
+
++ (void) flushDeferredScores
+{
+    SXClient *client = [SXClient sharedClient];
+    for (SXRequest *request in [[SXScoreIndex sharedIndex] drainDeferredRequests])
+        [client requestEventually:request];
 }
 
 + (UIView*) submitScoreAndShowRanksPanel:(NSString*) leaderboardId params:(id) params gravity:(SXGravity)gravity
 {
-    [self submitScore:leaderboardId params:params handler:^(SXResponse *response, NSError *error) {
+    SXPromise *submitted = [[SXPromise alloc] init];
+    [self submitScore:leaderboardId params:params handler:[submitted resolverWithHandler:nil]];
+
+    // The panel is created and attached while the score is posted, and loads the ranks once they include it
+    NSString *resource = [NSString stringWithFormat:@"/web/scores/%@/ranks", leaderboardId];
+    SXView *view = [[SXViewPool sharedPool] dequeueView];
+    NSUInteger generation = view.reuseGeneration;
+    [self attachView:view gravity:gravity];
 
+    [[submitted timeout:COMPOSITE_STEP_TIMEOUT] done:^(id value, NSError *error) {
+        // The panel may have been closed, and recycled, in the meantime
+        if (view.reuseGeneration == generation && view.superview)
+            [view openResource:resource params:params forceFullScreen:NO];
     }];
-    return [self showRanksPanel:leaderboardId params:params gravity:gravity];
+    return view;
 }
 
 + (void) submitTurn:(NSString *)challengeInstanceId params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler
@@ -179,15 +269,27 @@ static NSString *_currentLanguageCode = nil;
 
 +(void) submitTurnAndShowChallengeDetail:(NSString*) challengeInstanceId params:(id)params
 {
-    [self submitTurn:challengeInstanceId params:params handler:^(SXResponse *response, NSError *error) {
-       [self showFullScreenView:[NSString stringWithFormat:@"/web/challenges/instances/%@", challengeInstanceId] params:params];
+    SXPromise *submitted = [[SXPromise alloc] init];
+    [self submitTurn:challengeInstanceId params:params handler:[submitted resolverWithHandler:nil]];
+
+    // The controller and its web view are built while the turn is posted, the challenge is only loaded once the turn
+    // is done so that the page shows it
+    SXViewController *viewController = [[SXPreloadPool sharedPool] dequeueReusableController];
+    NSString *resource = [NSString stringWithFormat:@"web/challenges/instances/%@", challengeInstanceId];
+
+    [[submitted timeout:COMPOSITE_STEP_TIMEOUT] done:^(id value, NSError *error) {
+        [viewController.scoreflexView openResource:resource params:params forceFullScreen:YES];
+        [self presentFullScreenViewController:viewController];
     }];
 }
 
 + (UIViewController *) showFullScreenView:(NSString *) resource params:(id)params
 {
-    SXViewController *viewController = (SXViewController*)[Scoreflex getFullscreenView:resource params:params];
+    return [self presentFullScreenViewController:(SXViewController*)[Scoreflex getFullscreenView:resource params:params]];
+}
 
++ (UIViewController *) presentFullScreenViewController:(SXViewController *)viewController
+{
     // Present the controller modally
     UIViewController *rootViewController = [UIApplication sharedApplication].keyWindow.rootViewController;
     UIViewController *controller = [rootViewController modalViewController];
@@ -256,61 +358,87 @@ static NSString *_currentLanguageCode = nil;
 
 
 #pragma mark - REST API Access
-+ (void) post:(NSString *)resource params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler
+
++ (void) setCallbackQueue:(dispatch_queue_t)queue
+{
+    [SXClient sharedClient].callbackQueue = queue;
+}
+
++ (SXPromise *) post:(NSString *)resource params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler
 {
     SXClient *client = [SXClient sharedClient];
     SXRequest *request = [[SXRequest alloc] init];
     request.method = @"POST";
     request.resource = resource;
-    request.handler = handler;
     request.params = params;
+
+    SXPromise *promise = [[SXPromise alloc] init];
+    request.handler = [promise resolverWithHandler:handler];
+    promise.cancellationToken = request.cancellationToken;
     [client requestAuthenticated:request];
+    return promise;
 }
 
-+ (void) get:(NSString *)resource params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler
++ (SXPromise *) get:(NSString *)resource params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler
 {
     SXClient *client = [SXClient sharedClient];
     SXRequest *request = [[SXRequest alloc] init];
     request.method = @"GET";
     request.resource = resource;
-    request.handler = handler;
     request.params = params;
+
+    SXPromise *promise = [[SXPromise alloc] init];
+    request.handler = [promise resolverWithHandler:handler];
+    promise.cancellationToken = request.cancellationToken;
     [client requestAuthenticated:request];
+    return promise;
 }
 
-+ (void) delete:(NSString *)resource params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler
++ (SXPromise *) delete:(NSString *)resource params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler
 {
     SXClient *client = [SXClient sharedClient];
     SXRequest *request = [[SXRequest alloc] init];
     request.method = @"DELETE";
     request.resource = resource;
-    request.handler = handler;
     request.params = params;
+
+    SXPromise *promise = [[SXPromise alloc] init];
+    request.handler = [promise resolverWithHandler:handler];
+    promise.cancellationToken = request.cancellationToken;
     [client requestAuthenticated:request];
+    return promise;
 }
 
-+ (void) put:(NSString *)resource params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler
++ (SXPromise *) put:(NSString *)resource params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler
 {
     SXClient *client = [SXClient sharedClient];
     SXRequest *request = [[SXRequest alloc] init];
     request.method = @"PUT";
     request.resource = resource;
-    request.handler = handler;
     request.params = params;
+
+    SXPromise *promise = [[SXPromise alloc] init];
+    request.handler = [promise resolverWithHandler:handler];
+    promise.cancellationToken = request.cancellationToken;
     [client requestAuthenticated:request];
+    return promise;
 }
 
 
 
-+ (void) postEventually:(NSString *)resource params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler
++ (SXPromise *) postEventually:(NSString *)resource params:(id)params handler:(void(^)(SXResponse *response, NSError *error))handler
 {
     SXClient *client = [SXClient sharedClient];
     SXRequest *request = [[SXRequest alloc] init];
     request.method = @"POST";
     request.resource = resource;
-    request.handler = handler;
     request.params = params;
+
+    SXPromise *promise = [[SXPromise alloc] init];
+    request.handler = [promise resolverWithHandler:handler];
+    promise.cancellationToken = request.cancellationToken;
     [client requestEventually:request];
+    return promise;
 }
 
 #pragma mark - Language
@@ -406,7 +534,24 @@ static NSString *_currentLanguageCode = nil;
     } ];
 }
 
-+ (void) handleScoreflexNotification:(NSDictionary*) scoreflexNotification
++ (void) handleScoreflexNotifications:(NSArray *)scoreflexNotifications
+{
+    if (scoreflexNotifications.count == 0 || [self getPlayerId] == nil) {
+        return;
+    }
+
+    // Track every handled notification, duplicates of a code and target having been merged by the pipeline
+    for (NSDictionary *scoreflexNotification in scoreflexNotifications) {
+        NSNumber *code = [scoreflexNotification objectForKey:@"code"];
+        if (code)
+            [Scoreflex postEventually:@"/notifications/track" params:@{@"code":code} handler:nil];
+    }
+
+    // Only the highest priority notification opens a view
+    [Scoreflex showScoreflexNotification:[scoreflexNotifications objectAtIndex:0]];
+}
+
++ (void) showScoreflexNotification:(NSDictionary*) scoreflexNotification
 {
     NSNumber *code = [scoreflexNotification objectForKey:@"code"];
     NSDictionary *data = [scoreflexNotification objectForKey:@"data"];
@@ -416,13 +561,7 @@ static NSString *_currentLanguageCode = nil;
     if (localPlayerId == nil) {
         return;
     }
-    
-    NSDictionary *trackParameters = @{@"code":code};
-    
-    [Scoreflex postEventually:@"/notifications/track" params:trackParameters handler:^(SXResponse *response, NSError *error) {
 
-    }];
-    
     if (codeInt == SX_PUSH_NOTIFICATION_TYPE_CHALLENGE_INVITATION || codeInt == SX_PUSH_NOTIFICATION_TYPE_CHALLENGE_ENDED ||
         codeInt == SX_PUSH_NOTIFICATION_TYPE_YOUR_TURN_IN_CHALLENGE)
     {
@@ -501,14 +640,8 @@ static NSString *_currentLanguageCode = nil;
     NSNumber *code = [scoreflexData objectForKey:@"code"];
     if ([code intValue] >= SX_PUSH_NOTIFICATION_TYPE_CHALLENGE_INVITATION)
     {
-        if ([Scoreflex isInitialized])
-        {
-            [Scoreflex handleScoreflexNotification:scoreflexData];
-        }
-        else
-        {
-            [[Scoreflex getNotificationStack] addObject:scoreflexData];
-        }
+        // Drained once the SDK is initialized
+        [[SXNotificationPipeline sharedPipeline] enqueueNotification:scoreflexData];
         return YES;
     }
     
@@ -549,7 +682,8 @@ static NSString *_currentLanguageCode = nil;
     if (resource && [resource rangeOfString:@"/"].location == 0)
         resource = resource.length > 1 ? [resource substringFromIndex:1] : @"";
 
-    if ([_preloadedWebview valueForKey:resource] != nil) {
+    SXPreloadPool *pool = [SXPreloadPool sharedPool];
+    if ([pool controllerForResource:resource] != nil) {
         return;
     }
 
@@ -557,10 +691,10 @@ static NSString *_currentLanguageCode = nil;
     request.resource = resource;
     request.method = @"GET";
     request.params = nil;
-    SXViewController *viewController = [[SXViewController alloc] initWithNibName:@"SXViewController" bundle:[Scoreflex bundle]];
+    SXViewController *viewController = [pool dequeueReusableController];
     viewController.request = request;
     [viewController preload];
-    [_preloadedWebview setValue:viewController forKey:resource];
+    [pool setController:viewController forResource:resource];
 
 }
 
@@ -569,25 +703,66 @@ static NSString *_currentLanguageCode = nil;
         resource = resource.length > 1 ? [resource substringFromIndex:1] : @"";
 
     if (resource == nil) {
-        for (NSString *key in _preloadedWebview) {
-            SXViewController *view = [_preloadedWebview valueForKey:key];
-            [view.scoreflexView close];
-        }
-        [_preloadedWebview removeAllObjects];
+        [[SXPreloadPool sharedPool] removeAllControllers];
         return;
     }
-    SXViewController *view = [_preloadedWebview valueForKey:resource];
-    if (nil != view) {
-        [view.scoreflexView close];
-    }
-    [_preloadedWebview removeObjectForKey:resource];
+    [[SXPreloadPool sharedPool] removeControllerForResource:resource];
+}
+
++ (void) setPreloadBudget:(NSUInteger)maxCount memory:(NSUInteger)maxBytes
+{
+    SXPreloadPool *pool = [SXPreloadPool sharedPool];
+    pool.maxCount = maxCount;
+    pool.maxCost = maxBytes;
+}
+
++ (void) warmUpPanelViews:(NSUInteger)count
+{
+    [[SXViewPool sharedPool] warmUp:count];
+}
+
++ (void) setPredictivePreloadingEnabled:(BOOL)enabled
+{
+    _predictivePreloadingEnabled = enabled;
+}
+
++ (NSDictionary *) preloadPredictionStatistics
+{
+    return [[SXPreloadPredictor sharedPredictor] statistics];
+}
+
++ (void) didOpenResource:(NSString *)resource
+{
+    if (resource && [resource rangeOfString:@"/"].location == 0)
+        resource = resource.length > 1 ? [resource substringFromIndex:1] : @"";
+
+    SXPreloadPredictor *predictor = [SXPreloadPredictor sharedPredictor];
+    [predictor recordVisit:resource];
+    if (!_predictivePreloadingEnabled)
+        return;
+
+    NSString *next = [predictor predictedResourceAfter:resource];
+    if (!next)
+        return;
+    [predictor recordPrediction:next];
+
+    // Speculative preloads never evict the resources preloaded by the game, nor use a poor network
+    SXPreloadPool *pool = [SXPreloadPool sharedPool];
+    SXNetworkPolicy *policy = [SXNetworkPolicy sharedPolicy];
+    if ([pool controllerForResource:next] || pool.count >= pool.maxCount)
+        return;
+    if (SXNetworkClassOffline == policy.networkClass || policy.isSlow)
+        return;
+
+    SXLog(@"Preloading %@, likely opened after %@", next, resource);
+    [self preloadResource:next];
 }
 
 #pragma mark - Views
 
 + (SXView *) getPanelView:(NSString *)resource
 {
-    SXView *result = [[SXView alloc] initWithFrame:CGRectZero];
+    SXView *result = [[SXViewPool sharedPool] dequeueView];
     [result openResource:resource];
     return result;
 }
@@ -597,19 +772,18 @@ static NSString *_currentLanguageCode = nil;
 
     if (resource && [resource rangeOfString:@"/"].location == 0)
         resource = resource.length > 1 ? [resource substringFromIndex:1] : @"";
-    SXViewController *controller = [_preloadedWebview valueForKey:resource];
+    SXViewController *controller = [[SXPreloadPool sharedPool] takeControllerForResource:resource];
     if (controller != nil) {
-        [_preloadedWebview removeObjectForKey:resource];
         return controller;
     }
-    SXViewController *viewController = [[SXViewController alloc] initWithNibName:@"SXViewController" bundle:[Scoreflex bundle]];
+    SXViewController *viewController = [[SXPreloadPool sharedPool] dequeueReusableController];
     [viewController.scoreflexView openResource:resource params:params forceFullScreen:YES];
     return viewController;
 }
 
 + (SXView*) getPanelView:(NSString *) resource params:(NSDictionary *) params
 {
-    SXView *panelView = [[SXView alloc] initWithFrame:CGRectZero];
+    SXView *panelView = [[SXViewPool sharedPool] dequeueView];
     [panelView openResource:resource params:params forceFullScreen:NO];
     return panelView;
 }
@@ -619,14 +793,13 @@ static NSString *_currentLanguageCode = nil;
     if (resource && [resource rangeOfString:@"/"].location == 0)
         resource = resource.length > 1 ? [resource substringFromIndex:1] : @"";
 
-    SXViewController *controller = [_preloadedWebview valueForKey:resource];
+    SXViewController *controller = [[SXPreloadPool sharedPool] takeControllerForResource:resource];
     if (controller != nil) {
         [self showViewController:controller];
-        [_preloadedWebview removeObjectForKey:resource];
         return controller.scoreflexView;
     }
 
-    SXView *result = [[SXView alloc] initWithFrame:CGRectZero];
+    SXView *result = [[SXViewPool sharedPool] dequeueView];
     [result openResource:resource];
     return result;
 }
@@ -714,14 +887,13 @@ static NSString *_currentLanguageCode = nil;
     if (resource && [resource rangeOfString:@"/"].location == 0)
         resource = resource.length > 1 ? [resource substringFromIndex:1] : @"";
 
-    SXViewController *controller = [_preloadedWebview valueForKey:resource];
+    SXViewController *controller = [[SXPreloadPool sharedPool] takeControllerForResource:resource];
     if (controller != nil) {
 
         [self showViewController:controller];
-        [_preloadedWebview removeObjectForKey:resource];
         return controller.scoreflexView;
     }
-    SXView *result = [[SXView alloc] initWithFrame:CGRectZero];
+    SXView *result = [[SXViewPool sharedPool] dequeueView];
     [result openResource:resource params:params forceFullScreen:forceFullScreen];
     return result;
 }
@@ -22,4 +22,9 @@
 @interface Scoreflex (Private)
 
 + (void) setIsReachable:(BOOL)isReachable;
+
+/**
+ Called when a resource is shown to the player, to learn the navigation habits and preload the next resource.
+ */
++ (void) didOpenResource:(NSString *)resource;
 @end
@@ -0,0 +1,114 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "AFHTTPClientTest.h"
+#import "AFHTTPClient.h"
+#import "AFHTTPRequestOperation.h"
+#import "SXStandInServer.h"
+#import <libkern/OSAtomic.h>
+
+@interface AFHTTPClientTest ()
+
+- (void) enqueuePingsWithClient:(AFHTTPClient *)httpClient count:(int)count finished:(int *)finished;
+
+- (NSUInteger) runningOperationCountWithClient:(AFHTTPClient *)httpClient;
+
+- (BOOL) waitForFinished:(volatile int *)finished count:(int)count maxRunning:(NSUInteger)maxRunning client:(AFHTTPClient *)httpClient;
+
+@end
+
+@implementation AFHTTPClientTest
+
+- (void)setUp
+{
+    [super setUp];
+    [SXStandInServer start];
+    [SXStandInServer reset];
+    [SXStandInServer setLatency:0.1 jitter:0];
+}
+
+- (void)tearDown
+{
+    [SXStandInServer reset];
+    [SXStandInServer stop];
+    [super tearDown];
+}
+
+- (void) enqueuePingsWithClient:(AFHTTPClient *)httpClient count:(int)count finished:(int *)finished
+{
+    for (int i = 0; i < count; i++) {
+        NSURLRequest *request = [httpClient requestWithMethod:@"GET" path:@"network/ping" parameters:nil];
+        AFHTTPRequestOperation *operation = [httpClient HTTPRequestOperationWithRequest:request success:nil failure:nil];
+        operation.completionBlock = ^{
+            OSAtomicIncrement32((volatile int32_t *)finished);
+        };
+        [httpClient enqueueHTTPRequestOperation:operation];
+    }
+}
+
+- (NSUInteger) runningOperationCountWithClient:(AFHTTPClient *)httpClient
+{
+    // Operations being removed from the queue are finished rather than executing
+    return [[httpClient.operationQueue.operations filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"isFinished == NO"]] count];
+}
+
+- (BOOL) waitForFinished:(volatile int *)finished count:(int)count maxRunning:(NSUInteger)maxRunning client:(AFHTTPClient *)httpClient
+{
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:10];
+    while (*finished < count && [timeout timeIntervalSinceNow] > 0) {
+        if ([self runningOperationCountWithClient:httpClient] > maxRunning)
+            return NO;
+        [NSThread sleepForTimeInterval:0.01];
+    }
+    return *finished == count;
+}
+
+- (void)testRaisingTheLimitStartsWaitingOperations
+{
+    AFHTTPClient *httpClient = [[AFHTTPClient alloc] initWithBaseURL:[NSURL URLWithString:SANDBOX_API_URL]];
+    httpClient.maxConcurrentOperationCountPerHost = 1;
+
+    int finished = 0;
+    [self enqueuePingsWithClient:httpClient count:6 finished:&finished];
+    STAssertEquals(1, (int)[self runningOperationCountWithClient:httpClient], @"Operations over the limit wait");
+
+    httpClient.maxConcurrentOperationCountPerHost = 3;
+    STAssertEquals(3, (int)[self runningOperationCountWithClient:httpClient], @"Waiting operations start when the limit is raised");
+
+    STAssertTrue([self waitForFinished:&finished count:6 maxRunning:3 client:httpClient], @"Every operation runs within the new limit");
+}
+
+- (void)testLoweringTheLimitHoldsWaitingOperations
+{
+    AFHTTPClient *httpClient = [[AFHTTPClient alloc] initWithBaseURL:[NSURL URLWithString:SANDBOX_API_URL]];
+    httpClient.maxConcurrentOperationCountPerHost = 3;
+
+    int finished = 0;
+    [self enqueuePingsWithClient:httpClient count:8 finished:&finished];
+    STAssertEquals(3, (int)[self runningOperationCountWithClient:httpClient], @"Operations over the limit wait");
+
+    httpClient.maxConcurrentOperationCountPerHost = 1;
+    STAssertEquals(3, (int)[self runningOperationCountWithClient:httpClient], @"Running operations are not interrupted");
+
+    // Once the operations started under the old limit are done, one operation runs at a time
+    STAssertTrue([self waitForFinished:&finished count:3 maxRunning:3 client:httpClient], @"Running operations finish");
+    STAssertTrue([self waitForFinished:&finished count:8 maxRunning:1 client:httpClient], @"Waiting operations run within the new limit");
+}
+
+@end
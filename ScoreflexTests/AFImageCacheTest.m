@@ -0,0 +1,210 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "AFImageCacheTest.h"
+#import "UIImageView+AFNetworking.h"
+#import "AFImageRequestOperation.h"
+
+@interface AFImageCacheTest ()
+
+- (NSString *) diskPath;
+
+- (AFImageCache *) cacheWithDiskCapacity:(NSUInteger)diskCapacity;
+
+/**
+ Moves the modification date of every cached file back, as if the files had been used that long ago.
+ */
+- (void) ageCachedFilesBy:(NSTimeInterval)interval;
+
+- (NSData *) imageDataWithSize:(CGSize)size;
+
+- (UIImage *) waitForImageForRequest:(NSURLRequest *)request cache:(AFImageCache *)cache;
+
+@end
+
+@implementation AFImageCacheTest
+
+- (NSString *) diskPath
+{
+    return [NSTemporaryDirectory() stringByAppendingPathComponent:@"AFImageCacheTest"];
+}
+
+- (AFImageCache *) cacheWithDiskCapacity:(NSUInteger)diskCapacity
+{
+    [[NSFileManager defaultManager] removeItemAtPath:[self diskPath] error:nil];
+    return [[AFImageCache alloc] initWithMemoryCapacity:4 * 1024 * 1024 diskCapacity:diskCapacity diskPath:[self diskPath]];
+}
+
+- (void) ageCachedFilesBy:(NSTimeInterval)interval
+{
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    for (NSString *fileName in [fileManager contentsOfDirectoryAtPath:[self diskPath] error:nil]) {
+        NSString *path = [[self diskPath] stringByAppendingPathComponent:fileName];
+        NSDate *date = [[fileManager attributesOfItemAtPath:path error:nil] fileModificationDate];
+        [fileManager setAttributes:@{NSFileModificationDate: [date dateByAddingTimeInterval:-interval]} ofItemAtPath:path error:nil];
+    }
+}
+
+- (NSData *) imageDataWithSize:(CGSize)size
+{
+    UIGraphicsBeginImageContextWithOptions(size, YES, 1.0f);
+    [[UIColor redColor] setFill];
+    UIRectFill(CGRectMake(0, 0, size.width, size.height));
+    UIImage *image = UIGraphicsGetImageFromCurrentImageContext();
+    UIGraphicsEndImageContext();
+    return UIImagePNGRepresentation(image);
+}
+
+- (UIImage *) waitForImageForRequest:(NSURLRequest *)request cache:(AFImageCache *)cache
+{
+    __block BOOL done = NO;
+    __block UIImage *result = nil;
+    [cache loadImageForRequest:request completion:^(UIImage *image) {
+        result = image;
+        done = YES;
+    }];
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:5];
+    while (!done && [timeout timeIntervalSinceNow] > 0)
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    STAssertTrue(done, @"The lookup completes");
+    return result;
+}
+
+- (void)testMemoryAndDiskTiers
+{
+    AFImageCache *cache = [self cacheWithDiskCapacity:1024 * 1024];
+    NSURLRequest *request = [NSURLRequest requestWithURL:[NSURL URLWithString:@"https://www.scoreflex.com/avatar.png"]];
+    NSData *data = [self imageDataWithSize:CGSizeMake(32, 32)];
+
+    STAssertNil([self waitForImageForRequest:request cache:cache], @"Nothing cached yet");
+    STAssertEquals((NSUInteger)1, cache.missCount, @"The lookup is a miss");
+
+    UIImage *decoded = [cache cacheImage:[UIImage imageWithData:data] data:data forRequest:request];
+    STAssertEquals((size_t)32, CGImageGetWidth(decoded.CGImage), @"The decoded bitmap keeps its size");
+    STAssertEqualObjects(decoded, [cache cachedImageForRequest:request], @"The decoded image is kept in memory");
+    STAssertEquals((NSUInteger)1, cache.memoryHitCount, @"The lookup is a memory hit");
+
+    // Reading back from disk once the memory tier is emptied
+    [cache removeAllMemoryCachedImages];
+    STAssertNil([cache cachedImageForRequest:request], @"The memory tier is empty");
+    STAssertNotNil([self waitForImageForRequest:request cache:cache], @"The image is read from disk");
+    STAssertEquals((NSUInteger)1, cache.diskHitCount, @"The lookup is a disk hit");
+    STAssertNotNil([cache cachedImageForRequest:request], @"Disk hits move back to memory");
+
+    STAssertEqualsWithAccuracy(0.75, [cache hitRatio], 0.001, @"Three hits out of four lookups");
+
+    NSMutableURLRequest *reload = [request mutableCopy];
+    reload.cachePolicy = NSURLRequestReloadIgnoringCacheData;
+    STAssertNil([cache cachedImageForRequest:reload], @"Reloading requests skip the cache");
+
+    [cache removeAllCachedImages];
+    STAssertEquals((NSUInteger)0, cache.currentDiskUsage, @"The disk tier is empty");
+}
+
+- (void)testDiskTierEvictsLeastRecentlyUsed
+{
+    NSData *data = [self imageDataWithSize:CGSizeMake(64, 64)];
+    AFImageCache *cache = [self cacheWithDiskCapacity:[data length] * 2];
+    UIImage *image = [UIImage imageWithData:data];
+
+    NSURLRequest *first = [NSURLRequest requestWithURL:[NSURL URLWithString:@"https://www.scoreflex.com/1.png"]];
+    NSURLRequest *second = [NSURLRequest requestWithURL:[NSURL URLWithString:@"https://www.scoreflex.com/2.png"]];
+    NSURLRequest *third = [NSURLRequest requestWithURL:[NSURL URLWithString:@"https://www.scoreflex.com/3.png"]];
+
+    // Disk reads are queued behind the writes, so each file exists once it has been read back
+    [cache cacheImage:image data:data forRequest:first];
+    [cache removeAllMemoryCachedImages];
+    STAssertNotNil([self waitForImageForRequest:first cache:cache], @"The first image is on disk");
+    [self ageCachedFilesBy:60];
+    [cache cacheImage:image data:data forRequest:second];
+    [cache removeAllMemoryCachedImages];
+    STAssertNotNil([self waitForImageForRequest:second cache:cache], @"The second image is on disk");
+    [self ageCachedFilesBy:60];
+
+    // Reading the first image makes the second one the least recently used
+    [cache removeAllMemoryCachedImages];
+    STAssertNotNil([self waitForImageForRequest:first cache:cache], @"The first image is still on disk");
+
+    [cache cacheImage:image data:data forRequest:third];
+    [cache removeAllMemoryCachedImages];
+
+    STAssertNotNil([self waitForImageForRequest:first cache:cache], @"Recently read images are kept");
+    STAssertNil([self waitForImageForRequest:second cache:cache], @"The least recently used image is evicted");
+    STAssertNotNil([self waitForImageForRequest:third cache:cache], @"The new image is kept");
+    STAssertTrue(cache.currentDiskUsage <= cache.diskCapacity, @"The disk tier stays within its capacity");
+}
+
+- (void)testDownsampling
+{
+    NSData *square = [self imageDataWithSize:CGSizeMake(256, 256)];
+    UIImage *avatar = AFDecodedImageWithData(square, 2.0f, CGSizeMake(80, 80));
+    STAssertEquals((size_t)80, CGImageGetWidth(avatar.CGImage), @"The image is downsampled to the target size");
+    STAssertEqualsWithAccuracy(40.0, (double)avatar.size.width, 0.001, @"The image keeps the requested scale");
+
+    NSData *wide = [self imageDataWithSize:CGSizeMake(256, 128)];
+    UIImage *banner = AFDecodedImageWithData(wide, 1.0f, CGSizeMake(40, 40));
+    STAssertEquals((size_t)80, CGImageGetWidth(banner.CGImage), @"The aspect ratio is kept");
+    STAssertEquals((size_t)40, CGImageGetHeight(banner.CGImage), @"Both sides fill the target size");
+
+    UIImage *large = AFDecodedImageWithData(square, 1.0f, CGSizeMake(512, 512));
+    STAssertEquals((size_t)256, CGImageGetWidth(large.CGImage), @"Images are never upsampled");
+
+    STAssertNil(AFDecodedImageWithData([@"not an image" dataUsingEncoding:NSUTF8StringEncoding], 1.0f, CGSizeZero), @"Invalid data is not decoded");
+}
+
+- (void)testCachePerPixelSize
+{
+    AFImageCache *cache = [self cacheWithDiskCapacity:1024 * 1024];
+    NSURLRequest *request = [NSURLRequest requestWithURL:[NSURL URLWithString:@"https://www.scoreflex.com/player.png"]];
+    NSData *data = [self imageDataWithSize:CGSizeMake(256, 256)];
+
+    UIImage *small = AFDecodedImageWithData(data, 1.0f, CGSizeMake(40, 40));
+    [cache cacheImage:small data:data forRequest:request pixelSize:CGSizeMake(40, 40)];
+    STAssertEqualObjects(small, [cache cachedImageForRequest:request pixelSize:CGSizeMake(40, 40)], @"Sized images are cached per size");
+    STAssertNil([cache cachedImageForRequest:request], @"The full resolution image is a separate entry");
+
+    // Other sizes are downsampled from the file written for the first one
+    __block UIImage *medium = nil;
+    __block BOOL done = NO;
+    [cache loadImageForRequest:request pixelSize:CGSizeMake(100, 100) completion:^(UIImage *image) {
+        medium = image;
+        done = YES;
+    }];
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:5];
+    while (!done && [timeout timeIntervalSinceNow] > 0)
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    STAssertEquals((size_t)100, CGImageGetWidth(medium.CGImage), @"The disk copy is downsampled to the requested size");
+    STAssertNotNil([cache cachedImageForRequest:request pixelSize:CGSizeMake(100, 100)], @"The new size is kept in memory");
+
+    [cache removeAllCachedImages];
+}
+
+- (void)testMemoryWarningEmptiesMemoryTier
+{
+    AFImageCache *cache = [self cacheWithDiskCapacity:1024 * 1024];
+    NSURLRequest *request = [NSURLRequest requestWithURL:[NSURL URLWithString:@"https://www.scoreflex.com/badge.png"]];
+    NSData *data = [self imageDataWithSize:CGSizeMake(16, 16)];
+    [cache cacheImage:[UIImage imageWithData:data] data:data forRequest:request];
+
+    [[NSNotificationCenter defaultCenter] postNotificationName:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+    STAssertNil([cache cachedImageForRequest:request], @"Decoded bitmaps are released");
+    STAssertNotNil([self waitForImageForRequest:request cache:cache], @"The image is still on disk");
+}
+
+@end
@@ -0,0 +1,32 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import <SenTestingKit/SenTestingKit.h>
+
+/**
+ Microbenchmarks of the SDK hot paths.
+
+ Each benchmark reports the time and the number of heap allocations per operation, or the peak memory
+ footprint of a 50 MB multipart upload. Results go to the test log and, as JSON, to the file named by the
+ `SX_BENCHMARK_OUTPUT` environment variable (by default `ScoreflexBenchmarks.json` in the temporary
+ directory), so that they can be compared between runs.
+ */
+@interface SXBenchmarkTest : SenTestCase
+
+@end
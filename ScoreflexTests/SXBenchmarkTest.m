@@ -0,0 +1,399 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXBenchmarkTest.h"
+#import "SXUtil.h"
+#import "SXRequest.h"
+#import "SXRequestVault.h"
+#import "SXRequestCodec.h"
+#import "SXMetrics.h"
+#import "Scoreflex.h"
+#import "AFHTTPClient.h"
+#import "AFHTTPRequestOperation.h"
+#import "AFJSONRequestOperation.h"
+#import "SXStandInServer.h"
+#import <objc/message.h>
+#import <mach/mach.h>
+#import <libkern/OSAtomic.h>
+
+#define SX_BENCHMARK_LOG_TYPE_ALLOCATE 2
+
+// The hook used by malloc stack logging, called for every allocation and free of the default zones
+typedef void (sx_malloc_logger_t)(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t num_hot_frames_to_skip);
+extern sx_malloc_logger_t *malloc_logger;
+
+static volatile int64_t SXBenchmarkAllocationCount = 0;
+
+static void SXBenchmarkMallocLogger(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t num_hot_frames_to_skip)
+{
+    if (type & SX_BENCHMARK_LOG_TYPE_ALLOCATE)
+        OSAtomicIncrement64(&SXBenchmarkAllocationCount);
+}
+
+static NSMutableDictionary *SXBenchmarkResults = nil;
+
+@interface SXBenchmarkTest ()
+
+- (void) measure:(NSString *)name iterations:(NSUInteger)iterations block:(void(^)(void))block;
+
+- (void) measure:(NSString *)name threads:(NSUInteger)threads iterations:(NSUInteger)iterations block:(void(^)(NSUInteger index))block;
+
+- (void) recordResult:(NSDictionary *)result name:(NSString *)name;
+
+- (void) writeResults;
+
+- (NSUInteger) memoryFootprint;
+
+- (double) peakFootprintReadingStream:(NSInputStream *)stream since:(NSUInteger)base;
+
+- (void) fillVault:(SXRequestVault *)vault count:(NSUInteger)count;
+
+@end
+
+@implementation SXBenchmarkTest
+
+#pragma mark - Harness
+
+- (void) measure:(NSString *)name iterations:(NSUInteger)iterations block:(void(^)(void))block
+{
+    // Warm up caches and lazily initialized state
+    @autoreleasepool {
+        block();
+    }
+
+    int64_t allocations = 0;
+    NSTimeInterval duration = 0;
+    @autoreleasepool {
+        sx_malloc_logger_t *previousLogger = malloc_logger;
+        SXBenchmarkAllocationCount = 0;
+        malloc_logger = SXBenchmarkMallocLogger;
+
+        NSTimeInterval start = SXMetricsTimestamp();
+        for (NSUInteger i = 0; i < iterations; i++)
+            block();
+        duration = SXMetricsTimestamp() - start;
+
+        malloc_logger = previousLogger;
+        allocations = SXBenchmarkAllocationCount;
+    }
+
+    double nsPerOp = duration * 1e9 / iterations;
+    double allocsPerOp = (double)allocations / iterations;
+    NSLog(@"BENCHMARK %-40@ %12.0f ns/op %10.1f allocs/op", name, nsPerOp, allocsPerOp);
+
+    [self recordResult:@{@"iterations": [NSNumber numberWithUnsignedInteger:iterations],
+                         @"nsPerOp": [NSNumber numberWithDouble:nsPerOp],
+                         @"allocsPerOp": [NSNumber numberWithDouble:allocsPerOp]}
+                  name:name];
+}
+
+- (void) measure:(NSString *)name threads:(NSUInteger)threads iterations:(NSUInteger)iterations block:(void(^)(NSUInteger index))block
+{
+    // Every thread runs the given number of iterations, all of them at the same time
+    NSTimeInterval start = SXMetricsTimestamp();
+    dispatch_apply(threads, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t thread) {
+        for (NSUInteger i = 0; i < iterations; i++)
+            block(thread * iterations + i);
+    });
+    NSTimeInterval duration = SXMetricsTimestamp() - start;
+
+    double nsPerOp = duration * 1e9 / (threads * iterations);
+    NSLog(@"BENCHMARK %-40@ %12.0f ns/op on %lu threads", name, nsPerOp, (unsigned long)threads);
+
+    [self recordResult:@{@"threads": [NSNumber numberWithUnsignedInteger:threads],
+                         @"iterations": [NSNumber numberWithUnsignedInteger:iterations],
+                         @"nsPerOp": [NSNumber numberWithDouble:nsPerOp]}
+                  name:name];
+}
+
+- (void) recordResult:(NSDictionary *)result name:(NSString *)name
+{
+    @synchronized([self class]) {
+        if (!SXBenchmarkResults)
+            SXBenchmarkResults = [[NSMutableDictionary alloc] init];
+        [SXBenchmarkResults setObject:result forKey:name];
+        [self writeResults];
+    }
+}
+
+- (void) writeResults
+{
+    NSString *path = [[[NSProcessInfo processInfo] environment] objectForKey:@"SX_BENCHMARK_OUTPUT"];
+    if (!path)
+        path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"ScoreflexBenchmarks.json"];
+
+    NSDictionary *output = @{@"sdkVersion": SDX_VERSION,
+                             @"date": [NSNumber numberWithDouble:[[NSDate date] timeIntervalSince1970]],
+                             @"results": SXBenchmarkResults};
+    NSData *json = [NSJSONSerialization dataWithJSONObject:output options:NSJSONWritingPrettyPrinted error:nil];
+    [json writeToFile:path atomically:YES];
+}
+
+- (NSUInteger) memoryFootprint
+{
+    // Unlike the resident size, the footprint leaves out clean pages of mapped files
+    task_vm_info_data_t info;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    if (task_info(mach_task_self(), TASK_VM_INFO, (task_info_t)&info, &count) != KERN_SUCCESS)
+        return 0;
+    return (NSUInteger)info.phys_footprint;
+}
+
+- (double) peakFootprintReadingStream:(NSInputStream *)stream since:(NSUInteger)base
+{
+    NSUInteger peak = [self memoryFootprint];
+    uint8_t buffer[64 * 1024];
+
+    [stream open];
+    while ([stream hasBytesAvailable]) {
+        if ([stream read:buffer maxLength:sizeof(buffer)] <= 0)
+            break;
+        peak = MAX(peak, [self memoryFootprint]);
+    }
+    [stream close];
+
+    return ((double)peak - base) / (1024 * 1024);
+}
+
+- (void) fillVault:(SXRequestVault *)vault count:(NSUInteger)count
+{
+    [vault reset];
+
+    // Write the encoded queue at once rather than calling save: count times
+    NSMutableArray *queue = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        SXRequest *request = [[SXRequest alloc] init];
+        request.method = @"POST";
+        request.resource = @"scores/level1";
+        request.params = @{@"score": [NSString stringWithFormat:@"%lu", (unsigned long)i]};
+        [queue addObject:[SXRequestCodec dataWithRequest:request]];
+    }
+    [[NSUserDefaults standardUserDefaults] setObject:queue forKey:USER_DEFAULTS_REQUEST_VAULT_QUEUE];
+    [[NSUserDefaults standardUserDefaults] synchronize];
+}
+
+#pragma mark - SXUtil
+
+- (void)testUtilBenchmarks
+{
+    NSString *string = @"scores/level 1?playingTime=65000&meta=café & crème";
+    [self measure:@"SXUtil.percentEncodedString" iterations:10000 block:^{
+        [SXUtil percentEncodedString:string];
+    }];
+
+    NSData *data = [@"0123456789abcdef0123" dataUsingEncoding:NSUTF8StringEncoding];
+    [self measure:@"SXUtil.base64forData" iterations:10000 block:^{
+        [SXUtil base64forData:data];
+    }];
+
+    NSString *formEncoded = @"accessToken=0123456789abcdef&lang=en&sdkVersion=1.0&score=123456&playingTime=65000&meta=caf%C3%A9";
+    [self measure:@"SXUtil.dictionaryWithFormEncodedString" iterations:10000 block:^{
+        [SXUtil dictionaryWithFormEncodedString:formEncoded];
+    }];
+}
+
+#pragma mark - Requests
+
+- (void)testRequestBenchmarks
+{
+    [Scoreflex setClientId:@"benchmark" secret:@"benchmark" sandboxMode:YES];
+
+    SXRequest *request = [[SXRequest alloc] init];
+    request.method = @"POST";
+    request.resource = @"scores/level1";
+    request.params = @{@"score": @"123456", @"playingTime": @"65000"};
+    [self measure:@"SXRequest.decoratedParams" iterations:10000 block:^{
+        [request params];
+    }];
+
+    NSMutableURLRequest *urlRequest = [NSMutableURLRequest requestWithURL:[NSURL URLWithString:@"https://sandbox.api.scoreflex.com/v1/scores/level1?lang=en"]];
+    urlRequest.HTTPMethod = @"POST";
+    urlRequest.HTTPBody = [@"accessToken=0123456789abcdef&score=123456&playingTime=65000&sdkVersion=1.0" dataUsingEncoding:NSUTF8StringEncoding];
+    Class operationClass = NSClassFromString(@"SXJSONRequestOperation");
+    [self measure:@"SXJSONRequestOperation.authorizationHeader" iterations:10000 block:^{
+        objc_msgSend(operationClass, @selector(scoreflexAuthorizationHeaderValueForRequest:), urlRequest);
+    }];
+}
+
+#pragma mark - Multipart uploads
+
+- (void)testMultipartUploadMemory
+{
+    // A 50 MB file, written in chunks
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"ScoreflexBenchmarkUpload.bin"];
+    [[NSFileManager defaultManager] createFileAtPath:path contents:nil attributes:nil];
+    NSFileHandle *file = [NSFileHandle fileHandleForWritingAtPath:path];
+    NSMutableData *chunk = [NSMutableData dataWithLength:1024 * 1024];
+    for (int i = 0; i < 50; i++)
+        [file writeData:chunk];
+    [file closeFile];
+    NSURL *fileURL = [NSURL fileURLWithPath:path];
+
+    AFHTTPClient *httpClient = [[AFHTTPClient alloc] initWithBaseURL:[NSURL URLWithString:SANDBOX_API_URL]];
+    double peaks[2];
+    for (int mapped = 0; mapped < 2; mapped++) {
+        @autoreleasepool {
+            NSUInteger base = [self memoryFootprint];
+            NSMutableURLRequest *request = [httpClient multipartFormRequestWithMethod:@"POST" path:@"upload" parameters:@{@"kind": @"replay"} constructingBodyWithBlock:^(id<AFMultipartFormData> formData) {
+                if (mapped)
+                    [formData appendPartWithFileURL:fileURL name:@"file" error:nil];
+                else
+                    [formData appendPartWithFileData:[NSData dataWithContentsOfURL:fileURL] name:@"file" fileName:@"replay.bin" mimeType:@"application/octet-stream"];
+            }];
+            peaks[mapped] = [self peakFootprintReadingStream:request.HTTPBodyStream since:base];
+        }
+    }
+
+    NSLog(@"BENCHMARK multipart 50MB peak footprint: %.1fMB with file data, %.1fMB with a file URL", peaks[0], peaks[1]);
+    [self recordResult:@{@"fileDataPeakMB": [NSNumber numberWithDouble:peaks[0]],
+                         @"fileURLPeakMB": [NSNumber numberWithDouble:peaks[1]]}
+                  name:@"AFMultipartBodyStream.upload/50MB"];
+
+    STAssertTrue(peaks[1] < 10, @"File parts are not copied to the heap");
+
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+#pragma mark - Network executor
+
+- (void)testNetworkCallbackLatency
+{
+    [SXStandInServer start];
+    [SXStandInServer setLatency:0.005 jitter:0.005];
+
+    dispatch_queue_t callbackQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    AFHTTPClient *httpClient = [[AFHTTPClient alloc] initWithBaseURL:[NSURL URLWithString:SANDBOX_API_URL]];
+    httpClient.maxConcurrentOperationCountPerHost = MAX_CONCURRENT_REQUESTS_PER_HOST;
+
+    for (NSNumber *threadCount in @[@1, @4]) {
+        [AFURLConnectionOperation setNetworkRequestThreadCount:threadCount.unsignedIntegerValue];
+        SXLatencyHistogram *histogram = [[SXLatencyHistogram alloc] init];
+        dispatch_group_t group = dispatch_group_create();
+
+        for (int i = 0; i < 200; i++) {
+            NSURLRequest *request = [httpClient requestWithMethod:@"POST" path:@"oauth/anonymousAccessToken" parameters:@{@"clientId": @"benchmark"}];
+            NSTimeInterval enqueuedAt = SXMetricsTimestamp();
+            void(^done)(void) = ^{
+                @synchronized(histogram) {
+                    [histogram addSample:SXMetricsTimestamp() - enqueuedAt];
+                }
+                dispatch_group_leave(group);
+            };
+            AFHTTPRequestOperation *operation = [httpClient HTTPRequestOperationWithRequest:request success:^(AFHTTPRequestOperation *operation, id responseObject) {
+                done();
+            } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
+                done();
+            }];
+            operation.successCallbackQueue = callbackQueue;
+            operation.failureCallbackQueue = callbackQueue;
+            dispatch_group_enter(group);
+            [httpClient enqueueHTTPRequestOperation:operation];
+        }
+
+        STAssertEquals(0L, dispatch_group_wait(group, dispatch_time(DISPATCH_TIME_NOW, 60 * NSEC_PER_SEC)), @"Every request completes");
+
+        double p50 = [histogram valueAtPercentile:50] * 1000;
+        double p99 = [histogram valueAtPercentile:99] * 1000;
+        NSLog(@"BENCHMARK network callback latency, %@ thread(s): p50 %.2fms, p99 %.2fms", threadCount, p50, p99);
+        [self recordResult:@{@"p50Ms": [NSNumber numberWithDouble:p50],
+                             @"p99Ms": [NSNumber numberWithDouble:p99]}
+                      name:[NSString stringWithFormat:@"AFHTTPClient.callbackLatency/%@threads", threadCount]];
+    }
+
+    [AFURLConnectionOperation setNetworkRequestThreadCount:NETWORK_THREAD_COUNT];
+    [SXStandInServer stop];
+}
+
+#pragma mark - Operation state
+
+- (void)testOperationStateContention
+{
+    [SXStandInServer start];
+
+    // Handlers reading the parsed response of a finished operation from many queues
+    AFHTTPClient *httpClient = [[AFHTTPClient alloc] initWithBaseURL:[NSURL URLWithString:SANDBOX_API_URL]];
+    NSURLRequest *request = [httpClient requestWithMethod:@"POST" path:@"oauth/anonymousAccessToken" parameters:@{@"clientId": @"benchmark"}];
+    AFJSONRequestOperation *finished = [[AFJSONRequestOperation alloc] initWithRequest:request];
+    [finished start];
+    [finished waitUntilFinished];
+    STAssertNotNil(finished.responseJSON, @"The stand-in server answers with JSON");
+
+    for (NSNumber *threads in @[@1, @4, @8]) {
+        [self measure:[NSString stringWithFormat:@"AFJSONRequestOperation.responseJSON/%@threads", threads] threads:threads.unsignedIntegerValue iterations:100000 block:^(NSUInteger index) {
+            if (![finished isFinished] || !finished.responseJSON)
+                STFail(@"The response stays published");
+        }];
+    }
+
+    // Threads racing to cancel the same operations: each one is cancelled exactly once
+    NSUInteger count = 10000;
+    NSMutableArray *operations = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++)
+        [operations addObject:[[AFJSONRequestOperation alloc] initWithRequest:request]];
+    [self measure:@"AFURLConnectionOperation.cancel/4threads" threads:4 iterations:count block:^(NSUInteger index) {
+        [[operations objectAtIndex:index % count] cancel];
+    }];
+    for (AFJSONRequestOperation *operation in operations)
+        STAssertTrue([operation isCancelled], @"Every operation is cancelled");
+
+    [SXStandInServer stop];
+}
+
+#pragma mark - Request vault
+
+- (void)testVaultBenchmarks
+{
+    [SXStandInServer reset];
+    [SXStandInServer start];
+    [Scoreflex setClientId:@"benchmark" secret:@"benchmark" sandboxMode:YES];
+    SXClient *client = [SXClient sharedClient];
+
+    // Requests saved by earlier runs would be replayed by the vault and change its size while measured
+    [SXRequestVault reset];
+    SXRequestVault *vault = [[SXRequestVault alloc] initWithClient:client];
+
+    SXRequest *request = [[SXRequest alloc] init];
+    request.method = @"POST";
+    request.resource = @"scores/level1";
+    request.params = @{@"score": @"123456"};
+
+    for (NSNumber *size in @[@10, @1000, @10000]) {
+        NSUInteger count = size.unsignedIntegerValue;
+
+        // Each save: and forget: pair leaves the vault at the same size
+        [self fillVault:vault count:count];
+        [self measure:[NSString stringWithFormat:@"SXRequestVault.save+forget/%lu", (unsigned long)count] iterations:20 block:^{
+            objc_msgSend(vault, @selector(save:), request);
+            objc_msgSend(vault, @selector(forget:), request);
+        }];
+
+        [self measure:[NSString stringWithFormat:@"SXRequestVault.forget/%lu", (unsigned long)count] iterations:20 block:^{
+            objc_msgSend(vault, @selector(forget:), request);
+        }];
+
+        [self measure:[NSString stringWithFormat:@"SXRequestVault.savedRequests/%lu", (unsigned long)count] iterations:5 block:^{
+            STAssertEquals(count, [objc_msgSend(vault, @selector(savedRequests)) count], @"Vault size is stable");
+        }];
+    }
+
+    [vault reset];
+    [SXStandInServer stop];
+}
+
+@end
@@ -0,0 +1,168 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXCancellationTokenTest.h"
+#import "SXCancellationToken.h"
+#import "SXStandInServer.h"
+#import "SXClient.h"
+#import "SXConfiguration.h"
+#import "SXUtil.h"
+#import "Scoreflex.h"
+
+@interface SXCancellationTokenTest ()
+
+- (void) runUntil:(BOOL(^)(void))condition timeout:(NSTimeInterval)timeout;
+
+@end
+
+@implementation SXCancellationTokenTest
+
+- (void) runUntil:(BOOL(^)(void))condition timeout:(NSTimeInterval)timeout
+{
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:timeout];
+    while (!condition() && [deadline timeIntervalSinceNow] > 0)
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+}
+
+- (void)testCancellationHandlers
+{
+    SXCancellationToken *token = [[SXCancellationToken alloc] init];
+    __block NSUInteger calls = 0;
+
+    [token addCancellationHandler:^(NSError *error) {
+        calls++;
+        STAssertNil(error, @"An explicit cancel has no error");
+    }];
+    id removed = [token addCancellationHandler:^(NSError *error) {
+        STFail(@"A removed handler is not called");
+    }];
+    [token removeCancellationHandler:removed];
+
+    STAssertFalse(token.isCancelled, @"Not cancelled yet");
+    [token cancel];
+    [token cancel];
+    STAssertTrue(token.isCancelled, @"Cancelled");
+    STAssertEquals((NSUInteger)1, calls, @"Handlers are called once");
+
+    id registration = [token addCancellationHandler:^(NSError *error) {
+        calls++;
+    }];
+    STAssertNil(registration, @"No registration once cancelled");
+    STAssertEquals((NSUInteger)2, calls, @"Late handlers are called immediately");
+}
+
+- (void)testDeadline
+{
+    SXCancellationToken *token = [[SXCancellationToken alloc] init];
+    __block NSError *cancellationError = nil;
+    [token addCancellationHandler:^(NSError *error) {
+        cancellationError = error;
+    }];
+
+    token.deadline = [NSDate dateWithTimeIntervalSinceNow:0.1];
+    STAssertFalse([token cancelIfExpired], @"The deadline has not passed");
+
+    [self runUntil:^BOOL{ return token.isCancelled; } timeout:2];
+    STAssertTrue(token.isCancelled, @"Cancelled at the deadline");
+    STAssertEquals(SXErrorRequestTimedOut, cancellationError.code, @"Handlers get a timeout error");
+    STAssertEqualObjects(SXErrorDomain, cancellationError.domain, @"The error is a Scoreflex error");
+}
+
+- (void)testRequestCopiesShareToken
+{
+    SXRequest *request = [[SXRequest alloc] init];
+    [request setTimeout:60];
+    SXRequest *copy = [request copy];
+
+    STAssertEquals(request.cancellationToken, copy.cancellationToken, @"Copies share the token");
+    STAssertEqualObjects(request.deadline, copy.deadline, @"Copies share the deadline");
+
+    [request cancel];
+    STAssertTrue(copy.cancellationToken.isCancelled, @"Cancelling the request cancels its copies");
+}
+
+- (void)testRequestDeadline
+{
+    [SXStandInServer reset];
+    [SXStandInServer setLatency:2 jitter:0];
+    [SXStandInServer start];
+
+    [Scoreflex setClientId:@"cancellation" secret:@"cancellation" sandboxMode:YES];
+    [[SXConfiguration sharedConfiguration] setAccessToken:@"token" anonymous:YES];
+
+    __block NSError *requestError = nil;
+    __block NSUInteger calls = 0;
+    SXRequest *request = [[SXRequest alloc] init];
+    request.method = @"GET";
+    request.resource = @"network/ping";
+    request.handler = ^(SXResponse *response, NSError *error) {
+        requestError = error;
+        calls++;
+    };
+    [request setTimeout:0.2];
+
+    NSTimeInterval start = [NSDate timeIntervalSinceReferenceDate];
+    [[SXClient sharedClient] requestAuthenticated:request];
+    [self runUntil:^BOOL{ return calls > 0; } timeout:5];
+    NSTimeInterval elapsed = [NSDate timeIntervalSinceReferenceDate] - start;
+
+    STAssertEquals(SXErrorRequestTimedOut, requestError.code, @"The handler gets a timeout error");
+    STAssertTrue(elapsed < 1, @"The handler is called at the deadline, not when the server answers");
+
+    // The late response is dropped
+    [self runUntil:^BOOL{ return NO; } timeout:2.5];
+    STAssertEquals((NSUInteger)1, calls, @"The handler is called once");
+
+    [SXStandInServer stop];
+}
+
+- (void)testCancelledRequestIsReleased
+{
+    [SXStandInServer reset];
+    [SXStandInServer setLatency:1 jitter:0];
+    [SXStandInServer start];
+
+    [Scoreflex setClientId:@"cancellation" secret:@"cancellation" sandboxMode:YES];
+    [[SXConfiguration sharedConfiguration] setAccessToken:nil anonymous:YES];
+
+    __block BOOL called = NO;
+    __weak SXRequest *weakRequest = nil;
+    @autoreleasepool {
+        SXRequest *request = [[SXRequest alloc] init];
+        request.method = @"GET";
+        request.resource = @"network/ping";
+        request.handler = ^(SXResponse *response, NSError *error) {
+            called = YES;
+        };
+        weakRequest = request;
+
+        // Parked while the access token is fetched
+        [[SXClient sharedClient] requestAuthenticated:request];
+        [request cancel];
+    }
+
+    STAssertNil(weakRequest, @"A cancelled request is released right away");
+
+    [self runUntil:^BOOL{ return NO; } timeout:2];
+    STAssertFalse(called, @"The handler of a cancelled request is not called");
+
+    [SXStandInServer stop];
+}
+
+@end
@@ -0,0 +1,141 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXClientTest.h"
+#import "SXStandInServer.h"
+#import "SXClient.h"
+#import "SXConfiguration.h"
+#import "Scoreflex.h"
+
+static char SXClientTestQueueKey;
+
+@interface SXClientTest ()
+
+- (void) runUntil:(BOOL(^)(void))condition timeout:(NSTimeInterval)timeout;
+
+@end
+
+@implementation SXClientTest
+
+- (void) setUp
+{
+    [super setUp];
+    [SXStandInServer reset];
+    [SXStandInServer start];
+
+    [Scoreflex setClientId:@"client" secret:@"client" sandboxMode:YES];
+    [[SXConfiguration sharedConfiguration] setAccessToken:@"token" anonymous:YES];
+}
+
+- (void) tearDown
+{
+    [SXClient sharedClient].callbackQueue = NULL;
+    [SXStandInServer stop];
+    [super tearDown];
+}
+
+- (void) runUntil:(BOOL(^)(void))condition timeout:(NSTimeInterval)timeout
+{
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:timeout];
+    while (!condition() && [deadline timeIntervalSinceNow] > 0)
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+}
+
+- (void)testHandlersRunOnMainQueueByDefault
+{
+    __block BOOL called = NO;
+    __block BOOL onMainThread = NO;
+
+    SXRequest *request = [[SXRequest alloc] init];
+    request.method = @"GET";
+    request.resource = @"network/ping";
+    request.handler = ^(SXResponse *response, NSError *error) {
+        onMainThread = [NSThread isMainThread];
+        called = YES;
+    };
+    [[SXClient sharedClient] requestAuthenticated:request];
+
+    [self runUntil:^BOOL{ return called; } timeout:5];
+    STAssertTrue(called, @"The handler is called");
+    STAssertTrue(onMainThread, @"Handlers run on the main queue by default");
+}
+
+- (void)testCallbackQueues
+{
+    dispatch_queue_t requestQueue = dispatch_queue_create("com.scoreflex.test.request", DISPATCH_QUEUE_SERIAL);
+    dispatch_queue_set_specific(requestQueue, &SXClientTestQueueKey, "request", NULL);
+    dispatch_queue_t clientQueue = dispatch_queue_create("com.scoreflex.test.client", DISPATCH_QUEUE_SERIAL);
+    dispatch_queue_set_specific(clientQueue, &SXClientTestQueueKey, "client", NULL);
+
+    [SXClient sharedClient].callbackQueue = clientQueue;
+
+    __block const char *requestQueueName = NULL;
+    __block const char *clientQueueName = NULL;
+
+    SXRequest *request = [[SXRequest alloc] init];
+    request.method = @"GET";
+    request.resource = @"network/ping";
+    request.callbackQueue = requestQueue;
+    request.handler = ^(SXResponse *response, NSError *error) {
+        requestQueueName = dispatch_get_specific(&SXClientTestQueueKey);
+    };
+    [[SXClient sharedClient] requestAuthenticated:request];
+
+    SXRequest *other = [[SXRequest alloc] init];
+    other.method = @"GET";
+    other.resource = @"network/ping";
+    other.handler = ^(SXResponse *response, NSError *error) {
+        clientQueueName = dispatch_get_specific(&SXClientTestQueueKey);
+    };
+    [[SXClient sharedClient] requestAuthenticated:other];
+
+    [self runUntil:^BOOL{ return requestQueueName && clientQueueName; } timeout:5];
+    STAssertTrue(requestQueueName && 0 == strcmp("request", requestQueueName), @"The queue of the request wins");
+    STAssertTrue(clientQueueName && 0 == strcmp("client", clientQueueName), @"The queue of the client is the default");
+    STAssertTrue(requestQueue == [request copy].callbackQueue, @"Copies keep the callback queue");
+
+#if !OS_OBJECT_USE_OBJC
+    dispatch_release(requestQueue);
+    dispatch_release(clientQueue);
+#endif
+}
+
+- (void)testSessionReadyIsShared
+{
+    SXConfiguration *configuration = [SXConfiguration sharedConfiguration];
+    configuration.sid = nil;
+
+    SXPromise *first = [[SXClient sharedClient] sessionReady];
+    SXPromise *second = [[SXClient sharedClient] sessionReady];
+    STAssertEquals(first, second, @"Callers waiting for a session share one promise");
+
+    __block NSString *readySid = nil;
+    [second done:^(id sid, NSError *error) {
+        readySid = sid;
+    }];
+    [self runUntil:^BOOL{ return nil != readySid; } timeout:5];
+    STAssertNotNil(readySid, @"The promise is fulfilled with the session");
+    STAssertEqualObjects(configuration.sid, readySid, @"The session is stored");
+
+    SXPromise *ready = [[SXClient sharedClient] sessionReady];
+    STAssertTrue(ready.isFulfilled, @"With a session, the promise is fulfilled right away");
+    STAssertEqualObjects(readySid, ready.value, @"With the current session");
+}
+
+@end
@@ -0,0 +1,145 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXMetricsTest.h"
+#import "SXMetrics.h"
+#import "SXRequest.h"
+
+@implementation SXMetricsTest
+
+- (void)testHistogramPercentiles
+{
+    SXLatencyHistogram *histogram = [[SXLatencyHistogram alloc] init];
+    STAssertEquals(0., [histogram valueAtPercentile:50], @"Empty histogram");
+
+    for (int i = 1; i <= 100; i++)
+        [histogram addSample:i / 1000.];
+
+    STAssertEquals(100, (int)histogram.count, @"All samples are counted");
+
+    // Buckets grow by 20%, so values are within that of the exact percentile
+    STAssertEqualsWithAccuracy(0.050, [histogram valueAtPercentile:50], 0.050 * 0.2, @"p50");
+    STAssertEqualsWithAccuracy(0.095, [histogram valueAtPercentile:95], 0.095 * 0.2, @"p95");
+    STAssertEqualsWithAccuracy(0.099, [histogram valueAtPercentile:99], 0.099 * 0.2, @"p99");
+}
+
+- (void)testTimeline
+{
+    SXMetrics *metrics = [SXMetrics sharedMetrics];
+    metrics.enabled = YES;
+    [metrics reset];
+
+    SXRequest *request = [[SXRequest alloc] init];
+    request.resource = @"scores/level1";
+    request.method = @"POST";
+
+    SXRequestTimeline *timeline = [[SXRequestTimeline alloc] initWithRequest:request];
+    STAssertTrue([timeline durationForPhase:SXMetricsPhaseNetwork] < 0, @"Phase not measured");
+
+    [timeline endPhase:SXMetricsPhaseDecoration];
+    STAssertTrue([timeline durationForPhase:SXMetricsPhaseDecoration] < 0, @"Phase not begun");
+
+    [timeline beginPhase:SXMetricsPhaseNetwork];
+    [NSThread sleepForTimeInterval:0.01];
+    [timeline endPhase:SXMetricsPhaseNetwork];
+    STAssertTrue([timeline durationForPhase:SXMetricsPhaseNetwork] >= 0.01, @"Phase measured");
+
+    [metrics recordTimeline:timeline];
+    NSDictionary *snapshot = [metrics snapshot];
+    STAssertEquals(1, [[snapshot valueForKeyPath:@"scores/:id.network.count"] intValue], @"Network phase recorded");
+    STAssertEquals(1, [[snapshot valueForKeyPath:@"scores/:id.total.count"] intValue], @"Total recorded");
+    STAssertNil([snapshot valueForKeyPath:@"scores/:id.parse"], @"Unmeasured phase not recorded");
+
+    metrics.enabled = NO;
+    [metrics recordTimeline:timeline];
+    STAssertEquals(1, [[[metrics snapshot] valueForKeyPath:@"scores/:id.total.count"] intValue], @"Nothing recorded when disabled");
+}
+
+- (void)testSnapshotDescriptionIsAligned
+{
+    SXMetrics *metrics = [[SXMetrics alloc] init];
+    metrics.enabled = YES;
+    [metrics recordDuration:0.01 metric:@"a" group:@"group"];
+    [metrics recordDuration:0.01 metric:@"network" group:@"group"];
+    metrics.enabled = NO;
+
+    NSArray *lines = [[metrics snapshotDescription] componentsSeparatedByString:@"\n"];
+    STAssertEquals([[lines objectAtIndex:1] rangeOfString:@"n="].location, [[lines objectAtIndex:2] rangeOfString:@"n="].location, @"Columns are aligned");
+}
+
+- (void)testRouteForResource
+{
+    STAssertEqualObjects(@"scores/:id", [SXMetrics routeForResource:@"scores/level1"], @"Identifiers are replaced");
+    STAssertEqualObjects(@"scores/:id/best", [SXMetrics routeForResource:@"/scores/level1/best"], @"Leading slash is dropped");
+    STAssertEqualObjects(@"challenges/instances/:id/turns", [SXMetrics routeForResource:@"challenges/instances/42/turns"], @"Inner identifiers are replaced");
+    STAssertEqualObjects(@"web/players/me", [SXMetrics routeForResource:@"web/players/me?lang=en"], @"Path words are kept and the query is dropped");
+    STAssertEqualObjects(@"web/players/:id/friends", [SXMetrics routeForResource:@"web/players/1234/friends"], @"Player identifiers are replaced");
+    STAssertEqualObjects(@"", [SXMetrics routeForResource:nil], @"No resource");
+}
+
+- (void)testConcurrentTimeline
+{
+    SXViewLoadTimeline *timeline = [[SXViewLoadTimeline alloc] initWithResource:@"web/players/me"];
+    dispatch_apply(1000, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        SXViewLoadPhase phase = (SXViewLoadPhase)(i % SXViewLoadPhaseCount);
+        [timeline beginPhase:phase];
+        [timeline endPhase:phase];
+        [timeline totalDuration];
+    });
+    for (int i = 0; i < SXViewLoadPhaseCount; i++)
+        STAssertTrue([timeline durationForPhase:i] >= 0, @"Every phase measured");
+}
+
+- (void)testViewLoadTimeline
+{
+    SXMetrics *metrics = [SXMetrics sharedMetrics];
+    metrics.enabled = YES;
+    [metrics reset];
+
+    SXViewLoadTimeline *timeline = [[SXViewLoadTimeline alloc] initWithResource:@"web/players/me"];
+    timeline.preloaded = YES;
+    NSURL *URL = [NSURL URLWithString:@"http://api.scoreflex.com/v1/web/players/me?lang=en#start"];
+    [metrics trackViewLoad:timeline forURL:URL];
+    STAssertEquals(timeline, [metrics viewLoadForURL:[NSURL URLWithString:@"http://api.scoreflex.com/v1/web/players/me?lang=en"]], @"Loads are tracked without fragment");
+
+    [timeline beginPhase:SXViewLoadPhaseRequest];
+    [timeline endPhase:SXViewLoadPhaseRequest];
+    [timeline beginPhase:SXViewLoadPhaseFirstByte];
+    [NSThread sleepForTimeInterval:0.01];
+    [[metrics viewLoadForURL:URL] receivedFirstByteFromCache:YES];
+    [timeline endPhase:SXViewLoadPhaseRender];
+    STAssertTrue(timeline.cacheHit, @"Cache hits are recorded");
+    STAssertTrue([timeline durationForPhase:SXViewLoadPhaseFirstByte] >= 0.01, @"First byte measured");
+    STAssertTrue([timeline durationForPhase:SXViewLoadPhaseRender] >= 0, @"Render measured");
+    STAssertTrue([timeline durationForPhase:SXViewLoadPhaseTokenWait] < 0, @"No token wait");
+
+    [metrics trackViewLoad:nil forURL:URL];
+    STAssertNil([metrics viewLoadForURL:URL], @"Loads can be untracked");
+
+    [metrics recordViewLoad:timeline];
+    NSDictionary *snapshot = [metrics snapshot];
+    STAssertEquals(1, [[snapshot valueForKeyPath:@"web/players/me.firstByte.count"] intValue], @"First byte recorded");
+    STAssertEquals(1, [[snapshot valueForKeyPath:@"web/players/me.totalPreloaded.count"] intValue], @"Preloaded load recorded");
+    STAssertEquals(1, [[snapshot valueForKeyPath:@"web/players/me.totalCacheHit.count"] intValue], @"Cache hit recorded");
+    STAssertNil([snapshot valueForKeyPath:@"web/players/me.totalCold"], @"Not a cold load");
+
+    metrics.enabled = NO;
+}
+
+@end
@@ -0,0 +1,153 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXNetworkPolicyTest.h"
+#import "SXNetworkPolicy.h"
+#import "SXMetrics.h"
+#import "SXClient.h"
+#import "SXStandInServer.h"
+#import "Scoreflex.h"
+#import "AFHTTPRequestOperation.h"
+#import <libkern/OSAtomic.h>
+
+@interface SXNetworkPolicyTest ()
+
+- (NSUInteger) runningOperationCountWithClient:(AFHTTPClient *)httpClient;
+
+@end
+
+@implementation SXNetworkPolicyTest
+
+- (NSUInteger) runningOperationCountWithClient:(AFHTTPClient *)httpClient
+{
+    return [[httpClient.operationQueue.operations filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"isFinished == NO"]] count];
+}
+
+- (void)testNetworkClasses
+{
+    SXNetworkPolicy *policy = [[SXNetworkPolicy alloc] init];
+    STAssertEquals(SXNetworkClassOffline, policy.networkClass, @"Offline until reachability is known");
+    STAssertFalse(policy.shouldReplayRequests, @"Nothing is replayed offline");
+
+    [policy updateWithReachabilityStatus:AFNetworkReachabilityStatusReachableViaWiFi];
+    STAssertEquals(SXNetworkClassWiFi, policy.networkClass, @"Wi-Fi is detected");
+    STAssertTrue(policy.shouldReplayRequests, @"Requests are replayed on Wi-Fi");
+    STAssertEquals((NSInteger)MAX_CONCURRENT_REQUESTS_PER_HOST, policy.maxConcurrentRequests, @"Full concurrency on Wi-Fi");
+
+    [policy updateWithReachabilityStatus:AFNetworkReachabilityStatusReachableViaWWAN];
+    STAssertEquals(SXNetworkClassCellular, policy.networkClass, @"Cellular is detected");
+    STAssertTrue(policy.maxConcurrentRequests < MAX_CONCURRENT_REQUESTS_PER_HOST, @"Less concurrency on cellular");
+    STAssertTrue(policy.shouldReplayRequests, @"Requests are replayed on cellular by default");
+
+    policy.defersReplayOnCellular = YES;
+    STAssertFalse(policy.shouldReplayRequests, @"Replay waits for Wi-Fi when configured");
+    [policy updateWithReachabilityStatus:AFNetworkReachabilityStatusReachableViaWiFi];
+    STAssertTrue(policy.shouldReplayRequests, @"Replay resumes on Wi-Fi");
+
+    [policy updateWithReachabilityStatus:AFNetworkReachabilityStatusNotReachable];
+    STAssertFalse(policy.shouldReplayRequests, @"Replay stops offline");
+}
+
+- (void)testMeasurements
+{
+    SXNetworkPolicy *policy = [[SXNetworkPolicy alloc] init];
+    [policy updateWithReachabilityStatus:AFNetworkReachabilityStatusReachableViaWiFi];
+
+    [policy recordTransferOfLength:512 duration:0.1];
+    STAssertEqualsWithAccuracy(0.1, policy.roundTripTime, 0.0001, @"The first sample sets the round trip time");
+    [policy recordTransferOfLength:512 duration:0.2];
+    STAssertEqualsWithAccuracy(0.12, policy.roundTripTime, 0.0001, @"Later samples are smoothed");
+    STAssertFalse([policy isSlow], @"A fast network");
+
+    // A congested link
+    for (int i = 0; i < 20; i++)
+        [policy recordTransferOfLength:512 duration:3.0];
+    STAssertTrue([policy isSlow], @"A slow network");
+    STAssertEquals((NSInteger)1, policy.maxConcurrentRequests, @"One request at a time on slow networks");
+    STAssertEqualsWithAccuracy(0.5, policy.imageScaleFactor, 0.001, @"Smaller images on slow networks");
+
+    [policy recordTransferOfLength:1024 * 1024 duration:2.0];
+    STAssertEqualsWithAccuracy(512.0 * 1024, policy.throughput, 1, @"Large responses measure the throughput");
+
+    [policy updateWithReachabilityStatus:AFNetworkReachabilityStatusReachableViaWWAN];
+    STAssertEquals(0.0, policy.roundTripTime, @"Measurements are reset on a new network");
+    STAssertFalse([policy isSlow], @"A new network is not slow until measured");
+}
+
+- (void)testConcurrencyAppliesToPendingRequests
+{
+    [SXStandInServer reset];
+    [SXStandInServer start];
+    [SXStandInServer setLatency:0.1 jitter:0];
+    [Scoreflex setClientId:@"client" secret:@"client" sandboxMode:YES];
+
+    SXNetworkPolicy *policy = [SXNetworkPolicy sharedPolicy];
+    AFHTTPClient *httpClient = [SXClient sharedClient].httpClient;
+    [policy updateWithReachabilityStatus:AFNetworkReachabilityStatusReachableViaWiFi];
+    STAssertEquals((NSInteger)MAX_CONCURRENT_REQUESTS_PER_HOST, httpClient.maxConcurrentOperationCountPerHost, @"Full concurrency on Wi-Fi");
+
+    // A backlog of requests waiting for the host
+    int count = MAX_CONCURRENT_REQUESTS_PER_HOST * 4;
+    __block int32_t finished = 0;
+    for (int i = 0; i < count; i++) {
+        NSURLRequest *request = [httpClient requestWithMethod:@"GET" path:@"network/ping" parameters:nil];
+        AFHTTPRequestOperation *operation = [httpClient HTTPRequestOperationWithRequest:request success:nil failure:nil];
+        operation.completionBlock = ^{
+            OSAtomicIncrement32(&finished);
+        };
+        [httpClient enqueueHTTPRequestOperation:operation];
+    }
+
+    // A slow link allows a single request at a time once the requests in flight are done
+    for (int i = 0; i < 20; i++)
+        [policy recordTransferOfLength:512 duration:3.0];
+    STAssertEquals((NSInteger)1, httpClient.maxConcurrentOperationCountPerHost, @"The client follows the policy");
+
+    NSUInteger maxRunning = 0;
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:30];
+    while (finished < count && [deadline timeIntervalSinceNow] > 0) {
+        if (finished >= MAX_CONCURRENT_REQUESTS_PER_HOST)
+            maxRunning = MAX(maxRunning, [self runningOperationCountWithClient:httpClient]);
+        [NSThread sleepForTimeInterval:0.01];
+    }
+    STAssertEquals(count, (int)finished, @"The backlog is sent");
+    STAssertTrue(maxRunning <= 1, @"The backlog is sent one request at a time");
+
+    // Back to a fast network
+    [policy updateWithReachabilityStatus:AFNetworkReachabilityStatusReachableViaWWAN];
+    [policy updateWithReachabilityStatus:AFNetworkReachabilityStatusReachableViaWiFi];
+    STAssertEquals((NSInteger)MAX_CONCURRENT_REQUESTS_PER_HOST, httpClient.maxConcurrentOperationCountPerHost, @"Full concurrency is restored");
+
+    [SXStandInServer reset];
+    [SXStandInServer stop];
+}
+
+- (void)testDecisionsAreExposedInMetrics
+{
+    SXNetworkPolicy *policy = [[SXNetworkPolicy alloc] init];
+    [policy updateWithReachabilityStatus:AFNetworkReachabilityStatusReachableViaWWAN];
+    policy.defersReplayOnCellular = YES;
+
+    NSDictionary *network = [[[SXMetrics sharedMetrics] snapshot] objectForKey:@"network"];
+    STAssertEqualObjects([NSNumber numberWithBool:NO], [network objectForKey:@"shouldReplayRequests"], @"The last decision is recorded");
+    STAssertEqualObjects([NSNumber numberWithInt:SXNetworkClassCellular], [network objectForKey:@"networkClass"], @"The network class is recorded");
+    STAssertTrue([[[SXMetrics sharedMetrics] snapshotDescription] rangeOfString:@"maxConcurrentRequests"].location != NSNotFound, @"Values are described");
+}
+
+@end
@@ -0,0 +1,132 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXNotificationPipelineTest.h"
+#import "SXNotificationPipeline.h"
+#import "SXMetrics.h"
+#import "Scoreflex.h"
+
+@interface SXNotificationPipelineTest ()
+
+- (NSDictionary *) notificationWithCode:(int)code data:(NSDictionary *)data;
+
+@end
+
+@implementation SXNotificationPipelineTest
+
+- (NSDictionary *) notificationWithCode:(int)code data:(NSDictionary *)data
+{
+    return @{@"code": [NSNumber numberWithInt:code], @"data": data};
+}
+
+- (void)testDuplicatesAreMerged
+{
+    SXNotificationPipeline *pipeline = [[SXNotificationPipeline alloc] init];
+
+    STAssertTrue([pipeline enqueueNotification:[self notificationWithCode:SX_PUSH_NOTIFICATION_TYPE_FRIEND_JOINED_GAME data:@{@"friendId": @"1"}]], @"The first notification is queued");
+    STAssertFalse([pipeline enqueueNotification:[self notificationWithCode:SX_PUSH_NOTIFICATION_TYPE_FRIEND_JOINED_GAME data:@{@"friendId": @"1", @"seq": @"2"}]], @"The same code and target is merged");
+    STAssertTrue([pipeline enqueueNotification:[self notificationWithCode:SX_PUSH_NOTIFICATION_TYPE_FRIEND_JOINED_GAME data:@{@"friendId": @"2"}]], @"Another target is queued");
+    STAssertEquals((NSUInteger)2, pipeline.pendingCount, @"Two notifications are pending");
+
+    NSArray *notifications = [pipeline takePendingNotifications];
+    STAssertEquals((NSUInteger)2, notifications.count, @"Both are drained");
+    STAssertEquals((NSUInteger)0, pipeline.pendingCount, @"The queue is empty");
+    STAssertEqualObjects(@"2", [[notifications objectAtIndex:0] valueForKeyPath:@"data.friendId"], @"The most recent one comes first");
+    STAssertEqualObjects(@"2", [[notifications objectAtIndex:1] valueForKeyPath:@"data.seq"], @"The most recent duplicate wins");
+}
+
+- (void)testPriority
+{
+    SXNotificationPipeline *pipeline = [[SXNotificationPipeline alloc] init];
+    [pipeline enqueueNotification:[self notificationWithCode:SX_PUSH_NOTIFICATION_TYPE_PLAYER_LEVEL_CHANGED data:@{}]];
+    [pipeline enqueueNotification:[self notificationWithCode:SX_PUSH_NOTIFICATION_TYPE_YOUR_TURN_IN_CHALLENGE data:@{@"challengeInstanceId": @"c"}]];
+    [pipeline enqueueNotification:[self notificationWithCode:SX_PUSH_NOTIFICATION_TYPE_FRIEND_BEAT_YOUR_HIGHSCORE data:@{@"leaderboardId": @"lb"}]];
+
+    NSArray *codes = [[pipeline takePendingNotifications] valueForKey:@"code"];
+    NSArray *expected = @[[NSNumber numberWithInt:SX_PUSH_NOTIFICATION_TYPE_YOUR_TURN_IN_CHALLENGE],
+                          [NSNumber numberWithInt:SX_PUSH_NOTIFICATION_TYPE_FRIEND_BEAT_YOUR_HIGHSCORE],
+                          [NSNumber numberWithInt:SX_PUSH_NOTIFICATION_TYPE_PLAYER_LEVEL_CHANGED]];
+    STAssertEqualObjects(expected, codes, @"Notifications are sorted by priority");
+}
+
+- (void)testQueueIsBounded
+{
+    SXNotificationPipeline *pipeline = [[SXNotificationPipeline alloc] init];
+    [pipeline enqueueNotification:[self notificationWithCode:SX_PUSH_NOTIFICATION_TYPE_CHALLENGE_INVITATION data:@{@"challengeInstanceId": @"c"}]];
+    for (int i = 0; i < NOTIFICATION_PIPELINE_MAX_COUNT * 2; i++)
+        [pipeline enqueueNotification:[self notificationWithCode:SX_PUSH_NOTIFICATION_TYPE_FRIEND_JOINED_GAME data:@{@"friendId": [NSString stringWithFormat:@"%d", i]}]];
+
+    STAssertEquals((NSUInteger)NOTIFICATION_PIPELINE_MAX_COUNT, pipeline.pendingCount, @"The queue is bounded");
+    NSArray *notifications = [pipeline takePendingNotifications];
+    STAssertEquals(SX_PUSH_NOTIFICATION_TYPE_CHALLENGE_INVITATION, [[[notifications objectAtIndex:0] objectForKey:@"code"] intValue], @"The highest priority notification is kept");
+    STAssertEqualObjects(([NSString stringWithFormat:@"%d", NOTIFICATION_PIPELINE_MAX_COUNT * 2 - 1]), [[notifications objectAtIndex:1] valueForKeyPath:@"data.friendId"], @"The most recent ones are kept");
+}
+
+- (void)testNothingIsDrainedWithoutHandler
+{
+    SXNotificationPipeline *pipeline = [[SXNotificationPipeline alloc] init];
+    [pipeline enqueueNotification:[self notificationWithCode:SX_PUSH_NOTIFICATION_TYPE_PLAYER_LEVEL_CHANGED data:@{}]];
+    [pipeline flush];
+    STAssertEquals((NSUInteger)1, pipeline.pendingCount, @"Notifications wait for the handler");
+
+    __block NSArray *drained = nil;
+    pipeline.handler = ^(NSArray *notifications) {
+        drained = notifications;
+    };
+    [pipeline flush];
+    STAssertEquals((NSUInteger)1, drained.count, @"The notifications received before the handler are drained");
+}
+
+- (void)testBurstThroughput
+{
+    SXNotificationPipeline *pipeline = [[SXNotificationPipeline alloc] init];
+    __block NSUInteger batchCount = 0;
+    __block NSArray *batch = nil;
+    pipeline.handler = ^(NSArray *notifications) {
+        batchCount++;
+        batch = notifications;
+    };
+
+    NSUInteger count = 10000;
+    NSArray *codes = @[[NSNumber numberWithInt:SX_PUSH_NOTIFICATION_TYPE_FRIEND_JOINED_GAME],
+                       [NSNumber numberWithInt:SX_PUSH_NOTIFICATION_TYPE_CHALLENGE_ENDED],
+                       [NSNumber numberWithInt:SX_PUSH_NOTIFICATION_TYPE_YOUR_TURN_IN_CHALLENGE],
+                       [NSNumber numberWithInt:SX_PUSH_NOTIFICATION_TYPE_PLAYER_LEVEL_CHANGED]];
+
+    NSTimeInterval start = SXMetricsTimestamp();
+    dispatch_apply(count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        NSString *target = [NSString stringWithFormat:@"%zu", i % 8];
+        [pipeline enqueueNotification:@{@"code": [codes objectAtIndex:i % codes.count],
+                                        @"data": @{@"challengeInstanceId": target, @"friendId": target}}];
+    });
+    NSTimeInterval duration = SXMetricsTimestamp() - start;
+    NSLog(@"Enqueued %lu notifications in %.3fs", (unsigned long)count, duration);
+    STAssertTrue(duration < 1.0, @"A burst of notifications is enqueued quickly");
+
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:2];
+    while (batchCount == 0 && [deadline timeIntervalSinceNow] > 0)
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+
+    STAssertEquals((NSUInteger)1, batchCount, @"The burst is drained in a single batch");
+    STAssertEquals((NSUInteger)8, batch.count, @"Duplicates are merged");
+    STAssertEquals(SX_PUSH_NOTIFICATION_TYPE_YOUR_TURN_IN_CHALLENGE, [[[batch objectAtIndex:0] objectForKey:@"code"] intValue], @"The highest priority notification comes first");
+    STAssertEquals((NSUInteger)0, pipeline.pendingCount, @"The queue is empty");
+}
+
+@end
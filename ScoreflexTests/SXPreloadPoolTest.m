@@ -0,0 +1,112 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXPreloadPoolTest.h"
+#import "SXPreloadPool.h"
+
+@interface SXPreloadPoolTest ()
+
+- (SXViewController *) controller;
+
+@end
+
+@implementation SXPreloadPoolTest
+
+- (SXViewController *) controller
+{
+    return [[SXViewController alloc] initWithNibName:nil bundle:nil];
+}
+
+- (void)testLRUEviction
+{
+    SXPreloadPool *pool = [[SXPreloadPool alloc] init];
+    pool.maxCost = 0;
+    pool.maxCount = 2;
+
+    SXViewController *a = [self controller];
+    [pool setController:a forResource:@"a"];
+    [pool setController:[self controller] forResource:@"b"];
+
+    // Touch a, so b is the least recently used
+    STAssertEquals(a, [pool controllerForResource:@"a"], @"a is preloaded");
+    [pool setController:[self controller] forResource:@"c"];
+
+    STAssertEquals((NSUInteger)2, pool.count, @"The pool stays within its entry budget");
+    STAssertNil([pool controllerForResource:@"b"], @"The least recently used resource is evicted");
+    STAssertNotNil([pool controllerForResource:@"a"], @"Recently used resources are kept");
+    STAssertNotNil([pool controllerForResource:@"c"], @"The new resource is kept");
+
+    STAssertEquals(a, [pool takeControllerForResource:@"a"], @"A controller can be taken to be shown");
+    STAssertNil([pool controllerForResource:@"a"], @"A taken controller leaves the pool");
+}
+
+- (void)testCostBudget
+{
+    SXPreloadPool *pool = [[SXPreloadPool alloc] init];
+    pool.maxCount = 10;
+
+    [pool setController:[self controller] forResource:@"a"];
+    NSUInteger cost = pool.totalCost;
+    STAssertTrue(cost > 0, @"Controllers have a cost");
+
+    pool.maxCost = cost * 2;
+    [pool setController:[self controller] forResource:@"b"];
+    [pool setController:[self controller] forResource:@"c"];
+
+    STAssertEquals((NSUInteger)2, pool.count, @"The pool stays within its memory budget");
+    STAssertTrue(pool.totalCost <= pool.maxCost, @"The total cost is within budget");
+    STAssertNil([pool controllerForResource:@"a"], @"The oldest resource is evicted");
+}
+
+- (void)testRecycling
+{
+    SXPreloadPool *pool = [[SXPreloadPool alloc] init];
+    pool.maxCost = 0;
+    pool.maxCount = 1;
+
+    SXViewController *a = [self controller];
+    a.request = [[SXRequest alloc] init];
+    [pool setController:a forResource:@"a"];
+    [pool setController:[self controller] forResource:@"b"];
+
+    STAssertEquals((NSUInteger)1, pool.recycledCount, @"The evicted controller is kept for reuse");
+    SXViewController *reused = [pool dequeueReusableController];
+    STAssertEquals(a, reused, @"The evicted controller is reused");
+    STAssertNil(reused.request, @"A reused controller is reset");
+    STAssertEquals((NSUInteger)0, pool.recycledCount, @"A reused controller leaves the recycle bin");
+}
+
+- (void)testMemoryWarning
+{
+    SXPreloadPool *pool = [[SXPreloadPool alloc] init];
+    pool.maxCost = 0;
+    pool.maxCount = 3;
+
+    [pool setController:[self controller] forResource:@"a"];
+    [pool setController:[self controller] forResource:@"b"];
+    [pool removeControllerForResource:@"a"];
+    STAssertEquals((NSUInteger)1, pool.recycledCount, @"A freed controller is recycled");
+
+    [pool handleMemoryWarning];
+    STAssertEquals((NSUInteger)0, pool.count, @"Memory warnings evict every preloaded resource");
+    STAssertEquals((NSUInteger)0, pool.recycledCount, @"Memory warnings drop recycled controllers");
+    STAssertEquals((NSUInteger)0, pool.totalCost, @"Nothing is accounted anymore");
+}
+
+@end
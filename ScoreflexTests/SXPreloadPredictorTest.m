@@ -0,0 +1,102 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXPreloadPredictorTest.h"
+#import "SXPreloadPredictor.h"
+
+@implementation SXPreloadPredictorTest
+
+- (void)setUp
+{
+    [super setUp];
+    [[SXPreloadPredictor sharedPredictor] reset];
+}
+
+- (void)tearDown
+{
+    [[SXPreloadPredictor sharedPredictor] reset];
+    [super tearDown];
+}
+
+- (void)testPrediction
+{
+    SXPreloadPredictor *predictor = [SXPreloadPredictor sharedPredictor];
+
+    [predictor recordVisit:@"web/scores/lb/ranks"];
+    [predictor recordVisit:@"web/leaderboards/lb"];
+    STAssertNil([predictor predictedResourceAfter:@"web/scores/lb/ranks"], @"A single transition is not enough");
+
+    [predictor recordVisit:@"web/scores/lb/ranks"];
+    [predictor recordVisit:@"web/leaderboards/lb"];
+    STAssertEqualObjects(@"web/leaderboards/lb", [predictor predictedResourceAfter:@"web/scores/lb/ranks"], @"The usual path is predicted");
+
+    [predictor recordVisit:@"web/scores/lb/ranks"];
+    [predictor recordVisit:@"web/players/me"];
+    [predictor recordVisit:@"web/scores/lb/ranks"];
+    [predictor recordVisit:@"web/players/me"];
+    [predictor recordVisit:@"web/scores/lb/ranks"];
+    [predictor recordVisit:@"web/players/me"];
+    STAssertEqualObjects(@"web/players/me", [predictor predictedResourceAfter:@"web/scores/lb/ranks"], @"The most frequent path wins");
+
+    SXPreloadPredictor *reloaded = [[SXPreloadPredictor alloc] init];
+    STAssertEqualObjects(@"web/players/me", [reloaded predictedResourceAfter:@"web/scores/lb/ranks"], @"Transitions are persisted");
+}
+
+- (void)testReloadsAreNotTransitions
+{
+    SXPreloadPredictor *predictor = [SXPreloadPredictor sharedPredictor];
+    [predictor recordVisit:@"web/players/me"];
+    [predictor recordVisit:@"web/players/me"];
+    [predictor recordVisit:@"web/players/me"];
+    STAssertEquals((NSUInteger)0, predictor.transitions, @"Reloading a resource is not a transition");
+    STAssertNil([predictor predictedResourceAfter:@"web/players/me"], @"Nothing is predicted");
+}
+
+- (void)testStatistics
+{
+    SXPreloadPredictor *predictor = [SXPreloadPredictor sharedPredictor];
+    [predictor recordVisit:@"a"];
+    [predictor recordPrediction:@"b"];
+    [predictor recordVisit:@"b"];
+    [predictor recordPrediction:@"a"];
+    [predictor recordVisit:@"c"];
+    [predictor recordVisit:@"a"];
+
+    STAssertEquals((NSUInteger)2, predictor.predictions, @"Predictions are counted");
+    STAssertEquals((NSUInteger)1, predictor.hits, @"Matching predictions are hits");
+    STAssertEquals((NSUInteger)3, predictor.transitions, @"Transitions are counted");
+    STAssertEqualsWithAccuracy(0.5, predictor.precision, 0.001, @"Half of the predictions matched");
+    STAssertEqualsWithAccuracy(1.0 / 3, predictor.recall, 0.001, @"A third of the transitions were predicted");
+}
+
+- (void)testBoundedTable
+{
+    SXPreloadPredictor *predictor = [SXPreloadPredictor sharedPredictor];
+    for (int i = 0; i < PREDICTOR_MAX_SUCCESSORS + 2; i++) {
+        [predictor recordVisit:@"hub"];
+        [predictor recordVisit:[NSString stringWithFormat:@"leaf/%d", i]];
+    }
+    [predictor recordVisit:@"hub"];
+    [predictor recordVisit:@"leaf/last"];
+    [predictor recordVisit:@"hub"];
+    [predictor recordVisit:@"leaf/last"];
+    STAssertEqualObjects(@"leaf/last", [predictor predictedResourceAfter:@"hub"], @"New habits are learned in a full table");
+}
+
+@end
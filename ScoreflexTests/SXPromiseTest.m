@@ -0,0 +1,149 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXPromiseTest.h"
+#import "SXPromise.h"
+#import "SXUtil.h"
+
+@interface SXPromiseTest ()
+
+- (void) waitFor:(SXPromise *)promise timeout:(NSTimeInterval)timeout;
+
+/// A promise fulfilled with the given value after the given delay
+- (SXPromise *) promiseWithValue:(id)value after:(NSTimeInterval)delay;
+
+@end
+
+@implementation SXPromiseTest
+
+- (void) waitFor:(SXPromise *)promise timeout:(NSTimeInterval)timeout
+{
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:timeout];
+    while (promise.isPending && [deadline timeIntervalSinceNow] > 0)
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+}
+
+- (SXPromise *) promiseWithValue:(id)value after:(NSTimeInterval)delay
+{
+    SXPromise *promise = [[SXPromise alloc] init];
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_main_queue(), ^(void){
+        [promise fulfill:value];
+    });
+    return promise;
+}
+
+- (void)testSettlesOnce
+{
+    SXPromise *promise = [[SXPromise alloc] init];
+    STAssertTrue(promise.isPending, @"A new promise is pending");
+
+    [promise fulfill:@"first"];
+    [promise fulfill:@"second"];
+    [promise reject:[SXUtil errorWithScoreflexCode:SXErrorServiceException]];
+
+    STAssertTrue(promise.isFulfilled, @"The first settlement wins");
+    STAssertEqualObjects(@"first", promise.value, @"The first value is kept");
+    STAssertNil(promise.error, @"No error");
+}
+
+- (void)testThen
+{
+    SXPromise *promise = [[[[self promiseWithValue:@1 after:0.05] then:^id(NSNumber *value) {
+        return [self promiseWithValue:[NSNumber numberWithInt:value.intValue + 1] after:0.05];
+    }] then:^id(NSNumber *value) {
+        return [NSNumber numberWithInt:value.intValue * 10];
+    }] failed:^id(NSError *error) {
+        STFail(@"Nothing fails");
+        return nil;
+    }];
+
+    [self waitFor:promise timeout:2];
+    STAssertEqualObjects(@20, promise.value, @"Steps are chained, waiting for returned promises");
+
+    __block BOOL skipped = YES;
+    SXPromise *recovered = [[[SXPromise promiseWithError:[SXUtil errorWithScoreflexCode:SXErrorServiceException]] then:^id(id value) {
+        skipped = NO;
+        return value;
+    }] failed:^id(NSError *error) {
+        return @"recovered";
+    }];
+
+    [self waitFor:recovered timeout:2];
+    STAssertTrue(skipped, @"A rejection skips then:");
+    STAssertEqualObjects(@"recovered", recovered.value, @"failed: can recover");
+}
+
+- (void)testAllRunsInParallel
+{
+    NSDate *start = [NSDate date];
+    SXPromise *all = [SXPromise all:@[[self promiseWithValue:@"a" after:0.3],
+                                      [self promiseWithValue:nil after:0.1],
+                                      [self promiseWithValue:@"c" after:0.2]]];
+    [self waitFor:all timeout:2];
+
+    STAssertEqualObjects((@[@"a", [NSNull null], @"c"]), all.value, @"Values are in order");
+    STAssertTrue(-[start timeIntervalSinceNow] < 0.5, @"The promises are awaited together");
+
+    SXPromise *rejected = [SXPromise all:@[[self promiseWithValue:@"a" after:1],
+                                           [SXPromise promiseWithError:[SXUtil errorWithScoreflexCode:SXErrorServiceException]]]];
+    [self waitFor:rejected timeout:0.5];
+    STAssertEquals(SXErrorServiceException, rejected.error.code, @"The first rejection rejects all:");
+}
+
+- (void)testAny
+{
+    SXPromise *any = [SXPromise any:@[[self promiseWithValue:@"slow" after:0.3],
+                                      [SXPromise promiseWithError:[SXUtil errorWithScoreflexCode:SXErrorServiceException]],
+                                      [self promiseWithValue:@"fast" after:0.05]]];
+    [self waitFor:any timeout:2];
+    STAssertEqualObjects(@"fast", any.value, @"The first fulfilled value wins");
+
+    SXPromise *none = [SXPromise any:@[]];
+    STAssertTrue(none.isRejected, @"any: of nothing is rejected");
+}
+
+- (void)testTimeout
+{
+    SXPromise *slow = [[self promiseWithValue:@"slow" after:1] timeout:0.1];
+    [self waitFor:slow timeout:2];
+    STAssertEquals(SXErrorRequestTimedOut, slow.error.code, @"A slow promise times out");
+
+    SXPromise *fast = [[self promiseWithValue:@"fast" after:0.05] timeout:1];
+    [self waitFor:fast timeout:2];
+    STAssertEqualObjects(@"fast", fast.value, @"A fast promise does not");
+}
+
+- (void)testCancel
+{
+    SXCancellationToken *token = [[SXCancellationToken alloc] init];
+    SXPromise *promise = [[SXPromise alloc] init];
+    promise.cancellationToken = token;
+
+    [promise cancel];
+    STAssertTrue(token.isCancelled, @"Cancelling the promise cancels its work");
+    STAssertEquals((NSInteger)NSURLErrorCancelled, promise.error.code, @"The promise is rejected");
+
+    SXPromise *expired = [[SXPromise alloc] init];
+    expired.cancellationToken = [[SXCancellationToken alloc] init];
+    expired.cancellationToken.deadline = [NSDate dateWithTimeIntervalSinceNow:0.05];
+    [self waitFor:expired timeout:2];
+    STAssertEquals(SXErrorRequestTimedOut, expired.error.code, @"The deadline of the work rejects the promise");
+}
+
+@end
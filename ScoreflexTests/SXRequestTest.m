@@ -19,6 +19,12 @@
 
 #import "SXRequestTest.h"
 #import "SXRequest.h"
+#import "SXRequestCodec.h"
+#import "SXUtil.h"
+#import "SXClient.h"
+#import "AFHTTPClient.h"
+#import "Scoreflex.h"
+#import <objc/message.h>
 
 @implementation SXRequestTest
 
@@ -85,4 +91,116 @@
     request1.method = request2.method;
 
 }
+
+- (void)testCompactRecord
+{
+    SXRequest *request = [[SXRequest alloc] init];
+    request.resource = @"scores/level1";
+    request.method = @"POST";
+    request.params = @{@"score": [NSNumber numberWithLong:-42],
+                       @"ratio": [NSNumber numberWithDouble:0.5],
+                       @"meta": @{@"tags": @[@"a", @"b"]},
+                       @"name": @"\u00e9t\u00e9"};
+    request.attemptCount = 3;
+    request.enqueuedAt = 1388534400.25;
+
+    NSData *record = [SXRequestCodec dataWithRequest:request];
+    SXRequest *decoded = [SXRequestCodec requestWithData:record];
+    STAssertEqualObjects(request, decoded, @"Decoded request is equal to request");
+    STAssertEquals(request.attemptCount, decoded.attemptCount, @"Attempt count is preserved");
+    STAssertEquals(request.enqueuedAt, decoded.enqueuedAt, @"Enqueue time is preserved");
+    STAssertTrue([SXRequestCodec data:record hasRequestId:request.requestId], @"Request id is read from the record");
+    STAssertFalse([SXRequestCodec data:record hasRequestId:[SXUtil UUIDString]], @"Other request ids do not match");
+
+    request.method = nil;
+    request.resource = nil;
+    request.params = nil;
+    STAssertEqualObjects(request, [SXRequestCodec requestWithData:[SXRequestCodec dataWithRequest:request]], @"Empty requests are preserved");
+}
+
+- (void)testCompactRecordCorruption
+{
+    SXRequest *request = [[SXRequest alloc] init];
+    request.resource = @"scores/level1";
+    request.method = @"POST";
+
+    NSMutableData *record = [[SXRequestCodec dataWithRequest:request] mutableCopy];
+    ((uint8_t *)record.mutableBytes)[record.length - 1] ^= 0xFF;
+    STAssertNil([SXRequestCodec requestWithData:record], @"Corrupted records are rejected");
+
+    NSData *truncated = [[SXRequestCodec dataWithRequest:request] subdataWithRange:NSMakeRange(0, 20)];
+    STAssertNil([SXRequestCodec requestWithData:truncated], @"Truncated records are rejected");
+
+    NSData *archive = [NSKeyedArchiver archivedDataWithRootObject:request];
+    STAssertEqualObjects(request, [SXRequestCodec requestWithData:archive], @"Archived requests are still readable");
+}
+
+- (void)testCompactRecordBenchmark
+{
+    SXRequest *request = [[SXRequest alloc] init];
+    request.resource = @"scores/level1";
+    request.method = @"POST";
+    request.params = @{@"score": @"123456", @"playingTime": @"65000"};
+
+    const NSUInteger iterations = 2000;
+    NSData *archive = nil;
+    NSData *record = nil;
+
+    NSDate *start = [NSDate date];
+    for (NSUInteger i = 0; i < iterations; i++)
+        archive = [NSKeyedArchiver archivedDataWithRootObject:request];
+    NSTimeInterval archiveEncode = -[start timeIntervalSinceNow];
+
+    start = [NSDate date];
+    for (NSUInteger i = 0; i < iterations; i++)
+        [NSKeyedUnarchiver unarchiveObjectWithData:archive];
+    NSTimeInterval archiveDecode = -[start timeIntervalSinceNow];
+
+    start = [NSDate date];
+    for (NSUInteger i = 0; i < iterations; i++)
+        record = [SXRequestCodec dataWithRequest:request];
+    NSTimeInterval recordEncode = -[start timeIntervalSinceNow];
+
+    start = [NSDate date];
+    for (NSUInteger i = 0; i < iterations; i++)
+        [SXRequestCodec requestWithData:record];
+    NSTimeInterval recordDecode = -[start timeIntervalSinceNow];
+
+    NSLog(@"NSKeyedArchiver: %lu bytes, encode %.2fus, decode %.2fus", (unsigned long)archive.length, archiveEncode * 1e6 / iterations, archiveDecode * 1e6 / iterations);
+    NSLog(@"SXRequestCodec: %lu bytes, encode %.2fus, decode %.2fus", (unsigned long)record.length, recordEncode * 1e6 / iterations, recordDecode * 1e6 / iterations);
+
+    STAssertTrue(record.length < archive.length, @"Compact records are smaller than archives");
+}
+
+- (void)testQueryStringEncoding
+{
+    NSDictionary *params = @{@"b": @"x y", @"a": @[@1, @2], @"c": @{@"d": @"é&"}, @"e": [NSNull null]};
+    STAssertEqualObjects(@"a[]=1&a[]=2&b=x%20y&c[d]=%C3%A9%26&e", AFQueryStringFromParametersWithEncoding(params, NSUTF8StringEncoding), @"Query string is flattened and escaped");
+    STAssertEqualObjects(@"%C3%A9[]=1&%C3%A9[]=2&%C3%A9[]=3", AFQueryStringFromParametersWithEncoding(@{@"é": @[@1, @2, @3]}, NSUTF8StringEncoding), @"Array elements share their field");
+
+    NSMutableData *buffer = [NSMutableData data];
+    NSRange canonicalRange;
+    NSRange queryRange = AFAppendQueryStringFromParameters(buffer, @{@"b": @"2", @"B": @"1", @"a": @[@"x", @"y"]}, NSUTF8StringEncoding, &canonicalRange);
+    NSString *canonical = [[NSString alloc] initWithData:[buffer subdataWithRange:canonicalRange] encoding:NSASCIIStringEncoding];
+    STAssertEquals(0, (int)queryRange.location, @"Query string comes first");
+    STAssertEqualObjects(@"B%3D1%26a%255B%255D%3Dy%26b%3D2", canonical, @"Canonical form is sorted, deduplicated and escaped twice");
+}
+
+- (void)testSignatureFromCanonicalParameters
+{
+    [Scoreflex setClientId:@"clientId" secret:@"secret" sandboxMode:YES];
+    AFHTTPClient *httpClient = [SXClient sharedClient].httpClient;
+    Class operationClass = NSClassFromString(@"SXJSONRequestOperation");
+
+    NSDictionary *params = @{@"score": @"123", @"meta": @"café crème ✓", @"list": @[@"x", @"y"], @"empty": [NSNull null], @"Upper": @"1"};
+    for (NSString *method in @[@"POST", @"DELETE"]) {
+        NSMutableURLRequest *request = [httpClient requestWithMethod:method path:@"scores/level1" parameters:params];
+        NSString *signature = [request valueForHTTPHeaderField:@"X-Scoreflex-Authorization"];
+        STAssertNotNil(signature, @"Requests with params are signed when built");
+
+        // The signature computed from the URL request must be the same
+        NSString *expected = objc_msgSend(operationClass, @selector(scoreflexAuthorizationHeaderValueForRequest:), request);
+        STAssertEqualObjects(expected, signature, @"%@ signature matches", method);
+    }
+}
 @end
@@ -20,6 +20,7 @@
 #import "SXRequestVaultTest.h"
 #import "SXRequestVault.h"
 #import "Scoreflex.h"
+#import "SXPromise.h"
 #import <objc/message.h>
 
 @implementation SXRequestVaultTest
@@ -63,5 +64,34 @@
     STAssertEqualObjects(request1, [objc_msgSend(vault, @selector(savedRequests)) lastObject], @"request1 is the only saved request");
     STAssertEquals(1, (int)[objc_msgSend(vault, @selector(savedRequests)) count], @"Vault has 1 request1");
 
+    // Update the attempt count of the first request
+    request1.attemptCount = 2;
+    objc_msgSend(vault, @selector(update:), request1);
+    STAssertEquals((NSUInteger)2, ((SXRequest *)[objc_msgSend(vault, @selector(savedRequests)) lastObject]).attemptCount, @"The attempt count is saved");
+    STAssertEquals(1, (int)[objc_msgSend(vault, @selector(savedRequests)) count], @"The record is updated in place");
+}
+
+- (void)testSavedRequestsLoad
+{
+    [Scoreflex setClientId:@"" secret:@"" sandboxMode:YES];
+
+    SXRequestVault *vault = [[SXRequestVault alloc] initWithClient:[SXClient sharedClient]];
+    [vault reset];
+
+    SXPromise *load = [SXRequestVault loadSavedRequests];
+    STAssertEquals(load, [SXRequestVault loadSavedRequests], @"The load is shared");
+
+    SXRequest *request = [[SXRequest alloc] init];
+    request.method = @"POST";
+    request.resource = @"/foo";
+    objc_msgSend(vault, @selector(save:), request);
+    STAssertTrue(load != [SXRequestVault loadSavedRequests], @"A load is not shared once the saved requests change");
+
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:5];
+    while (load.isPending && [deadline timeIntervalSinceNow] > 0)
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    STAssertEquals((NSUInteger)0, [load.value count], @"A load only holds the requests saved before it started");
+
+    [vault reset];
 }
 @end
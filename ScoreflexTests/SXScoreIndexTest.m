@@ -0,0 +1,83 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXScoreIndexTest.h"
+#import "SXScoreIndex.h"
+
+@implementation SXScoreIndexTest
+
+- (void)testBestScore
+{
+    SXScoreIndex *index = [SXScoreIndex sharedIndex];
+    [index reset];
+
+    STAssertNil([index bestScoreForPlayer:@"player" leaderboard:@"level1"], @"No best score yet");
+    STAssertTrue([index recordScore:100 player:@"player" leaderboard:@"level1"], @"First score improves");
+    STAssertFalse([index recordScore:50 player:@"player" leaderboard:@"level1"], @"Lower score does not improve");
+    STAssertFalse([index recordScore:100 player:@"player" leaderboard:@"level1"], @"Same score does not improve");
+    STAssertTrue([index recordScore:150 player:@"player" leaderboard:@"level1"], @"Higher score improves");
+    STAssertEqualObjects([index bestScoreForPlayer:@"player" leaderboard:@"level1"], [NSNumber numberWithLongLong:150], @"Best score is kept");
+    STAssertEquals(4, (int)[index recentScoresForPlayer:@"player" leaderboard:@"level1"].count, @"Recent scores are kept");
+
+    STAssertNil([index bestScoreForPlayer:@"other" leaderboard:@"level1"], @"Scores are per player");
+
+    // Ascending leaderboard, lower is better
+    [index setOrder:SXScoreOrderAscending forLeaderboard:@"race"];
+    STAssertTrue([index recordScore:60 player:@"player" leaderboard:@"race"], @"First time improves");
+    STAssertFalse([index recordScore:70 player:@"player" leaderboard:@"race"], @"Slower time does not improve");
+    STAssertTrue([index recordScore:55 player:@"player" leaderboard:@"race"], @"Faster time improves");
+
+    // Checking a score does not record it
+    STAssertTrue([index isImprovingScore:200 player:@"player" leaderboard:@"level1"], @"Higher score would improve");
+    STAssertFalse([index isImprovingScore:150 player:@"player" leaderboard:@"level1"], @"Same score would not improve");
+    STAssertEqualObjects([index bestScoreForPlayer:@"player" leaderboard:@"level1"], [NSNumber numberWithLongLong:150], @"Checked scores are not recorded");
+}
+
+- (void)testOrderPersistence
+{
+    SXScoreIndex *index = [SXScoreIndex sharedIndex];
+    [index reset];
+
+    [index setOrder:SXScoreOrderAscending forLeaderboard:@"race"];
+    SXScoreIndex *reloaded = [[SXScoreIndex alloc] init];
+    STAssertEquals(SXScoreOrderAscending, [reloaded orderForLeaderboard:@"race"], @"Sort orders are persisted");
+    STAssertEquals(SXScoreOrderDescending, [reloaded orderForLeaderboard:@"level1"], @"Leaderboards are descending by default");
+
+    [index reset];
+    reloaded = [[SXScoreIndex alloc] init];
+    STAssertEquals(SXScoreOrderDescending, [reloaded orderForLeaderboard:@"race"], @"Sort orders are reset");
+}
+
+- (void)testDeferredRequests
+{
+    SXScoreIndex *index = [SXScoreIndex sharedIndex];
+    [index reset];
+
+    SXRequest *request = [[SXRequest alloc] init];
+    request.method = @"POST";
+    request.resource = @"/scores/level1";
+    request.params = @{@"score": @"10"};
+
+    STAssertEquals(1, (int)[index deferRequest:request], @"One deferred request");
+    NSArray *drained = [index drainDeferredRequests];
+    STAssertEqualObjects(request, [drained lastObject], @"Deferred request is preserved");
+    STAssertEqualObjects(@{@"score": @"10"}, [[drained lastObject] rawParams], @"Parameters are saved without decorations");
+    STAssertEquals(0, (int)[index drainDeferredRequests].count, @"Deferred requests are drained once");
+}
+@end
@@ -0,0 +1,37 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import <SenTestingKit/SenTestingKit.h>
+
+/**
+ Drives `SXClient` and `SXRequestVault` against `SXStandInServer` at a steady rate, and reports throughput,
+ latency percentiles and memory growth.
+
+ The run is configured with environment variables:
+
+ - `SX_SOAK_DURATION`: seconds, defaults to 10
+ - `SX_SOAK_QPS`: requests per second, defaults to 20
+ - `SX_SOAK_LATENCY`: server latency in seconds, defaults to 0.05
+ - `SX_SOAK_ERROR_RATE`: fraction of service exceptions, defaults to 0.01
+ - `SX_SOAK_TOKEN_EXPIRY_RATE`: fraction of requests expiring the access token, defaults to 0.002
+ - `SX_SOAK_REPORT_INTERVAL`: seconds between intermediate reports, defaults to 60
+ */
+@interface SXSoakTest : SenTestCase
+
+@end
@@ -0,0 +1,148 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXSoakTest.h"
+#import "SXStandInServer.h"
+#import "SXClient.h"
+#import "SXConfiguration.h"
+#import "SXRequestVault.h"
+#import "SXMetrics.h"
+#import "Scoreflex.h"
+#import <mach/mach.h>
+
+@interface SXSoakTest ()
+
+- (double) doubleFromEnvironment:(NSString *)name defaultValue:(double)defaultValue;
+
+- (NSUInteger) residentMemory;
+
+- (void) report:(NSString *)title completed:(NSUInteger)completed errors:(NSUInteger)errors elapsed:(NSTimeInterval)elapsed latencies:(SXLatencyHistogram *)latencies memory:(NSUInteger)memory;
+
+@end
+
+@implementation SXSoakTest
+
+- (double) doubleFromEnvironment:(NSString *)name defaultValue:(double)defaultValue
+{
+    NSString *value = [[[NSProcessInfo processInfo] environment] objectForKey:name];
+    return value ? value.doubleValue : defaultValue;
+}
+
+- (NSUInteger) residentMemory
+{
+    struct mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS)
+        return 0;
+    return (NSUInteger)info.resident_size;
+}
+
+- (void) report:(NSString *)title completed:(NSUInteger)completed errors:(NSUInteger)errors elapsed:(NSTimeInterval)elapsed latencies:(SXLatencyHistogram *)latencies memory:(NSUInteger)memory
+{
+    NSLog(@"SOAK %@: %lu requests, %lu errors, %.1f req/s, p50 %.1fms p95 %.1fms p99 %.1fms, memory %+.1fMB",
+          title, (unsigned long)completed, (unsigned long)errors, completed / elapsed,
+          [latencies valueAtPercentile:50] * 1000, [latencies valueAtPercentile:95] * 1000, [latencies valueAtPercentile:99] * 1000,
+          ((double)[self residentMemory] - memory) / (1024 * 1024));
+}
+
+- (void)testSoak
+{
+    NSTimeInterval duration = [self doubleFromEnvironment:@"SX_SOAK_DURATION" defaultValue:10];
+    double qps = [self doubleFromEnvironment:@"SX_SOAK_QPS" defaultValue:20];
+    NSTimeInterval reportInterval = [self doubleFromEnvironment:@"SX_SOAK_REPORT_INTERVAL" defaultValue:60];
+
+    [SXStandInServer reset];
+    [SXStandInServer setLatency:[self doubleFromEnvironment:@"SX_SOAK_LATENCY" defaultValue:0.05] jitter:0.05];
+    [SXStandInServer setErrorRate:[self doubleFromEnvironment:@"SX_SOAK_ERROR_RATE" defaultValue:0.01]];
+    [SXStandInServer setTokenExpiryRate:[self doubleFromEnvironment:@"SX_SOAK_TOKEN_EXPIRY_RATE" defaultValue:0.002]];
+    [SXStandInServer start];
+
+    [Scoreflex setClientId:@"soak" secret:@"soak" sandboxMode:YES];
+    [[SXConfiguration sharedConfiguration] setAccessToken:nil anonymous:YES];
+    SXClient *client = [SXClient sharedClient];
+
+    SXLatencyHistogram *latencies = [[SXLatencyHistogram alloc] init];
+    __block NSUInteger completed = 0;
+    __block NSUInteger errors = 0;
+    NSUInteger issued = 0;
+
+    NSUInteger memory = [self residentMemory];
+    NSTimeInterval start = SXMetricsTimestamp();
+    NSTimeInterval lastReport = start;
+
+    while (SXMetricsTimestamp() - start < duration) {
+
+        // Issue the requests due at this point of the run
+        while (issued < (SXMetricsTimestamp() - start) * qps) {
+            NSTimeInterval issuedAt = SXMetricsTimestamp();
+            SXRequestHandler handler = ^(SXResponse *response, NSError *error) {
+                [latencies addSample:SXMetricsTimestamp() - issuedAt];
+                completed++;
+                if (error)
+                    errors++;
+            };
+
+            SXRequest *request = [[SXRequest alloc] init];
+            request.handler = handler;
+            switch (issued % 5) {
+                case 0:
+                    request.method = @"GET";
+                    request.resource = @"network/ping";
+                    [client requestAuthenticated:request];
+                    break;
+                case 1:
+                    request.method = @"POST";
+                    request.resource = @"notifications/track";
+                    request.params = @{@"notificationId": [NSString stringWithFormat:@"%lu", (unsigned long)issued]};
+                    [client requestEventually:request];
+                    break;
+                default:
+                    request.method = @"POST";
+                    request.resource = @"scores/level1";
+                    request.params = @{@"score": [NSString stringWithFormat:@"%lu", (unsigned long)issued]};
+                    [client requestEventually:request];
+                    break;
+            }
+            issued++;
+        }
+
+        // Handlers run on the main queue
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+
+        if (SXMetricsTimestamp() - lastReport >= reportInterval) {
+            lastReport = SXMetricsTimestamp();
+            [self report:@"progress" completed:completed errors:errors elapsed:lastReport - start latencies:latencies memory:memory];
+        }
+    }
+
+    // Wait for requests retried after an expired token
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:RETRY_INTERVAL * 3];
+    while (completed < issued && [deadline timeIntervalSinceNow] > 0)
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+
+    [self report:@"total" completed:completed errors:errors elapsed:SXMetricsTimestamp() - start latencies:latencies memory:memory];
+    NSLog(@"SOAK server requests: %@", [SXStandInServer requestCounts]);
+
+    [SXStandInServer stop];
+
+    STAssertEquals(issued, completed, @"Every request completed");
+    STAssertTrue([SXStandInServer requestCount] >= issued, @"Every request reached the server");
+}
+
+@end
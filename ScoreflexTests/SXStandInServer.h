@@ -0,0 +1,89 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ SXStandInServer answers Scoreflex API requests locally, without a network connection.
+
+ It is an `NSURLProtocol` that intercepts requests to the sandbox and production API hosts once started,
+ and implements:
+
+ - `oauth/anonymousAccessToken`, which issues a new access token and sid
+ - `network/ping`
+ - `scores/*`
+ - `notifications/track`
+
+ Requests signed with an unknown access token, and unknown resources, are answered with the error JSON
+ understood by `+[SXUtil errorFromJSON:]`. Latency, service errors and token expirations can be injected.
+ */
+@interface SXStandInServer : NSURLProtocol
+
+/**
+ Starts intercepting API requests
+ */
++ (void) start;
+
+/**
+ Stops intercepting API requests
+ */
++ (void) stop;
+
+/**
+ Clears the counters and injected faults, and revokes every issued token.
+ */
++ (void) reset;
+
+///---------------------
+/// @name Fault injection
+///---------------------
+
+/**
+ Sets the delay before each response is sent. Defaults to 0.
+ @param latency The minimum latency, in seconds
+ @param jitter A random delay of up to `jitter` seconds added to each response
+ */
++ (void) setLatency:(NSTimeInterval)latency jitter:(NSTimeInterval)jitter;
+
+/**
+ Sets the fraction of requests, between 0 and 1, answered with an HTTP 500 and a service exception.
+ */
++ (void) setErrorRate:(double)errorRate;
+
+/**
+ Sets the fraction of authenticated requests, between 0 and 1, after which the current access token
+ expires. The request is answered with an invalid access token error.
+ */
++ (void) setTokenExpiryRate:(double)tokenExpiryRate;
+
+///---------------------
+/// @name Counters
+///---------------------
+
+/**
+ The number of requests answered, per resource
+ */
++ (NSDictionary *) requestCounts;
+
+/**
+ The total number of requests answered
+ */
++ (NSUInteger) requestCount;
+
+@end
@@ -0,0 +1,237 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXStandInServer.h"
+#import "SXUtil.h"
+
+static BOOL SXStandInStarted = NO;
+static NSTimeInterval SXStandInLatency = 0;
+static NSTimeInterval SXStandInJitter = 0;
+static double SXStandInErrorRate = 0;
+static double SXStandInTokenExpiryRate = 0;
+static NSMutableSet *SXStandInTokens = nil;
+static NSMutableDictionary *SXStandInRequestCounts = nil;
+
+@interface SXStandInServer ()
+
++ (NSString *) resourceForURL:(NSURL *)URL;
+
++ (BOOL) randomEvent:(double)rate;
+
+- (void) respondWithStatus:(NSInteger)status json:(id)json;
+
+- (void) respond;
+
+@end
+
+@implementation SXStandInServer
+
++ (void) initialize
+{
+    if (self == [SXStandInServer class]) {
+        SXStandInTokens = [[NSMutableSet alloc] init];
+        SXStandInRequestCounts = [[NSMutableDictionary alloc] init];
+    }
+}
+
++ (void) start
+{
+    @synchronized(self) {
+        if (SXStandInStarted)
+            return;
+        SXStandInStarted = YES;
+    }
+    [NSURLProtocol registerClass:self];
+}
+
++ (void) stop
+{
+    [NSURLProtocol unregisterClass:self];
+    @synchronized(self) {
+        SXStandInStarted = NO;
+    }
+}
+
++ (void) reset
+{
+    @synchronized(self) {
+        SXStandInLatency = 0;
+        SXStandInJitter = 0;
+        SXStandInErrorRate = 0;
+        SXStandInTokenExpiryRate = 0;
+        [SXStandInTokens removeAllObjects];
+        [SXStandInRequestCounts removeAllObjects];
+    }
+}
+
+#pragma mark - Fault injection
+
++ (void) setLatency:(NSTimeInterval)latency jitter:(NSTimeInterval)jitter
+{
+    @synchronized(self) {
+        SXStandInLatency = latency;
+        SXStandInJitter = jitter;
+    }
+}
+
++ (void) setErrorRate:(double)errorRate
+{
+    @synchronized(self) {
+        SXStandInErrorRate = errorRate;
+    }
+}
+
++ (void) setTokenExpiryRate:(double)tokenExpiryRate
+{
+    @synchronized(self) {
+        SXStandInTokenExpiryRate = tokenExpiryRate;
+    }
+}
+
++ (BOOL) randomEvent:(double)rate
+{
+    return rate > 0 && arc4random_uniform(1000000) < rate * 1000000;
+}
+
+#pragma mark - Counters
+
++ (NSDictionary *) requestCounts
+{
+    @synchronized(self) {
+        return [NSDictionary dictionaryWithDictionary:SXStandInRequestCounts];
+    }
+}
+
++ (NSUInteger) requestCount
+{
+    NSUInteger count = 0;
+    for (NSNumber *resourceCount in [self requestCounts].allValues)
+        count += resourceCount.unsignedIntegerValue;
+    return count;
+}
+
+#pragma mark - NSURLProtocol
+
++ (BOOL) canInitWithRequest:(NSURLRequest *)request
+{
+    return [self resourceForURL:request.URL] != nil;
+}
+
++ (NSURLRequest *) canonicalRequestForRequest:(NSURLRequest *)request
+{
+    return request;
+}
+
++ (NSString *) resourceForURL:(NSURL *)URL
+{
+    for (NSString *base in @[SANDBOX_API_URL, PRODUCTION_API_URL]) {
+        NSURL *baseURL = [NSURL URLWithString:base];
+        NSString *basePath = [baseURL.path stringByAppendingString:@"/"];
+        if ([URL.host isEqualToString:baseURL.host] && [URL.path hasPrefix:basePath])
+            return [URL.path substringFromIndex:basePath.length];
+    }
+    return nil;
+}
+
+- (void) startLoading
+{
+    NSTimeInterval delay;
+    @synchronized([self class]) {
+        delay = SXStandInLatency + SXStandInJitter * arc4random_uniform(1000) / 1000.;
+    }
+
+    // Respond on the loading thread, which runs a run loop
+    if (delay > 0)
+        [self performSelector:@selector(respond) withObject:nil afterDelay:delay];
+    else
+        [self respond];
+}
+
+- (void) stopLoading
+{
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(respond) object:nil];
+}
+
+#pragma mark - Routes
+
+- (void) respond
+{
+    NSString *resource = [[self class] resourceForURL:self.request.URL];
+
+    NSMutableDictionary *params = [NSMutableDictionary dictionaryWithDictionary:[SXUtil dictionaryWithFormEncodedString:self.request.URL.query]];
+    if (self.request.HTTPBody)
+        [params addEntriesFromDictionary:[SXUtil dictionaryWithFormEncodedString:[[NSString alloc] initWithData:self.request.HTTPBody encoding:NSUTF8StringEncoding]]];
+
+    @synchronized([self class]) {
+        NSNumber *count = [SXStandInRequestCounts objectForKey:resource];
+        [SXStandInRequestCounts setObject:[NSNumber numberWithUnsignedInteger:count.unsignedIntegerValue + 1] forKey:resource];
+    }
+
+    if ([[self class] randomEvent:SXStandInErrorRate]) {
+        [self respondWithStatus:500 json:@{@"error": @{@"code": [NSNumber numberWithInteger:SXErrorServiceException], @"message": @"Injected service exception"}}];
+        return;
+    }
+
+    if ([@"oauth/anonymousAccessToken" isEqualToString:resource]) {
+        NSString *token = [SXUtil UUIDString];
+        @synchronized([self class]) {
+            [SXStandInTokens addObject:token];
+        }
+        [self respondWithStatus:200 json:@{@"accessToken": @{@"token": token},
+                                           @"sid": [SXUtil UUIDString],
+                                           @"me": @{@"id": [NSString stringWithFormat:@"standin-%@", [params objectForKey:@"deviceId"]]}}];
+        return;
+    }
+
+    // Every other resource needs a valid access token
+    NSString *token = [params objectForKey:@"accessToken"];
+    BOOL valid;
+    @synchronized([self class]) {
+        valid = token && [SXStandInTokens containsObject:token];
+        if (valid && [[self class] randomEvent:SXStandInTokenExpiryRate]) {
+            [SXStandInTokens removeObject:token];
+            valid = NO;
+        }
+    }
+    if (!valid) {
+        [self respondWithStatus:401 json:@{@"error": @{@"code": [NSNumber numberWithInteger:SXErrorInvalidAccessToken], @"message": @"Invalid access token"}}];
+        return;
+    }
+
+    if ([@"network/ping" isEqualToString:resource] || [@"notifications/track" isEqualToString:resource]) {
+        [self respondWithStatus:200 json:@{}];
+    } else if ([resource hasPrefix:@"scores/"]) {
+        id score = [params objectForKey:@"score"];
+        [self respondWithStatus:200 json:@{@"score": score ? score : [NSNull null]}];
+    } else {
+        [self respondWithStatus:404 json:@{@"error": @{@"code": [NSNumber numberWithInteger:SXErrorInvalidParameter], @"message": [NSString stringWithFormat:@"Unknown resource %@", resource]}}];
+    }
+}
+
+- (void) respondWithStatus:(NSInteger)status json:(id)json
+{
+    NSData *body = [NSJSONSerialization dataWithJSONObject:json options:0 error:nil];
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:self.request.URL statusCode:status HTTPVersion:@"HTTP/1.1" headerFields:@{@"Content-Type": @"application/json",
+                                                                                                                                                    @"Content-Length": [NSString stringWithFormat:@"%lu", (unsigned long)body.length]}];
+    [self.client URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+    [self.client URLProtocol:self didLoadData:body];
+    [self.client URLProtocolDidFinishLoading:self];
+}
+
+@end
@@ -19,6 +19,8 @@
 
 #import "SXUtilTest.h"
 #import "SXConfiguration.h"
+#import "SXUtil.h"
+#import "SXPromise.h"
 
 @implementation SXUtilTest
 
@@ -51,6 +53,36 @@
     STAssertEqualObjects([SXUtil resourceForScoreflexURL:URL], @"foo/bar", @"Resource is right");
     STAssertEqualObjects([SXUtil paramsForScoreflexURL:URL], @{@"toto" : @"titi"}, @"Params are right");
 
+    // Hosts are case insensitive, fragments are not part of the resource
+    URL = [NSURL URLWithString:@"http://WWW.scoreflex.com/v1/web/callback#start"];
+    STAssertEqualObjects([SXUtil resourceForScoreflexURL:URL], @"web/callback", @"Resource is right");
 
+    // The whole base path must match
+    URL = [NSURL URLWithString:@"http://www.scoreflex.com/v2/foo/bar"];
+    STAssertFalse([SXUtil isScoreflexURL:URL], @"URL is not scoreflex");
+    URL = [NSURL URLWithString:@"http://www.scoreflex.com:8080/v1/foo/bar"];
+    STAssertFalse([SXUtil isScoreflexURL:URL], @"URL is not scoreflex");
+
+    // The matcher follows base URL changes
+    configuration.baseURL = [NSURL URLWithString:@"https://sandbox.scoreflex.com/v1/"];
+    URL = [NSURL URLWithString:@"http://sandbox.scoreflex.com/v1/foo/bar"];
+    STAssertEqualObjects([SXUtil resourceForScoreflexURL:URL], @"foo/bar", @"Resource is right");
+    URL = [NSURL URLWithString:@"http://www.scoreflex.com/v1/foo/bar"];
+    STAssertFalse([SXUtil isScoreflexURL:URL], @"URL is not scoreflex anymore");
+}
+
+- (void) testDeviceIdentifier
+{
+    SXPromise *promise = [SXUtil deviceIdentifierPromise];
+    STAssertEquals(promise, [SXUtil deviceIdentifierPromise], @"The identifier is computed once");
+
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:5];
+    while (promise.isPending && [deadline timeIntervalSinceNow] > 0)
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+
+    STAssertTrue(promise.isFulfilled, @"The identifier is computed in the background");
+    STAssertTrue([promise.value length] > 0, @"The identifier is not empty");
+    STAssertEqualObjects(promise.value, [SXUtil deviceIdentifier], @"The accessor returns the cached identifier");
+    STAssertEqualObjects(promise.value, [[NSUserDefaults standardUserDefaults] stringForKey:USER_DEFAULTS_DEVICE_IDENTIFIER_KEY], @"The identifier is persisted");
 }
 @end
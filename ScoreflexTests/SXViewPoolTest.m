@@ -0,0 +1,98 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXViewPoolTest.h"
+#import "SXViewPool.h"
+#import "SXView_private.h"
+
+@implementation SXViewPoolTest
+
+- (void)testRecycling
+{
+    SXViewPool *pool = [[SXViewPool alloc] init];
+    pool.maxCount = 2;
+
+    SXView *view = [pool dequeueView];
+    STAssertNotNil(view, @"An empty pool creates views");
+    STAssertTrue(view.reloadsOnLogin, @"Vended views follow login changes");
+
+    UIView *superview = [[UIView alloc] initWithFrame:CGRectMake(0, 0, 320, 480)];
+    [superview addSubview:view];
+    STAssertFalse([pool recycleView:view], @"Attached views are not recycled");
+
+    [view removeFromSuperview];
+    STAssertTrue([pool recycleView:view], @"Detached views are recycled");
+    STAssertFalse(view.reloadsOnLogin, @"Idle views ignore login changes");
+    STAssertEquals((NSUInteger)1, pool.count, @"The view is idle");
+    STAssertFalse([pool recycleView:view], @"A view is only pooled once");
+
+    SXView *next = [pool dequeueView];
+    STAssertTrue(next != view, @"Each dequeue vends a new view");
+    STAssertEquals((NSUInteger)0, pool.count, @"The idle web view is reused");
+}
+
+- (void)testClosedViewsDoNotAffectOtherPanels
+{
+    SXViewPool *pool = [[SXViewPool alloc] init];
+    UIView *superview = [[UIView alloc] initWithFrame:CGRectMake(0, 0, 320, 480)];
+
+    SXView *closed = [pool dequeueView];
+    NSUInteger generation = closed.reuseGeneration;
+    STAssertTrue([pool recycleView:closed], @"The web view is recycled");
+    STAssertTrue(closed.reuseGeneration != generation, @"Recycling is visible to deferred work on the view");
+
+    SXView *shown = [pool dequeueView];
+    [superview addSubview:shown];
+
+    // The game still holds the closed view
+    [closed close];
+    [closed removeFromSuperview];
+    closed.frame = CGRectMake(0, 0, 10, 10);
+    STAssertEquals(superview, shown.superview, @"The shown panel stays attached");
+    STAssertEquals((NSUInteger)0, closed.subviews.count, @"The closed view has no web view");
+    STAssertEquals((NSUInteger)0, pool.count, @"A closed view is only recycled once");
+}
+
+- (void)testForeignViewsAreNotRecycled
+{
+    SXViewPool *pool = [[SXViewPool alloc] init];
+    SXView *view = [[SXView alloc] initWithFrame:CGRectZero];
+    STAssertFalse([pool recycleView:view], @"Views created by the game are left alone");
+    STAssertEquals((NSUInteger)0, pool.count, @"Nothing is pooled");
+}
+
+- (void)testWarmUpAndBudget
+{
+    SXViewPool *pool = [[SXViewPool alloc] init];
+    pool.maxCount = 2;
+
+    [pool warmUp:5];
+    STAssertEquals((NSUInteger)2, pool.count, @"Warming up is capped by the budget");
+
+    SXView *extra = [[[SXViewPool alloc] init] dequeueView];
+    STAssertFalse([pool recycleView:extra], @"A full pool doesn't take more views");
+
+    pool.maxCount = 1;
+    STAssertEquals((NSUInteger)1, pool.count, @"Lowering the budget drops idle views");
+
+    [[NSNotificationCenter defaultCenter] postNotificationName:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+    STAssertEquals((NSUInteger)0, pool.count, @"Memory warnings drop idle views");
+}
+
+@end
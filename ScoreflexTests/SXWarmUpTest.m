@@ -0,0 +1,92 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXWarmUpTest.h"
+#import "SXWarmUp.h"
+#import "SXPromise.h"
+#import "SXMetrics.h"
+#import "SXConfiguration.h"
+#import "SXStandInServer.h"
+#import "Scoreflex.h"
+
+@implementation SXWarmUpTest
+
+- (void) setUp
+{
+    [super setUp];
+    [SXStandInServer reset];
+    [SXStandInServer start];
+
+    // Cold start: the SDK has to fetch an anonymous access token before being initialized
+    [[SXConfiguration sharedConfiguration] setAccessToken:nil anonymous:YES];
+}
+
+- (void) tearDown
+{
+    [SXStandInServer stop];
+    [super tearDown];
+}
+
+- (void) testStartupTimeline
+{
+    __block BOOL initialized = NO;
+    id observer = [[NSNotificationCenter defaultCenter] addObserverForName:SX_NOTIFICATION_INITIALIZED object:nil queue:nil usingBlock:^(NSNotification *note) {
+        initialized = YES;
+    }];
+
+    NSTimeInterval start = SXMetricsTimestamp();
+    [Scoreflex setClientId:@"client" secret:@"client" sandboxMode:YES];
+    NSTimeInterval setClientIdDuration = SXMetricsTimestamp() - start;
+
+    SXWarmUp *warmUp = [SXWarmUp sharedWarmUp];
+    NSArray *steps = @[SXWarmUpStepPreconnect, SXWarmUpStepDeviceIdentifier, SXWarmUpStepRequestVault];
+    BOOL (^finished)(void) = ^BOOL{
+        NSDictionary *timeline = [warmUp timeline];
+        for (NSString *step in steps) {
+            if (![[timeline objectForKey:step] objectForKey:@"end"])
+                return NO;
+        }
+        return initialized;
+    };
+
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:10];
+    while (!finished() && [deadline timeIntervalSinceNow] > 0)
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    [[NSNotificationCenter defaultCenter] removeObserver:observer];
+
+    NSLog(@"setClientId: took %.2fms, startup timeline:\n%@", setClientIdDuration * 1000, [warmUp timelineDescription]);
+
+    STAssertTrue(initialized, @"The SDK is initialized against the stand-in server");
+    STAssertTrue(finished(), @"Every warm-up step ends");
+    STAssertTrue(warmUp.timeToInitialized >= 0, @"The time to initialization is measured");
+    STAssertTrue(warmUp.timeToInitialized < 5, @"The SDK is initialized quickly against a local server");
+    STAssertNotNil([SXConfiguration sharedConfiguration].sid, @"A session was opened");
+
+    NSDictionary *timeline = [warmUp timeline];
+    for (NSString *step in steps) {
+        NSDictionary *entry = [timeline objectForKey:step];
+        STAssertTrue([[entry objectForKey:@"end"] doubleValue] >= [[entry objectForKey:@"begin"] doubleValue], @"%@ ends after it begins", step);
+    }
+
+    NSDictionary *startup = [[[SXMetrics sharedMetrics] snapshot] objectForKey:@"startup"];
+    STAssertNotNil([startup objectForKey:SXWarmUpMilestoneInitialized], @"The time to initialization is recorded in the metrics");
+    STAssertEqualsWithAccuracy(warmUp.timeToInitialized * 1000, [[startup objectForKey:SXWarmUpMilestoneInitialized] doubleValue], 0.001, @"The metrics match the timeline");
+}
+
+@end
@@ -0,0 +1,128 @@
+/*
+ * Licensed to Scoreflex (www.scoreflex.com) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership. Scoreflex licenses this
+ * file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#import "SXWebCacheTest.h"
+#import "SXWebCache.h"
+
+@interface SXWebCacheTest ()
+
+@property (strong, nonatomic) SXWebCache *cache;
+
+- (NSHTTPURLResponse *) responseForURLString:(NSString *)URLString;
+
+@end
+
+@implementation SXWebCacheTest
+
+- (void)setUp
+{
+    [super setUp];
+    NSString *directory = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSProcessInfo processInfo] globallyUniqueString]];
+    self.cache = [[SXWebCache alloc] initWithDirectory:directory];
+}
+
+- (void)tearDown
+{
+    [[NSFileManager defaultManager] removeItemAtPath:self.cache.directory error:nil];
+    self.cache = nil;
+    [super tearDown];
+}
+
+- (NSHTTPURLResponse *) responseForURLString:(NSString *)URLString
+{
+    return [[NSHTTPURLResponse alloc] initWithURL:[NSURL URLWithString:URLString]
+                                       statusCode:200
+                                      HTTPVersion:@"HTTP/1.1"
+                                     headerFields:@{@"Content-Type": @"text/css", @"Content-Encoding": @"gzip"}];
+}
+
+- (void)testKeys
+{
+    STAssertEqualObjects(@"http://api.scoreflex.com/v1/web/scores?lang=en",
+                         [SXWebCache keyForURL:[NSURL URLWithString:@"http://api.scoreflex.com/v1/web/scores?lang=en&location=1.0,2.0#start"]],
+                         @"Fragments and locations are not part of the key");
+    STAssertEqualObjects(@"http://cdn.scoreflex.com/a.css",
+                         [SXWebCache keyForURL:[NSURL URLWithString:@"http://cdn.scoreflex.com/a.css?location=1.0,2.0"]],
+                         @"Queries made only of volatile parameters are dropped");
+}
+
+- (void)testStoreAndServe
+{
+    NSData *data = [@"body { color: red; }" dataUsingEncoding:NSUTF8StringEncoding];
+    [self.cache storeResponse:[self responseForURLString:@"http://cdn.scoreflex.com/a.css"] data:data shell:NO];
+
+    NSCachedURLResponse *cached = [self.cache cachedResponseForURL:[NSURL URLWithString:@"http://cdn.scoreflex.com/a.css#x"]];
+    STAssertEqualObjects(data, cached.data, @"The body is served");
+    NSHTTPURLResponse *response = (NSHTTPURLResponse *)cached.response;
+    STAssertEquals((NSInteger)200, response.statusCode, @"The status is kept");
+    STAssertEqualObjects(@"text/css", [response.allHeaderFields objectForKey:@"Content-Type"], @"The headers are kept");
+    STAssertNil([response.allHeaderFields objectForKey:@"Content-Encoding"], @"The body is stored decoded");
+    STAssertNotNil([self.cache validationDateForURL:response.URL], @"Stored entries are fresh");
+
+    [self.cache flush];
+    SXWebCache *reopened = [[SXWebCache alloc] initWithDirectory:self.cache.directory];
+    STAssertEqualObjects(data, [reopened cachedResponseForURL:response.URL].data, @"The store is persisted");
+}
+
+- (void)testContentAddressing
+{
+    NSData *data = [@"shared" dataUsingEncoding:NSUTF8StringEncoding];
+    [self.cache storeResponse:[self responseForURLString:@"http://cdn.scoreflex.com/a.css"] data:data shell:NO];
+    [self.cache storeResponse:[self responseForURLString:@"http://cdn.scoreflex.com/b.css"] data:data shell:NO];
+    STAssertEquals((NSUInteger)data.length, self.cache.size, @"Identical bodies are stored once");
+
+    [self.cache storeResponse:[self responseForURLString:@"http://cdn.scoreflex.com/a.css"] data:[@"changed" dataUsingEncoding:NSUTF8StringEncoding] shell:NO];
+    STAssertEqualObjects(data, [self.cache cachedResponseForURL:[NSURL URLWithString:@"http://cdn.scoreflex.com/b.css"]].data, @"A shared body is kept while used");
+    STAssertEquals((NSUInteger)(data.length + 7), self.cache.size, @"The size follows replaced bodies");
+
+    [self.cache storeResponse:[self responseForURLString:@"http://cdn.scoreflex.com/b.css"] data:data shell:NO];
+    STAssertEquals((NSUInteger)(data.length + 7), self.cache.size, @"Storing the same body again does not change the size");
+    STAssertEqualObjects(data, [self.cache cachedResponseForURL:[NSURL URLWithString:@"http://cdn.scoreflex.com/b.css"]].data, @"The body is kept when stored again");
+
+    [self.cache flush];
+    SXWebCache *reopened = [[SXWebCache alloc] initWithDirectory:self.cache.directory];
+    STAssertEquals(self.cache.size, reopened.size, @"The size is restored from the index");
+}
+
+- (void)testSizeBudget
+{
+    self.cache.maxSize = 10;
+    [self.cache storeResponse:[self responseForURLString:@"http://cdn.scoreflex.com/a.css"] data:[@"123456" dataUsingEncoding:NSUTF8StringEncoding] shell:NO];
+    [self.cache storeResponse:[self responseForURLString:@"http://cdn.scoreflex.com/b.css"] data:[@"abcdef" dataUsingEncoding:NSUTF8StringEncoding] shell:NO];
+
+    STAssertTrue(self.cache.size <= 10, @"The store stays within its budget");
+    STAssertNil([self.cache cachedResponseForURL:[NSURL URLWithString:@"http://cdn.scoreflex.com/a.css"]], @"The least recently used entry is evicted");
+    STAssertNotNil([self.cache cachedResponseForURL:[NSURL URLWithString:@"http://cdn.scoreflex.com/b.css"]], @"The new entry is kept");
+}
+
+- (void)testRemoveShells
+{
+    NSData *data = [@"<html></html>" dataUsingEncoding:NSUTF8StringEncoding];
+    [self.cache storeResponse:[self responseForURLString:@"http://api.scoreflex.com/v1/web/players/me"] data:data shell:YES];
+    [self.cache storeResponse:[self responseForURLString:@"http://cdn.scoreflex.com/a.css"] data:data shell:NO];
+
+    [self.cache removeShells];
+    STAssertNil([self.cache cachedResponseForURL:[NSURL URLWithString:@"http://api.scoreflex.com/v1/web/players/me"]], @"Pages are removed");
+    STAssertNotNil([self.cache cachedResponseForURL:[NSURL URLWithString:@"http://cdn.scoreflex.com/a.css"]], @"Assets are kept");
+
+    [self.cache removeAllEntries];
+    STAssertEquals((NSUInteger)0, self.cache.size, @"Everything is removed");
+}
+
+@end